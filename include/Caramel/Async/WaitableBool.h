@@ -7,7 +7,9 @@
 #include <Caramel/Caramel.h>
 #include <Caramel/Thread/MutexLocks.h>
 #include <condition_variable>
+#include <functional>
 #include <mutex>
+#include <vector>
 
 
 namespace Caramel
@@ -17,6 +19,7 @@ namespace Caramel
 //
 // Waitable Bool
 // - Block a thread until this boolean becomes true.
+//   Or call a function when it becomes true, without blocking.
 //
 
 class WaitableBool
@@ -41,11 +44,16 @@ public:
 
     void Wait();
 
+    // Called at once if it is true, otherwise by the thread which sets it true.
+    void OnTrue( std::function< void() > f );
+
 
 private:
 
     Bool m_value;
 
+    std::vector< std::function< void() >> m_onTrue;
+
     std::mutex m_mutex;
     std::condition_variable m_becomesTrue;
 };
@@ -72,17 +80,25 @@ inline WaitableBool::WaitableBool( Bool initialValue )
 inline WaitableBool& WaitableBool::operator=( Bool value )
 {
     Bool oldValue = false;
+    std::vector< std::function< void() >> onTrue;
 
     {
         auto ulock = UniqueLock( m_mutex );
         oldValue = m_value;
         m_value = value;
+
+        if ( value ) { onTrue.swap( m_onTrue ); }
     }
 
     if ( ! oldValue && value )
     {
         // false => true
         m_becomesTrue.notify_all();
+
+        for ( Uint i = 0; i < onTrue.size(); ++ i )
+        {
+            onTrue[i]();
+        }
     }
 
     return *this;
@@ -102,6 +118,22 @@ inline void WaitableBool::Wait()
 }
 
 
+inline void WaitableBool::OnTrue( std::function< void() > f )
+{
+    {
+        auto ulock = UniqueLock( m_mutex );
+
+        if ( ! m_value )
+        {
+            m_onTrue.push_back( std::move( f ));
+            return;
+        }
+    }
+
+    f();
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 
 } // namespace Caramel
@@ -0,0 +1,493 @@
+// Caramel C++ Library - Chrono Amenity - Timing Wheel Header
+
+#ifndef __CARAMEL_CHRONO_TIMING_WHEEL_H
+#define __CARAMEL_CHRONO_TIMING_WHEEL_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Chrono/TickClock.h>
+#include <boost/noncopyable.hpp>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+
+namespace Caramel
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Timing Wheel
+// - A hashed hierarchical timing wheel, which holds values until their due
+//   times. See Varghese and Lauck, "Hashed and Hierarchical Timing Wheels" (1987).
+//
+//   4 levels of 256 slots, with the resolution of 1 tick ( millisecond ).
+//   Level N covers 256 ^ ( N + 1 ) ticks, about 49 days in total.
+//   A farther timer is parked in the top level, and re-hashed every turn of it.
+//
+//   Schedule() and Cancel() are O(1). PopAllUntil() is amortized O(1) per
+//   expired timer, plus O(1) per elapsed tick while timers are near.
+//   Empty levels are skipped, so an idle wheel catches up quickly.
+//
+//   Timer nodes are recycled by a free list, no allocation in steady state.
+//
+//   Not thread-safe, it is protected by the owner's lock.
+//
+
+template< typename Value >
+class TimingWheel : public boost::noncopyable
+{
+public:
+
+    // 0 is never a valid timer ID.
+    typedef Uint64 TimerId;
+
+    explicit TimingWheel( const TickPoint& startTime = TickClock::Now() );
+
+
+    /// Operations ///
+
+    //
+    // A due time not later than the current time of the wheel
+    // expires at the next PopAllUntil().
+    //
+    TimerId Schedule( const TickPoint& dueTime, const Value& value );
+
+    // Returns false if the timer has expired or been cancelled.
+    Bool Cancel( TimerId timerId );
+
+    //
+    // Advance the wheel to now, append the values of expired timers.
+    // - The values are appended in the order of their due times,
+    //   in ticks resolution. The ones scheduled already due come first.
+    //
+    template< typename OutputContainer >
+    void PopAllUntil( const TickPoint& now, OutputContainer& values );
+
+    // Append the values of all timers, whether due or not, in no order.
+    template< typename OutputContainer >
+    void PopAll( OutputContainer& values );
+
+    void Clear();
+
+
+    /// Properties ///
+
+    Bool IsEmpty() const { return 0 == m_size; }
+    Uint Size()    const { return m_size; }
+
+    //
+    // When the wheel should be advanced next, for an owner to sleep until then.
+    // - It is exact if the earliest timer is within 256 ticks, otherwise it is
+    //   the time of re-hashing a higher level, not later than the earliest timer.
+    // - Returns false if no timer exists.
+    //
+    Bool GetNextAdvanceTime( TickPoint& time ) const;
+
+
+private:
+
+    /// Internal Types ///
+
+    static const Uint SLOT_BITS  = 8;
+    static const Uint NUM_SLOTS  = 1 << SLOT_BITS;
+    static const Uint SLOT_MASK  = NUM_SLOTS - 1;
+    static const Uint NUM_LEVELS = 4;
+
+    static const Uint32 NIL = 0xFFFFFFFF;
+
+    // The last slot holds the timers already due.
+    static const Uint DUE_SLOT = NUM_LEVELS * NUM_SLOTS;
+
+    struct Node
+    {
+        Node() : tick( 0 ), prev( NIL ), next( NIL ), slot( NIL ), generation( 1 ) {}
+
+        Uint64 tick;
+        Value  value;
+
+        Uint32 prev;
+        Uint32 next;
+        Uint32 slot;  // NIL if the node is free.
+
+        Uint32 generation;  // Increased when the node is freed.
+    };
+
+
+    /// Internal Functions ///
+
+    Uint64 ToTick( const TickPoint& time ) const;
+
+    Uint32 AllocateNode();
+    void   FreeNode( Uint32 index );
+
+    void Link( Uint32 index );
+    void LinkTo( Uint32 index, Uint32 slot );
+    void Unlink( Uint32 index );
+
+    void Cascade( Uint level );
+
+    template< typename OutputContainer >
+    void Expire( Uint32 slot, OutputContainer& values );
+
+
+    /// Data Members ///
+
+    TickPoint m_startTime;
+    Uint64 m_current;  // Ticks since the start time.
+
+    std::vector< Node > m_nodes;
+    Uint32 m_freeHead;
+
+    Uint32 m_heads[ DUE_SLOT + 1 ];
+    Uint   m_levelCounts[ NUM_LEVELS ];
+    Uint   m_size;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+template< typename Value >
+inline TimingWheel< Value >::TimingWheel( const TickPoint& startTime )
+    : m_startTime( startTime )
+    , m_current( 0 )
+    , m_freeHead( NIL )
+    , m_size( 0 )
+{
+    std::fill( m_heads, m_heads + DUE_SLOT + 1, NIL );
+    std::fill( m_levelCounts, m_levelCounts + NUM_LEVELS, 0 );
+}
+
+
+//
+// Operations
+//
+
+template< typename Value >
+inline auto TimingWheel< Value >::Schedule( const TickPoint& dueTime, const Value& value ) -> TimerId
+{
+    const Uint32 index = this->AllocateNode();
+
+    Node& node = m_nodes[ index ];
+    node.tick = this->ToTick( dueTime );
+    node.value = value;
+
+    this->Link( index );
+    ++ m_size;
+
+    return ( static_cast< Uint64 >( node.generation ) << 32 ) | index;
+}
+
+
+template< typename Value >
+inline Bool TimingWheel< Value >::Cancel( TimerId timerId )
+{
+    const Uint32 index = static_cast< Uint32 >( timerId );
+    const Uint32 generation = static_cast< Uint32 >( timerId >> 32 );
+
+    if ( index >= m_nodes.size() ) { return false; }
+
+    Node& node = m_nodes[ index ];
+
+    if ( NIL == node.slot || generation != node.generation ) { return false; }
+
+    this->Unlink( index );
+    this->FreeNode( index );
+    -- m_size;
+
+    return true;
+}
+
+
+template< typename Value >
+template< typename OutputContainer >
+inline void TimingWheel< Value >::PopAllUntil( const TickPoint& now, OutputContainer& values )
+{
+    this->Expire( DUE_SLOT, values );
+
+    const Uint64 target = this->ToTick( now );
+
+    while ( m_current < target )
+    {
+        if ( 0 == m_size )
+        {
+            m_current = target;
+            break;
+        }
+
+        // Skip the empty lower levels :
+        // Jump to the last tick before the next turn of the lowest non-empty level.
+
+        Uint level = 0;
+        while ( NUM_LEVELS > level && 0 == m_levelCounts[ level ] ) { ++ level; }
+
+        if ( 0 < level )
+        {
+            const Uint64 mask = ( 1ull << ( SLOT_BITS * std::min( level, NUM_LEVELS - 1 ))) - 1;
+            const Uint64 last = m_current | mask;
+
+            if ( last >= target )
+            {
+                m_current = target;
+                break;
+            }
+
+            m_current = last;
+        }
+
+        ++ m_current;
+
+        // Re-hash the higher levels whose turn comes, from the top.
+
+        for ( Uint i = NUM_LEVELS - 1; i > 0; -- i )
+        {
+            if ( 0 == ( m_current & (( 1ull << ( SLOT_BITS * i )) - 1 )))
+            {
+                this->Cascade( i );
+            }
+        }
+
+        this->Expire( static_cast< Uint32 >( m_current & SLOT_MASK ), values );
+
+        // Re-hashed timers due right now.
+        this->Expire( DUE_SLOT, values );
+    }
+}
+
+
+template< typename Value >
+template< typename OutputContainer >
+inline void TimingWheel< Value >::PopAll( OutputContainer& values )
+{
+    for ( Uint32 i = 0; i < m_nodes.size(); ++ i )
+    {
+        if ( NIL != m_nodes[i].slot )
+        {
+            values.push_back( std::move( m_nodes[i].value ));
+            this->Unlink( i );
+            this->FreeNode( i );
+        }
+    }
+
+    m_size = 0;
+}
+
+
+template< typename Value >
+inline void TimingWheel< Value >::Clear()
+{
+    for ( Uint32 i = 0; i < m_nodes.size(); ++ i )
+    {
+        if ( NIL != m_nodes[i].slot )
+        {
+            this->Unlink( i );
+            this->FreeNode( i );
+        }
+    }
+
+    m_size = 0;
+}
+
+
+//
+// Properties
+//
+
+template< typename Value >
+inline Bool TimingWheel< Value >::GetNextAdvanceTime( TickPoint& time ) const
+{
+    if ( 0 == m_size ) { return false; }
+
+    if ( NIL != m_heads[ DUE_SLOT ])
+    {
+        time = m_startTime + Ticks( static_cast< Int64 >( m_current ));
+        return true;
+    }
+
+    Uint64 nextTick = ~0ull;
+
+    for ( Uint level = 0; level < NUM_LEVELS; ++ level )
+    {
+        if ( 0 == m_levelCounts[ level ]) { continue; }
+
+        const Uint shift = SLOT_BITS * level;
+        const Uint64 turn = m_current >> shift;
+
+        for ( Uint k = 1; k <= NUM_SLOTS; ++ k )
+        {
+            const Uint64 slotTurn = turn + k;
+
+            if ( NIL != m_heads[ level * NUM_SLOTS + ( slotTurn & SLOT_MASK )])
+            {
+                // Level 0 is exact. A higher slot is re-hashed at the start of its turn.
+                nextTick = std::min( nextTick, slotTurn << shift );
+                break;
+            }
+        }
+
+        // A lower level found is always earlier than the higher ones.
+        if ( ~0ull != nextTick ) { break; }
+    }
+
+    time = m_startTime + Ticks( static_cast< Int64 >( nextTick ));
+    return true;
+}
+
+
+//
+// Internal Functions
+//
+
+template< typename Value >
+inline Uint64 TimingWheel< Value >::ToTick( const TickPoint& time ) const
+{
+    const Int64 ticks = Ticks( time - m_startTime ).ToInt64();
+    return 0 > ticks ? 0 : static_cast< Uint64 >( ticks );
+}
+
+
+template< typename Value >
+inline Uint32 TimingWheel< Value >::AllocateNode()
+{
+    if ( NIL == m_freeHead )
+    {
+        m_nodes.push_back( Node() );
+        return static_cast< Uint32 >( m_nodes.size() - 1 );
+    }
+
+    const Uint32 index = m_freeHead;
+    m_freeHead = m_nodes[ index ].next;
+    return index;
+}
+
+
+template< typename Value >
+inline void TimingWheel< Value >::FreeNode( Uint32 index )
+{
+    Node& node = m_nodes[ index ];
+
+    node.value = Value();  // Release the resource now.
+    node.slot = NIL;
+    node.prev = NIL;
+    node.next = m_freeHead;
+
+    // Invalidate the timer IDs of this node.
+    if ( 0 == ++ node.generation ) { node.generation = 1; }
+
+    m_freeHead = index;
+}
+
+
+template< typename Value >
+inline void TimingWheel< Value >::Link( Uint32 index )
+{
+    const Uint64 tick = m_nodes[ index ].tick;
+
+    if ( tick <= m_current )
+    {
+        this->LinkTo( index, DUE_SLOT );
+        return;
+    }
+
+    // The level is decided by the highest differing slot digit.
+
+    const Uint64 diff = tick ^ m_current;
+
+    Uint level = 0;
+    while ( NUM_LEVELS - 1 > level && ( diff >> ( SLOT_BITS * ( level + 1 ))) != 0 ) { ++ level; }
+
+    // Too far, park it in the top level slot 0, which is re-hashed
+    // at every 256 ^ 4 ticks boundary.
+    const Uint64 digit = ( diff >> ( SLOT_BITS * NUM_LEVELS )) != 0
+                       ? 0
+                       : ( tick >> ( SLOT_BITS * level ));
+
+    this->LinkTo( index, static_cast< Uint32 >( level * NUM_SLOTS + ( digit & SLOT_MASK )));
+    ++ m_levelCounts[ level ];
+}
+
+
+template< typename Value >
+inline void TimingWheel< Value >::LinkTo( Uint32 index, Uint32 slot )
+{
+    Node& node = m_nodes[ index ];
+
+    node.slot = slot;
+    node.prev = NIL;
+    node.next = m_heads[ slot ];
+
+    if ( NIL != node.next ) { m_nodes[ node.next ].prev = index; }
+
+    m_heads[ slot ] = index;
+}
+
+
+template< typename Value >
+inline void TimingWheel< Value >::Unlink( Uint32 index )
+{
+    Node& node = m_nodes[ index ];
+
+    if ( NIL != node.prev ) { m_nodes[ node.prev ].next = node.next; }
+    else                    { m_heads[ node.slot ] = node.next; }
+
+    if ( NIL != node.next ) { m_nodes[ node.next ].prev = node.prev; }
+
+    if ( DUE_SLOT != node.slot )
+    {
+        -- m_levelCounts[ node.slot / NUM_SLOTS ];
+    }
+}
+
+
+template< typename Value >
+inline void TimingWheel< Value >::Cascade( Uint level )
+{
+    const Uint32 slot = static_cast< Uint32 >(
+        level * NUM_SLOTS + (( m_current >> ( SLOT_BITS * level )) & SLOT_MASK ));
+
+    Uint32 index = m_heads[ slot ];
+    m_heads[ slot ] = NIL;
+
+    while ( NIL != index )
+    {
+        const Uint32 next = m_nodes[ index ].next;
+
+        -- m_levelCounts[ level ];
+        this->Link( index );
+
+        index = next;
+    }
+}
+
+
+template< typename Value >
+template< typename OutputContainer >
+inline void TimingWheel< Value >::Expire( Uint32 slot, OutputContainer& values )
+{
+    Uint32 index = m_heads[ slot ];
+    m_heads[ slot ] = NIL;
+
+    while ( NIL != index )
+    {
+        Node& node = m_nodes[ index ];
+        const Uint32 next = node.next;
+
+        if ( DUE_SLOT != slot ) { -- m_levelCounts[ slot / NUM_SLOTS ]; }
+
+        values.push_back( std::move( node.value ));
+        this->FreeNode( index );
+        -- m_size;
+
+        index = next;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_CHRONO_TIMING_WHEEL_H
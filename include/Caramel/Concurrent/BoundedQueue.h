@@ -0,0 +1,269 @@
+// Caramel C++ Library - Concurrent Amenity - Bounded Queue Header
+
+#ifndef __CARAMEL_CONCURRENT_BOUNDED_QUEUE_H
+#define __CARAMEL_CONCURRENT_BOUNDED_QUEUE_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <thread>
+#include <utility>
+
+
+namespace Caramel
+{
+
+namespace Concurrent
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Concurrent Bounded Queue
+// - A lock-free multi-producer / multi-consumer ring buffer.
+//   Each cell carries a sequence number, which tells the producers and
+//   consumers whether the cell is ready for them. Credit to Dmitry Vyukov.
+//
+//   The Capacity must be a power of 2.
+//
+// USAGE:
+//   It has the same Push() / TryPop() surface of Concurrent::Queue,
+//   therefore you may switch to it by a typedef.
+//   Push() would yield until a slot is available. Use TryPush() if you want
+//   to handle the backpressure yourself.
+//
+
+template< typename T, Uint Capacity >
+class BoundedQueue : public boost::noncopyable
+{
+    static_assert( 2 <= Capacity && 0 == ( Capacity & ( Capacity - 1 )),
+                   "Capacity of BoundedQueue must be a power of 2" );
+
+public:
+
+    BoundedQueue();
+
+
+    /// Operations ///
+
+    void Push( const T& x );
+    void Push( T&& x );
+
+    // Returns false if the queue is full, and x is left untouched.
+    Bool TryPush( const T& x );
+    Bool TryPush( T&& x );
+
+    // The element is moved out.
+    Bool TryPop( T& x );
+
+
+    /// Properties ///
+
+    static Uint GetCapacity() { return Capacity; }
+
+
+    /// Not Thread-safe Properties ///
+
+    Bool IsEmpty() const;
+    Uint Size()    const;
+
+
+private:
+
+    /// Internal Types ///
+
+    struct Cell
+    {
+        std::atomic< std::size_t > sequence;
+        T value;
+    };
+
+    static const std::size_t INDEX_MASK = Capacity - 1;
+
+    static const Uint CACHE_LINE_SIZE = 64;  // Common CPU cache line length.
+
+    typedef Byte CacheLinePad[ CACHE_LINE_SIZE ];
+
+
+    /// Internal Functions ///
+
+    // Returns nullptr if the queue is full.
+    Cell* AcquirePushCell( std::size_t& pos );
+
+
+    /// Data Members ///
+    //
+    // Producers and consumers are kept on separate cache lines,
+    // to avoid false sharing between them.
+    //
+
+    CacheLinePad m_pad0;
+    Cell m_cells[ Capacity ];
+
+    CacheLinePad m_pad1;
+    std::atomic< std::size_t > m_pushPos;
+
+    CacheLinePad m_pad2;
+    std::atomic< std::size_t > m_popPos;
+
+    CacheLinePad m_pad3;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+template< typename T, Uint Capacity >
+inline BoundedQueue< T, Capacity >::BoundedQueue()
+    : m_pushPos( 0 )
+    , m_popPos( 0 )
+{
+    for ( std::size_t i = 0; i < Capacity; ++ i )
+    {
+        m_cells[i].sequence.store( i, std::memory_order_relaxed );
+    }
+}
+
+
+template< typename T, Uint Capacity >
+inline void BoundedQueue< T, Capacity >::Push( const T& x )
+{
+    while ( ! this->TryPush( x ))
+    {
+        std::this_thread::yield();
+    }
+}
+
+
+template< typename T, Uint Capacity >
+inline void BoundedQueue< T, Capacity >::Push( T&& x )
+{
+    while ( ! this->TryPush( std::move( x )))
+    {
+        std::this_thread::yield();
+    }
+}
+
+
+template< typename T, Uint Capacity >
+inline Bool BoundedQueue< T, Capacity >::TryPush( const T& x )
+{
+    std::size_t pos = 0;
+    Cell* cell = this->AcquirePushCell( pos );
+    if ( ! cell ) { return false; }
+
+    cell->value = x;
+    cell->sequence.store( pos + 1, std::memory_order_release );
+
+    return true;
+}
+
+
+template< typename T, Uint Capacity >
+inline Bool BoundedQueue< T, Capacity >::TryPush( T&& x )
+{
+    std::size_t pos = 0;
+    Cell* cell = this->AcquirePushCell( pos );
+    if ( ! cell ) { return false; }
+
+    cell->value = std::move( x );
+    cell->sequence.store( pos + 1, std::memory_order_release );
+
+    return true;
+}
+
+
+template< typename T, Uint Capacity >
+inline auto BoundedQueue< T, Capacity >::AcquirePushCell( std::size_t& pos ) -> Cell*
+{
+    Cell* cell = nullptr;
+    pos = m_pushPos.load( std::memory_order_relaxed );
+
+    for ( ;; )
+    {
+        cell = &m_cells[ pos & INDEX_MASK ];
+        const std::size_t seq = cell->sequence.load( std::memory_order_acquire );
+        const std::ptrdiff_t diff = static_cast< std::ptrdiff_t >( seq ) - static_cast< std::ptrdiff_t >( pos );
+
+        if ( 0 == diff )
+        {
+            if ( m_pushPos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ))
+            {
+                break;
+            }
+        }
+        else if ( 0 > diff )
+        {
+            return nullptr;  // The queue is full
+        }
+        else
+        {
+            pos = m_pushPos.load( std::memory_order_relaxed );
+        }
+    }
+
+    return cell;
+}
+
+
+template< typename T, Uint Capacity >
+inline Bool BoundedQueue< T, Capacity >::TryPop( T& x )
+{
+    Cell* cell = nullptr;
+    std::size_t pos = m_popPos.load( std::memory_order_relaxed );
+
+    for ( ;; )
+    {
+        cell = &m_cells[ pos & INDEX_MASK ];
+        const std::size_t seq = cell->sequence.load( std::memory_order_acquire );
+        const std::ptrdiff_t diff = static_cast< std::ptrdiff_t >( seq ) - static_cast< std::ptrdiff_t >( pos + 1 );
+
+        if ( 0 == diff )
+        {
+            if ( m_popPos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ))
+            {
+                break;
+            }
+        }
+        else if ( 0 > diff )
+        {
+            return false;  // The queue is empty
+        }
+        else
+        {
+            pos = m_popPos.load( std::memory_order_relaxed );
+        }
+    }
+
+    x = std::move( cell->value );  // Also releases the resource, e.g. a shared_ptr, held by the cell.
+    cell->sequence.store( pos + INDEX_MASK + 1, std::memory_order_release );
+
+    return true;
+}
+
+
+template< typename T, Uint Capacity >
+inline Bool BoundedQueue< T, Capacity >::IsEmpty() const
+{
+    return m_pushPos.load( std::memory_order_relaxed ) == m_popPos.load( std::memory_order_relaxed );
+}
+
+
+template< typename T, Uint Capacity >
+inline Uint BoundedQueue< T, Capacity >::Size() const
+{
+    const std::size_t popPos = m_popPos.load( std::memory_order_relaxed );
+    const std::size_t pushPos = m_pushPos.load( std::memory_order_relaxed );
+    return pushPos > popPos ? static_cast< Uint >( pushPos - popPos ) : 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Concurrent
+
+} // namespace Caramel
+
+#endif // __CARAMEL_CONCURRENT_BOUNDED_QUEUE_H
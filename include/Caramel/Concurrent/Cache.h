@@ -0,0 +1,496 @@
+// Caramel C++ Library - Concurrent Amenity - Cache Header
+
+#ifndef __CARAMEL_CONCURRENT_CACHE_H
+#define __CARAMEL_CONCURRENT_CACHE_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Concurrent/EvictionPolicies.h>
+#include <Caramel/String/Sprintf.h>
+#include <Caramel/Thread/LockContention.h>
+#include <Caramel/Thread/MutexLocks.h>
+#include <Caramel/Trace/Trace.h>
+#include <boost/noncopyable.hpp>
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <unordered_map>
+
+
+namespace Caramel
+{
+
+namespace Concurrent
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Cache Statistics
+//
+
+struct CacheStats
+{
+    Uint64 hits;
+    Uint64 misses;
+    Uint64 loads;      // Calls of the loaders in GetOrLoad().
+    Uint64 evictions;
+
+    CacheStats() : hits( 0 ), misses( 0 ), loads( 0 ), evictions( 0 ) {}
+
+    Double HitRate() const;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Concurrent Cache
+// - A capacity bounded map, which evicts entries by the EvictionPolicy :
+//   EvictLru or EvictTinyLfu, see EvictionPolicies.h
+//
+//   Keys are hashed into independent shards, as StripedHashMap does.
+//   Each shard holds capacity / Shards entries ( at least 1 ), and evicts by
+//   its own order. Therefore the eviction is only approximately global.
+//
+// USAGE:
+//   GetOrLoad() calls the loader on a miss. Concurrent misses of the same key
+//   wait for the first one, the loader is called only once.
+//   If the loader throws, the exception is propagated to all of them,
+//   and nothing is cached.
+//
+// NOTE: The ( Key, Value ) naming convention is belong to .NET Framework,
+//       not STL/Boost style.
+//
+
+template< typename Key, typename Value, typename EvictionPolicy = EvictLru, Uint Shards = 16 >
+class Cache : public boost::noncopyable
+{
+    static_assert( 1 <= Shards && 0 == ( Shards & ( Shards - 1 )),
+                   "Shards of Cache must be a power of 2" );
+
+public:
+
+    typedef Key   KeyType;
+    typedef Value ValueType;
+
+    explicit Cache( Uint capacity );
+
+
+    /// Properties ///
+
+    Uint GetCapacity() const { return m_capacity; }
+
+
+    /// Not Thread-safe Properties ///
+
+    Bool IsEmpty() const;
+    Uint Size()    const;
+
+
+    /// Accessors ///
+
+    // A hit marks the entry as recently used.
+    Bool Find( const Key& k, Value& v );
+
+    // Doesn't touch the entry, nor count a hit or miss.
+    Bool Contains( const Key& k ) const;
+
+    template< typename Loader >
+    Value GetOrLoad( const Key& k, Loader loader );
+
+
+    /// Modifiers ///
+
+    // Insert or assign the value. Returns true if inserted.
+    Bool Upsert( const Key& k, const Value& v );
+
+    // Returns false if the key doesn't exist.
+    Bool Erase( const Key& k );
+
+    void Clear();
+
+
+    /// Statistics ///
+
+    CacheStats GetStats() const;
+    void ResetStats();
+
+    void ReportToTrace( const std::string& name ) const;
+
+
+    /// Instrumentation ///
+
+    // Name the lock in the contention report, see Thread/LockContention.h
+    void SetContentionName( const std::string& name );
+
+
+private:
+
+    /// Internal Types ///
+
+    static const Uint CACHE_LINE_SIZE = 64;  // Common CPU cache line length.
+
+    typedef typename EvictionPolicy::template Order< Key > OrderType;
+
+    struct Entry
+    {
+        Value value;
+        typename OrderType::Handle handle;
+    };
+
+    struct Shard
+    {
+        std::unordered_map< Key, Entry > entries;
+        OrderType order;
+
+        // Keys being loaded by GetOrLoad().
+        std::unordered_map< Key, std::shared_future< Value > > loadings;
+
+        CacheStats stats;
+
+        mutable TrackedMutex mutex;
+
+        // Keep each shard's mutex away from its neighbours' cache line.
+        Byte pad[ CACHE_LINE_SIZE ];
+    };
+
+
+    /// Internal Functions ///
+
+    const Shard& GetShard( const Key& k ) const;
+    Shard&       GetShard( const Key& k );
+
+    // REMARKS: The shard lock should have been taken.
+    Bool Put( Shard& shard, const Key& k, const Value& v );
+
+
+    /// Data Members ///
+
+    Uint m_capacity;
+
+    Shard m_shards[ Shards ];
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+inline Double CacheStats::HitRate() const
+{
+    const Uint64 total = hits + misses;
+    return 0 == total ? 0.0 : static_cast< Double >( hits ) / total;
+}
+
+
+template< typename Key, typename Value, typename EvictionP, Uint Shards >
+inline Cache< Key, Value, EvictionP, Shards >::Cache( Uint capacity )
+    : m_capacity( capacity )
+{
+    const Uint shardCapacity = std::max(( capacity + Shards - 1 ) / Shards, 1u );
+
+    for ( Uint i = 0; i < Shards; ++ i )
+    {
+        m_shards[i].order.SetCapacity( shardCapacity );
+    }
+}
+
+
+//
+// Properties
+//
+
+template< typename Key, typename Value, typename EvictionP, Uint Shards >
+inline Bool Cache< Key, Value, EvictionP, Shards >::IsEmpty() const
+{
+    for ( Uint i = 0; i < Shards; ++ i )
+    {
+        if ( ! m_shards[i].entries.empty() ) { return false; }
+    }
+    return true;
+}
+
+
+template< typename Key, typename Value, typename EvictionP, Uint Shards >
+inline Uint Cache< Key, Value, EvictionP, Shards >::Size() const
+{
+    std::size_t size = 0;
+    for ( Uint i = 0; i < Shards; ++ i )
+    {
+        size += m_shards[i].entries.size();
+    }
+    return static_cast< Uint >( size );
+}
+
+
+//
+// Accessors
+//
+
+template< typename Key, typename Value, typename EvictionP, Uint Shards >
+inline Bool Cache< Key, Value, EvictionP, Shards >::Find( const Key& k, Value& v )
+{
+    Shard& shard = this->GetShard( k );
+
+    auto ulock = UniqueLock( shard.mutex );
+
+    auto iter = shard.entries.find( k );
+    if ( shard.entries.end() == iter )
+    {
+        ++ shard.stats.misses;
+        return false;
+    }
+
+    ++ shard.stats.hits;
+    shard.order.Touch( iter->second.handle );
+
+    v = iter->second.value;
+    return true;
+}
+
+
+template< typename Key, typename Value, typename EvictionP, Uint Shards >
+inline Bool Cache< Key, Value, EvictionP, Shards >::Contains( const Key& k ) const
+{
+    const Shard& shard = this->GetShard( k );
+
+    auto ulock = UniqueLock( shard.mutex );
+    return shard.entries.end() != shard.entries.find( k );
+}
+
+
+template< typename Key, typename Value, typename EvictionP, Uint Shards >
+template< typename Loader >
+inline Value Cache< Key, Value, EvictionP, Shards >::GetOrLoad( const Key& k, Loader loader )
+{
+    Shard& shard = this->GetShard( k );
+
+    std::shared_ptr< std::promise< Value > > promise;
+    std::shared_future< Value > future;
+
+    {
+        auto ulock = UniqueLock( shard.mutex );
+
+        auto iter = shard.entries.find( k );
+        if ( shard.entries.end() != iter )
+        {
+            ++ shard.stats.hits;
+            shard.order.Touch( iter->second.handle );
+            return iter->second.value;
+        }
+
+        ++ shard.stats.misses;
+
+        auto loading = shard.loadings.find( k );
+        if ( shard.loadings.end() != loading )
+        {
+            future = loading->second;
+        }
+        else
+        {
+            promise = std::make_shared< std::promise< Value > >();
+            future = promise->get_future().share();
+            shard.loadings.insert( std::make_pair( k, future ));
+        }
+    }
+
+    // Another thread is loading this key, wait for it.
+    if ( ! promise ) { return future.get(); }
+
+    Value value;
+
+    try
+    {
+        value = loader();
+    }
+    catch ( ... )
+    {
+        {
+            auto ulock = UniqueLock( shard.mutex );
+            shard.loadings.erase( k );
+        }
+
+        promise->set_exception( std::current_exception() );
+        throw;
+    }
+
+    {
+        auto ulock = UniqueLock( shard.mutex );
+
+        shard.loadings.erase( k );
+        ++ shard.stats.loads;
+        this->Put( shard, k, value );
+    }
+
+    promise->set_value( value );
+    return value;
+}
+
+
+//
+// Modifiers
+//
+
+template< typename Key, typename Value, typename EvictionP, Uint Shards >
+inline Bool Cache< Key, Value, EvictionP, Shards >::Upsert( const Key& k, const Value& v )
+{
+    Shard& shard = this->GetShard( k );
+
+    auto ulock = UniqueLock( shard.mutex );
+    return this->Put( shard, k, v );
+}
+
+
+template< typename Key, typename Value, typename EvictionP, Uint Shards >
+inline Bool Cache< Key, Value, EvictionP, Shards >::Erase( const Key& k )
+{
+    Shard& shard = this->GetShard( k );
+
+    auto ulock = UniqueLock( shard.mutex );
+
+    auto iter = shard.entries.find( k );
+    if ( shard.entries.end() == iter ) { return false; }
+
+    shard.order.Remove( iter->second.handle );
+    shard.entries.erase( iter );
+    return true;
+}
+
+
+template< typename Key, typename Value, typename EvictionP, Uint Shards >
+inline void Cache< Key, Value, EvictionP, Shards >::Clear()
+{
+    for ( Uint i = 0; i < Shards; ++ i )
+    {
+        Shard& shard = m_shards[i];
+
+        auto ulock = UniqueLock( shard.mutex );
+
+        shard.entries.clear();
+        shard.order.Clear();
+    }
+}
+
+
+template< typename Key, typename Value, typename EvictionP, Uint Shards >
+inline Bool Cache< Key, Value, EvictionP, Shards >::Put( Shard& shard, const Key& k, const Value& v )
+{
+    auto iter = shard.entries.find( k );
+    if ( shard.entries.end() != iter )
+    {
+        iter->second.value = v;
+        shard.order.Touch( iter->second.handle );
+        return false;
+    }
+
+    const Entry entry = { v, shard.order.Add( k ) };
+    shard.entries.insert( std::make_pair( k, entry ));
+
+    Key victim;
+    while ( shard.order.PopVictim( victim ))
+    {
+        shard.entries.erase( victim );
+        ++ shard.stats.evictions;
+    }
+
+    return true;
+}
+
+
+//
+// Statistics
+//
+
+template< typename Key, typename Value, typename EvictionP, Uint Shards >
+inline CacheStats Cache< Key, Value, EvictionP, Shards >::GetStats() const
+{
+    CacheStats total;
+
+    for ( Uint i = 0; i < Shards; ++ i )
+    {
+        const Shard& shard = m_shards[i];
+
+        auto ulock = UniqueLock( shard.mutex );
+
+        total.hits      += shard.stats.hits;
+        total.misses    += shard.stats.misses;
+        total.loads     += shard.stats.loads;
+        total.evictions += shard.stats.evictions;
+    }
+
+    return total;
+}
+
+
+template< typename Key, typename Value, typename EvictionP, Uint Shards >
+inline void Cache< Key, Value, EvictionP, Shards >::ResetStats()
+{
+    for ( Uint i = 0; i < Shards; ++ i )
+    {
+        Shard& shard = m_shards[i];
+
+        auto ulock = UniqueLock( shard.mutex );
+        shard.stats = CacheStats();
+    }
+}
+
+
+template< typename Key, typename Value, typename EvictionP, Uint Shards >
+inline void Cache< Key, Value, EvictionP, Shards >::ReportToTrace( const std::string& name ) const
+{
+    const CacheStats stats = this->GetStats();
+
+    const std::string rates = Sprintf( "hits %llu, misses %llu, hit rate %.1f%%",
+        stats.hits, stats.misses, stats.HitRate() * 100 );
+
+    const std::string others = Sprintf( "loads %llu, evictions %llu, size %u",
+        stats.loads, stats.evictions, this->Size() );
+
+    CARAMEL_TRACE_DEBUG( "[%s] : %s, %s", name, rates, others );
+}
+
+
+//
+// Instrumentation
+//
+
+template< typename Key, typename Value, typename EvictionP, Uint Shards >
+inline void Cache< Key, Value, EvictionP, Shards >::SetContentionName( const std::string& name )
+{
+    for ( Uint i = 0; i < Shards; ++ i )
+    {
+        m_shards[i].mutex.SetName( name );
+    }
+}
+
+
+//
+// Shard Selection
+// - Same as StripedHashMap.
+//
+
+template< typename Key, typename Value, typename EvictionP, Uint Shards >
+inline auto Cache< Key, Value, EvictionP, Shards >::GetShard( const Key& k ) const -> const Shard&
+{
+    std::size_t hash = std::hash< Key >()( k );
+    hash ^= ( hash >> 16 ) ^ ( hash >> 7 );
+    return m_shards[ hash & ( Shards - 1 ) ];
+}
+
+
+template< typename Key, typename Value, typename EvictionP, Uint Shards >
+inline auto Cache< Key, Value, EvictionP, Shards >::GetShard( const Key& k ) -> Shard&
+{
+    return const_cast< Shard& >( static_cast< const Cache* >( this )->GetShard( k ));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Concurrent
+
+} // namespace Caramel
+
+#endif // __CARAMEL_CONCURRENT_CACHE_H
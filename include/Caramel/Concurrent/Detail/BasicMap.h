@@ -5,9 +5,11 @@
 #pragma once
 
 #include <Caramel/Caramel.h>
+#include <Caramel/Functional/ScopeExit.h>
+#include <Caramel/Thread/LockContention.h>
 #include <Caramel/Thread/MutexLocks.h>
 #include <boost/noncopyable.hpp>
-#include <mutex>
+#include <utility>
 
 
 namespace Caramel
@@ -26,7 +28,7 @@ namespace Detail
 //
 
 template< typename MapType, typename ReplicatePolicy >
-class BasicMap : public ReplicatePolicy::template Dictionary< typename MapType::key_type, typename MapType::mapped_type >
+class BasicMap : public ReplicatePolicy::template Dictionary< typename MapType::key_type, typename MapType::mapped_type, MapType >
                , public boost::noncopyable
 {
 public:
@@ -34,7 +36,7 @@ public:
     typedef typename MapType::key_type    Key,   KeyType;
     typedef typename MapType::mapped_type Value, ValueType;
 
-    typedef typename ReplicatePolicy::template Dictionary< Key, Value > Replicator;
+    typedef typename ReplicatePolicy::template Dictionary< Key, Value, MapType > Replicator;
 
 
     /// Properties ///
@@ -48,10 +50,68 @@ public:
     Bool Contains( const Key& k ) const;
     Bool Find( const Key& k, Value& v ) const;
 
+    //
+    // Find values of keys in [ first, last ), in a single lock.
+    // - For each found key, writes a std::pair< Key, Value > to the result.
+    //   Returns the number of found keys.
+    //
+    template< typename KeyIterator, typename OutputIterator >
+    Uint FindMany( KeyIterator first, KeyIterator last, OutputIterator result ) const;
+
+    //
+    // Call f( key, value ) on each entry, with the map locked.
+    // - Don't access this map in f, otherwise it would deadlock.
+    //
+    template< typename Function >
+    void ForEach( Function f ) const;
+
 
     /// Modifiers ///
     
     Bool Insert( const Key& k, const Value& v );
+    Bool Insert( const Key& k, Value&& v );
+
+    //
+    // Construct the value in place, only if the key doesn't exist.
+    // - Returns false if the key exists.
+    //   Only if CARAMEL_HAS_VARIADIC_TEMPLATES is defined.
+    //
+#if defined( CARAMEL_HAS_VARIADIC_TEMPLATES )
+    template< typename... Args >
+    Bool Emplace( const Key& k, Args&&... args );
+#endif
+
+    //
+    // Insert the pairs in [ first, last ), in a single lock.
+    // - Existing keys are skipped. Returns the number of inserted pairs.
+    //   The Replicator publishes the range as one batch.
+    //
+    template< typename InputIterator >
+    Uint InsertRange( InputIterator first, InputIterator last );
+
+    //
+    // Insert or assign the value.
+    // - Returns true if inserted, false if assigned.
+    //   The Replicator::Insert() is called in both cases.
+    //
+    Bool Upsert( const Key& k, const Value& v );
+
+    //
+    // Returns the value of the key. If the key doesn't exist,
+    // insert the value created by factory() first.
+    // - The factory is called with the map locked, at most once.
+    //
+    template< typename Factory >
+    Value ComputeIfAbsent( const Key& k, Factory factory );
+
+    // Returns false if the key doesn't exist.
+    Bool Erase( const Key& k );
+
+
+    /// Instrumentation ///
+
+    // Name the lock in the contention report, see Thread/LockContention.h
+    void SetContentionName( const std::string& name ) { m_mapMutex.SetName( name ); }
 
 
 private:
@@ -59,7 +119,7 @@ private:
     /// Data Members ///
 
     MapType m_map;
-    mutable std::mutex m_mapMutex;
+    mutable TrackedMutex m_mapMutex;
 };
 
 
@@ -91,6 +151,41 @@ Bool BasicMap< MapT, ReplicateP >::Find( const Key& k, Value& v ) const
 }
 
 
+template< typename MapT, typename ReplicateP >
+template< typename KeyIterator, typename OutputIterator >
+Uint BasicMap< MapT, ReplicateP >::FindMany( KeyIterator first, KeyIterator last, OutputIterator result ) const
+{
+    auto ulock = UniqueLock( m_mapMutex );
+
+    Uint count = 0;
+
+    for ( ; first != last; ++ first )
+    {
+        auto iter = m_map.find( *first );
+        if ( m_map.end() == iter ) { continue; }
+
+        *result = std::make_pair( iter->first, iter->second );
+        ++ result;
+        ++ count;
+    }
+
+    return count;
+}
+
+
+template< typename MapT, typename ReplicateP >
+template< typename Function >
+void BasicMap< MapT, ReplicateP >::ForEach( Function f ) const
+{
+    auto ulock = UniqueLock( m_mapMutex );
+
+    for ( auto iter = m_map.begin(); m_map.end() != iter; ++ iter )
+    {
+        f( iter->first, iter->second );
+    }
+}
+
+
 //
 // Modifiers
 //
@@ -111,6 +206,118 @@ Bool BasicMap< MapT, ReplicateP >::Insert( const Key& k, const Value& v )
 }
 
 
+template< typename MapT, typename ReplicateP >
+Bool BasicMap< MapT, ReplicateP >::Insert( const Key& k, Value&& v )
+{
+    auto ulock = UniqueLock( m_mapMutex );
+
+    auto result = m_map.insert( std::make_pair( k, std::move( v )));
+
+    if ( result.second )
+    {
+        this->Replicator::Insert( k, result.first->second );
+    }
+
+    return result.second;
+}
+
+
+#if defined( CARAMEL_HAS_VARIADIC_TEMPLATES )
+
+template< typename MapT, typename ReplicateP >
+template< typename... Args >
+Bool BasicMap< MapT, ReplicateP >::Emplace( const Key& k, Args&&... args )
+{
+    auto ulock = UniqueLock( m_mapMutex );
+
+    if ( m_map.end() != m_map.find( k )) { return false; }
+
+    auto iter = m_map.insert( std::make_pair( k, Value( std::forward< Args >( args )... ))).first;
+
+    this->Replicator::Insert( k, iter->second );
+
+    return true;
+}
+
+#endif // CARAMEL_HAS_VARIADIC_TEMPLATES
+
+
+template< typename MapT, typename ReplicateP >
+template< typename InputIterator >
+Uint BasicMap< MapT, ReplicateP >::InsertRange( InputIterator first, InputIterator last )
+{
+    auto ulock = UniqueLock( m_mapMutex );
+
+    // Replicate the whole range at once.
+    this->Replicator::BeginBatch();
+    auto commit = ScopeExit( [this] { this->Replicator::CommitBatch(); } );
+
+    Uint count = 0;
+
+    for ( ; first != last; ++ first )
+    {
+        if ( m_map.insert( std::make_pair( first->first, first->second )).second )
+        {
+            this->Replicator::Insert( first->first, first->second );
+            ++ count;
+        }
+    }
+
+    return count;
+}
+
+
+template< typename MapT, typename ReplicateP >
+Bool BasicMap< MapT, ReplicateP >::Upsert( const Key& k, const Value& v )
+{
+    auto ulock = UniqueLock( m_mapMutex );
+
+    auto result = m_map.insert( std::make_pair( k, v ));
+
+    if ( ! result.second )
+    {
+        result.first->second = v;
+    }
+
+    this->Replicator::Insert( k, v );
+
+    return result.second;
+}
+
+
+template< typename MapT, typename ReplicateP >
+template< typename Factory >
+auto BasicMap< MapT, ReplicateP >::ComputeIfAbsent( const Key& k, Factory factory ) -> Value
+{
+    auto ulock = UniqueLock( m_mapMutex );
+
+    auto iter = m_map.find( k );
+    if ( m_map.end() != iter ) { return iter->second; }
+
+    iter = m_map.insert( std::make_pair( k, factory() )).first;
+
+    this->Replicator::Insert( k, iter->second );
+
+    return iter->second;
+}
+
+
+template< typename MapT, typename ReplicateP >
+Bool BasicMap< MapT, ReplicateP >::Erase( const Key& k )
+{
+    auto ulock = UniqueLock( m_mapMutex );
+
+    const Bool erased = 0 < m_map.erase( k );
+
+    if ( erased )
+    {
+        this->Replicator::Erase( k );
+    }
+
+    return erased;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 
 } // namespace Detail
@@ -0,0 +1,187 @@
+// Caramel C++ Library - Concurrent Amenity - Frequency Sketch Header
+
+#ifndef __CARAMEL_CONCURRENT_FREQUENCY_SKETCH_H
+#define __CARAMEL_CONCURRENT_FREQUENCY_SKETCH_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+
+namespace Caramel
+{
+
+namespace Concurrent
+{
+
+namespace Detail
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Frequency Sketch
+// - A Count-Min sketch which estimates how often a key was accessed recently.
+//   Used by the TinyLFU admission of Concurrent::Cache.
+//
+//   Each key is counted in 4 rows, the estimation is the minimum of them.
+//   Counters saturate at 15. After 10 x capacity increments, all counters
+//   are halved, so the old popularity fades out.
+//
+//   Not thread-safe, it is protected by the owner's lock.
+//
+
+template< typename Key >
+class FrequencySketch
+{
+public:
+
+    FrequencySketch();
+
+    void SetCapacity( Uint capacity );
+
+    void Increment( const Key& k );
+    Uint Frequency( const Key& k ) const;
+
+    void Clear();
+
+
+private:
+
+    static const Uint NUM_ROWS = 4;
+    static const Byte MAX_COUNT = 15;
+
+    Uint IndexOf( Uint64 hash, Uint row ) const;
+
+    static Uint64 HashOf( const Key& k );
+
+    void Age();
+
+
+    /// Data Members ///
+
+    std::vector< Byte > m_counters;  // NUM_ROWS rows, each has ( m_rowMask + 1 ) counters.
+    Uint m_rowMask;
+
+    Uint m_additions;
+    Uint m_sampleSize;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+template< typename Key >
+inline FrequencySketch< Key >::FrequencySketch()
+    : m_rowMask( 0 )
+    , m_additions( 0 )
+    , m_sampleSize( 0 )
+{
+    this->SetCapacity( 1 );
+}
+
+
+template< typename Key >
+inline void FrequencySketch< Key >::SetCapacity( Uint capacity )
+{
+    // Row width : The power of 2 not less than the capacity, at least 16.
+    Uint width = 16;
+    while ( width < capacity ) { width *= 2; }
+
+    m_counters.assign( width * NUM_ROWS, 0 );
+    m_rowMask = width - 1;
+
+    m_additions = 0;
+    m_sampleSize = std::max( capacity, 1u ) * 10;
+}
+
+
+template< typename Key >
+inline void FrequencySketch< Key >::Increment( const Key& k )
+{
+    const Uint64 hash = HashOf( k );
+
+    for ( Uint row = 0; row < NUM_ROWS; ++ row )
+    {
+        Byte& counter = m_counters[ this->IndexOf( hash, row )];
+        if ( MAX_COUNT > counter ) { ++ counter; }
+    }
+
+    if ( ++ m_additions >= m_sampleSize )
+    {
+        this->Age();
+    }
+}
+
+
+template< typename Key >
+inline Uint FrequencySketch< Key >::Frequency( const Key& k ) const
+{
+    const Uint64 hash = HashOf( k );
+
+    Uint frequency = MAX_COUNT;
+
+    for ( Uint row = 0; row < NUM_ROWS; ++ row )
+    {
+        frequency = std::min( frequency, static_cast< Uint >( m_counters[ this->IndexOf( hash, row )] ));
+    }
+
+    return frequency;
+}
+
+
+template< typename Key >
+inline void FrequencySketch< Key >::Clear()
+{
+    std::fill( m_counters.begin(), m_counters.end(), 0 );
+    m_additions = 0;
+}
+
+
+template< typename Key >
+inline void FrequencySketch< Key >::Age()
+{
+    for ( Uint i = 0; i < m_counters.size(); ++ i )
+    {
+        m_counters[i] /= 2;
+    }
+
+    m_additions /= 2;
+}
+
+
+template< typename Key >
+inline Uint FrequencySketch< Key >::IndexOf( Uint64 hash, Uint row ) const
+{
+    // Each row remixes the hash with its own odd multiplier.
+    static const Uint64 SEEDS[ NUM_ROWS ] =
+    {
+        0xC3A5C85C97CB3127ull, 0xB492B66FBE98F273ull, 0x9AE16A3B2F90404Full, 0xCBF29CE484222325ull
+    };
+
+    const Uint index = static_cast< Uint >(( hash * SEEDS[ row ]) >> 32 ) & m_rowMask;
+    return row * ( m_rowMask + 1 ) + index;
+}
+
+
+template< typename Key >
+inline Uint64 FrequencySketch< Key >::HashOf( const Key& k )
+{
+    Uint64 hash = static_cast< Uint64 >( std::hash< Key >()( k ));
+    hash *= 0x9E3779B97F4A7C15ull;
+    return hash ^ ( hash >> 32 );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Detail
+
+} // namespace Concurrent
+
+} // namespace Caramel
+
+#endif // __CARAMEL_CONCURRENT_FREQUENCY_SKETCH_H
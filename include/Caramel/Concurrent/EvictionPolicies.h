@@ -0,0 +1,310 @@
+// Caramel C++ Library - Concurrent Amenity - Eviction Policies Header
+
+#ifndef __CARAMEL_CONCURRENT_EVICTION_POLICIES_H
+#define __CARAMEL_CONCURRENT_EVICTION_POLICIES_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Concurrent/Detail/FrequencySketch.h>
+#include <algorithm>
+#include <iterator>
+#include <list>
+
+
+namespace Caramel
+{
+
+namespace Concurrent
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Eviction Policies of Concurrent::Cache
+// - Each policy provides an Order< Key > class, which keeps the keys of
+//   one cache shard in its eviction order. It is protected by the shard lock.
+//
+//   Add() returns a handle of the new key, the shard stores it with the value.
+//   After adding, the shard calls PopVictim() until it returns false.
+//
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Evict LRU
+// - Evicts the least recently used key.
+//
+
+struct EvictLru
+{
+    template< typename Key >
+    class Order
+    {
+    public:
+
+        typedef typename std::list< Key >::iterator Handle;
+
+        Order() : m_capacity( 1 ) {}
+
+        void SetCapacity( Uint capacity ) { m_capacity = capacity; }
+
+        Handle Add( const Key& k );
+        void   Touch( Handle handle );
+        void   Remove( Handle handle ) { m_keys.erase( handle ); }
+
+        // Returns false if the shard is within its capacity.
+        Bool PopVictim( Key& victim );
+
+        void Clear() { m_keys.clear(); }
+
+    private:
+
+        std::list< Key > m_keys;  // The front is the most recently used.
+        Uint m_capacity;
+    };
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Evict TinyLFU
+// - Window TinyLFU : A small LRU window in front of a segmented LRU.
+//
+//   New keys enter the window (1% of the capacity). A key pushed out of the
+//   window becomes a candidate of the main segments, and the FrequencySketch
+//   decides whether it or the main segments' LRU victim is evicted.
+//   Keys accessed again in the probation segment are promoted to
+//   the protected segment (80% of the main segments).
+//
+//   It resists scans and one-hit wonders much better than pure LRU.
+//
+
+struct EvictTinyLfu
+{
+    template< typename Key >
+    class Order
+    {
+        enum Segment
+        {
+            SEGMENT_WINDOW,
+            SEGMENT_PROBATION,
+            SEGMENT_PROTECTED,
+        };
+
+        struct Node
+        {
+            Key key;
+            Segment segment;
+
+            Node( const Key& k, Segment s ) : key( k ), segment( s ) {}
+        };
+
+        typedef std::list< Node > NodeList;
+
+    public:
+
+        typedef typename NodeList::iterator Handle;
+
+        Order();
+
+        void SetCapacity( Uint capacity );
+
+        Handle Add( const Key& k );
+        void   Touch( Handle handle );
+        void   Remove( Handle handle );
+
+        // Returns false if the shard is within its capacity.
+        Bool PopVictim( Key& victim );
+
+        void Clear();
+
+    private:
+
+        NodeList& ListOf( Segment segment );
+
+        Uint MainSize() const { return static_cast< Uint >( m_probation.size() + m_protected.size() ); }
+
+        NodeList m_window;
+        NodeList m_probation;
+        NodeList m_protected;
+
+        Uint m_windowCapacity;
+        Uint m_mainCapacity;
+        Uint m_protectedCapacity;
+
+        Detail::FrequencySketch< Key > m_sketch;
+    };
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+//
+// Evict LRU
+//
+
+template< typename Key >
+inline auto EvictLru::Order< Key >::Add( const Key& k ) -> Handle
+{
+    m_keys.push_front( k );
+    return m_keys.begin();
+}
+
+
+template< typename Key >
+inline void EvictLru::Order< Key >::Touch( Handle handle )
+{
+    m_keys.splice( m_keys.begin(), m_keys, handle );
+}
+
+
+template< typename Key >
+inline Bool EvictLru::Order< Key >::PopVictim( Key& victim )
+{
+    if ( m_capacity >= m_keys.size() ) { return false; }
+
+    victim = m_keys.back();
+    m_keys.pop_back();
+    return true;
+}
+
+
+//
+// Evict TinyLFU
+//
+
+template< typename Key >
+inline EvictTinyLfu::Order< Key >::Order()
+    : m_windowCapacity( 1 )
+    , m_mainCapacity( 0 )
+    , m_protectedCapacity( 0 )
+{
+}
+
+
+template< typename Key >
+inline void EvictTinyLfu::Order< Key >::SetCapacity( Uint capacity )
+{
+    m_windowCapacity = std::max( capacity / 100, 1u );
+    m_mainCapacity = capacity > m_windowCapacity ? capacity - m_windowCapacity : 0;
+    m_protectedCapacity = m_mainCapacity * 4 / 5;
+
+    m_sketch.SetCapacity( capacity );
+}
+
+
+template< typename Key >
+inline auto EvictTinyLfu::Order< Key >::Add( const Key& k ) -> Handle
+{
+    m_sketch.Increment( k );
+
+    m_window.push_front( Node( k, SEGMENT_WINDOW ));
+    return m_window.begin();
+}
+
+
+template< typename Key >
+inline void EvictTinyLfu::Order< Key >::Touch( Handle handle )
+{
+    m_sketch.Increment( handle->key );
+
+    switch ( handle->segment )
+    {
+    case SEGMENT_WINDOW:
+        m_window.splice( m_window.begin(), m_window, handle );
+        break;
+
+    case SEGMENT_PROBATION:
+        // Promote to protected, and demote the protected LRU if it overflows.
+        handle->segment = SEGMENT_PROTECTED;
+        m_protected.splice( m_protected.begin(), m_probation, handle );
+
+        if ( m_protected.size() > m_protectedCapacity )
+        {
+            auto demoted = std::prev( m_protected.end() );
+            demoted->segment = SEGMENT_PROBATION;
+            m_probation.splice( m_probation.begin(), m_protected, demoted );
+        }
+        break;
+
+    case SEGMENT_PROTECTED:
+        m_protected.splice( m_protected.begin(), m_protected, handle );
+        break;
+    }
+}
+
+
+template< typename Key >
+inline void EvictTinyLfu::Order< Key >::Remove( Handle handle )
+{
+    this->ListOf( handle->segment ).erase( handle );
+}
+
+
+template< typename Key >
+inline Bool EvictTinyLfu::Order< Key >::PopVictim( Key& victim )
+{
+    if ( m_windowCapacity >= m_window.size() ) { return false; }
+
+    // The window LRU becomes a candidate of the main segments.
+
+    auto candidate = std::prev( m_window.end() );
+    candidate->segment = SEGMENT_PROBATION;
+    m_probation.splice( m_probation.begin(), m_window, candidate );
+
+    if ( m_mainCapacity >= this->MainSize() ) { return false; }
+
+    // Admission : The less frequent one of the candidate and
+    //             the probation LRU is evicted.
+    //             The protected segment is bounded, therefore the probation
+    //             has more than the candidate, unless the capacity is tiny.
+
+    if ( m_probation.size() > 1 )
+    {
+        auto lru = std::prev( m_probation.end() );
+
+        if ( m_sketch.Frequency( candidate->key ) > m_sketch.Frequency( lru->key ))
+        {
+            victim = lru->key;
+            m_probation.erase( lru );
+            return true;
+        }
+    }
+
+    victim = candidate->key;
+    m_probation.erase( candidate );
+
+    return true;
+}
+
+
+template< typename Key >
+inline void EvictTinyLfu::Order< Key >::Clear()
+{
+    m_window.clear();
+    m_probation.clear();
+    m_protected.clear();
+    m_sketch.Clear();
+}
+
+
+template< typename Key >
+inline auto EvictTinyLfu::Order< Key >::ListOf( Segment segment ) -> NodeList&
+{
+    switch ( segment )
+    {
+    case SEGMENT_WINDOW:    return m_window;
+    case SEGMENT_PROBATION: return m_probation;
+    default:                return m_protected;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Concurrent
+
+} // namespace Caramel
+
+#endif // __CARAMEL_CONCURRENT_EVICTION_POLICIES_H
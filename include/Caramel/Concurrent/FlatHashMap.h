@@ -0,0 +1,811 @@
+// Caramel C++ Library - Concurrent Amenity - Flat Hash Map Header
+
+#ifndef __CARAMEL_CONCURRENT_FLAT_HASH_MAP_H
+#define __CARAMEL_CONCURRENT_FLAT_HASH_MAP_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Concurrent/ReplicatePolicies.h>
+#include <Caramel/Functional/ScopeExit.h>
+#include <Caramel/Thread/LockContention.h>
+#include <Caramel/Thread/MutexLocks.h>
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+namespace Caramel
+{
+
+namespace Concurrent
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Concurrent Flat Hash Map
+// - An open addressing hash map, in the style of Swiss Table.
+//
+//   Slots are stored inline, in groups of 8. Each group has a 64-bit word of
+//   control bytes : EMPTY, DELETED, or the 7 low bits of the key's hash.
+//   A lookup matches all control bytes of a group in one go (SWAR),
+//   and only compares keys of the matched slots. There is no node allocation,
+//   and no pointer chasing but the table itself.
+//
+//   Accessors are lock-free and never write any shared cache line :
+//   Each group is guarded by a sequence lock, the readers copy the slot out
+//   and retry if a writer has touched the group meanwhile.
+//   Modifiers are serialized by a mutex, as Detail::BasicMap.
+//
+//   Because of the optimistic reads, both Key and Value must be trivially
+//   copyable, e.g. integers, enums, raw pointers or POD structs.
+//   Use HashMap or StripedHashMap for other types.
+//
+//   The tables replaced by growing are kept until the map is destroyed,
+//   since a reader may still be reading them. They never take more memory
+//   than the current table does.
+//
+// NOTE: The ( Key, Value ) naming convention is belong to .NET Framework,
+//       not STL/Boost style.
+//
+
+template< typename Key, typename Value, typename ReplicatePolicy = ReplicateNothing >
+class FlatHashMap : public ReplicatePolicy::template Dictionary< Key, Value >
+                  , public boost::noncopyable
+{
+    static_assert( std::is_trivially_copyable< Key >::value && std::is_trivially_copyable< Value >::value,
+                   "Key and Value of FlatHashMap must be trivially copyable" );
+
+public:
+
+    typedef Key   KeyType;
+    typedef Value ValueType;
+
+    typedef typename ReplicatePolicy::template Dictionary< Key, Value > Replicator;
+
+    FlatHashMap();
+    ~FlatHashMap();
+
+
+    /// Properties ///
+
+    Bool IsEmpty() const { return 0 == m_size; }
+    Uint Size()    const { return m_size; }
+
+
+    /// Lock-free Accessors ///
+
+    Bool Contains( const Key& k ) const;
+    Bool Find( const Key& k, Value& v ) const;
+
+    // Same as Detail::BasicMap, but each key is looked up without locking.
+    template< typename KeyIterator, typename OutputIterator >
+    Uint FindMany( KeyIterator first, KeyIterator last, OutputIterator result ) const;
+
+
+    /// Accessors ///
+
+    //
+    // Call f( key, value ) on each entry, with the modifiers locked.
+    // - Don't modify this map in f, otherwise it would deadlock.
+    //
+    template< typename Function >
+    void ForEach( Function f ) const;
+
+
+    /// Modifiers ///
+
+    Bool Insert( const Key& k, const Value& v );
+
+    // Same as Detail::BasicMap
+    template< typename InputIterator >
+    Uint InsertRange( InputIterator first, InputIterator last );
+
+    Bool Upsert( const Key& k, const Value& v );
+
+    template< typename Factory >
+    Value ComputeIfAbsent( const Key& k, Factory factory );
+
+    Bool Erase( const Key& k );
+
+
+    /// Instrumentation ///
+
+    // Name the lock in the contention report, see Thread/LockContention.h
+    void SetContentionName( const std::string& name ) { m_writeMutex.SetName( name ); }
+
+    // Bytes taken by the current and the retired tables, with the modifiers locked.
+    Uint64 GetMemoryBytes() const;
+
+
+private:
+
+    /// Internal Types ///
+
+    static const Uint GROUP_SIZE = 8;
+
+    static const Byte CTRL_EMPTY   = 0x80;
+    static const Byte CTRL_DELETED = 0xFE;
+    static const Byte HASH_MASK    = 0x7F;
+
+    static const Uint64 LSBS = 0x0101010101010101ull;  // The lowest bit of each byte.
+    static const Uint64 MSBS = 0x8080808080808080ull;  // The highest bit of each byte.
+
+    struct Slot
+    {
+        Key key;
+        Value value;
+    };
+
+    struct Group
+    {
+        std::atomic< Uint32 > seq;   // Odd while a writer is in the group.
+        std::atomic< Uint64 > ctrl;  // Control byte of slot i is at bits [ 8i, 8i + 8 ).
+        Slot slots[ GROUP_SIZE ];
+
+        Group() : seq( 0 ), ctrl( LSBS * CTRL_EMPTY ) {}
+
+        void BeginWrite();
+        void EndWrite();
+    };
+
+    class Table : public boost::noncopyable
+    {
+    public:
+        explicit Table( Uint numGroups );
+        ~Table();
+
+        Uint NumGroups() const { return m_groupMask + 1; }
+
+        // Keep at least 1/8 of the slots empty, so that probing always ends.
+        Uint MaxLoad() const { return this->NumGroups() * ( GROUP_SIZE - 1 ); }
+
+        Group&       GetGroup( Uint64 hash, Uint probe );
+        const Group& GetGroup( Uint64 hash, Uint probe ) const;
+
+        Group* m_groups;
+        Uint m_groupMask;
+        Uint m_tombstones;  // Accessed by writers only.
+    };
+
+
+    /// Internal Functions ///
+
+    static Uint64 HashOf( const Key& k );
+    static Byte   CtrlOf( Uint64 hash ) { return static_cast< Byte >( hash & HASH_MASK ); }
+
+    // Group operations, Return a mask of the highest bits of matched bytes.
+    static Uint64 MatchByte( Uint64 ctrl, Byte b );
+    static Uint64 MatchEmpty( Uint64 ctrl );
+    static Uint64 MatchEmptyOrDeleted( Uint64 ctrl );
+
+    static Uint   LowestIndex( Uint64 mask );
+    static Uint64 SetCtrlByte( Uint64 ctrl, Uint index, Byte b );
+
+    // Lock-free lookup. Returns false if not found.
+    Bool LookUp( const Key& k, Slot& found ) const;
+
+    // REMARKS: The functions below should be called with m_writeMutex locked.
+
+    Bool FindSlot( const Key& k, Uint64 hash, Group*& group, Uint& index ) const;
+
+    void InsertNew( const Key& k, Uint64 hash, const Value& v );
+    void Rehash();
+
+    static void Place( Table& table, Uint64 hash, const Key& k, const Value& v );
+
+
+    /// Data Members ///
+
+    static const Uint CACHE_LINE_SIZE = 64;  // Common CPU cache line length.
+
+    typedef Byte CacheLinePad[ CACHE_LINE_SIZE ];
+
+    // Read by all readers, written only when the table is replaced or purged.
+    std::atomic< Table* > m_table;
+    std::atomic< Uint32 > m_tableSeq;
+
+    CacheLinePad m_pad0;
+    std::atomic< Uint > m_size;
+
+    std::vector< Table* > m_retiredTables;
+
+    mutable TrackedMutex m_writeMutex;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+//
+// Group
+// - The sequence lock of writers. Writers are serialized by the map.
+//
+
+template< typename Key, typename Value, typename ReplicateP >
+inline void FlatHashMap< Key, Value, ReplicateP >::Group::BeginWrite()
+{
+    seq.store( seq.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+inline void FlatHashMap< Key, Value, ReplicateP >::Group::EndWrite()
+{
+    seq.store( seq.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+}
+
+
+//
+// Table
+// - Groups are probed in triangular steps : +1, +2, +3 ...
+//   With a power of 2 number of groups, it visits every group exactly once.
+//
+
+template< typename Key, typename Value, typename ReplicateP >
+inline FlatHashMap< Key, Value, ReplicateP >::Table::Table( Uint numGroups )
+    : m_groups( new Group[ numGroups ] )
+    , m_groupMask( numGroups - 1 )
+    , m_tombstones( 0 )
+{
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+inline FlatHashMap< Key, Value, ReplicateP >::Table::~Table()
+{
+    delete [] m_groups;
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+inline auto FlatHashMap< Key, Value, ReplicateP >::Table::GetGroup( Uint64 hash, Uint probe ) const -> const Group&
+{
+    const Uint64 offset = ( hash >> 7 ) + static_cast< Uint64 >( probe ) * ( probe + 1 ) / 2;
+    return m_groups[ offset & m_groupMask ];
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+inline auto FlatHashMap< Key, Value, ReplicateP >::Table::GetGroup( Uint64 hash, Uint probe ) -> Group&
+{
+    return const_cast< Group& >( static_cast< const Table* >( this )->GetGroup( hash, probe ));
+}
+
+
+//
+// Flat Hash Map
+//
+
+template< typename Key, typename Value, typename ReplicateP >
+inline FlatHashMap< Key, Value, ReplicateP >::FlatHashMap()
+    : m_table( new Table( 2 ))
+    , m_tableSeq( 0 )
+    , m_size( 0 )
+{
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+inline FlatHashMap< Key, Value, ReplicateP >::~FlatHashMap()
+{
+    delete m_table.load( std::memory_order_relaxed );
+
+    for ( Uint i = 0; i < m_retiredTables.size(); ++ i )
+    {
+        delete m_retiredTables[i];
+    }
+}
+
+
+//
+// Lock-free Accessors
+//
+
+template< typename Key, typename Value, typename ReplicateP >
+inline Bool FlatHashMap< Key, Value, ReplicateP >::Contains( const Key& k ) const
+{
+    Slot found;
+    return this->LookUp( k, found );
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+inline Bool FlatHashMap< Key, Value, ReplicateP >::Find( const Key& k, Value& v ) const
+{
+    Slot found;
+    if ( ! this->LookUp( k, found )) { return false; }
+
+    v = found.value;
+    return true;
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+template< typename KeyIterator, typename OutputIterator >
+inline Uint FlatHashMap< Key, Value, ReplicateP >::FindMany(
+    KeyIterator first, KeyIterator last, OutputIterator result ) const
+{
+    Uint count = 0;
+    Slot found;
+
+    for ( ; first != last; ++ first )
+    {
+        if ( this->LookUp( *first, found ))
+        {
+            *result = std::make_pair( found.key, found.value );
+            ++ result;
+            ++ count;
+        }
+    }
+
+    return count;
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+inline Bool FlatHashMap< Key, Value, ReplicateP >::LookUp( const Key& k, Slot& found ) const
+{
+    const Uint64 hash = HashOf( k );
+    const Byte h2 = CtrlOf( hash );
+
+    for ( ;; )
+    {
+        const Uint32 tableSeq = m_tableSeq.load( std::memory_order_acquire );
+        if ( tableSeq & 1 )
+        {
+            // The table is being purged.
+            std::this_thread::yield();
+            continue;
+        }
+
+        const Table* table = m_table.load( std::memory_order_acquire );
+        Bool hit = false;
+
+        for ( Uint probe = 0; probe < table->NumGroups(); ++ probe )
+        {
+            const Group& group = table->GetGroup( hash, probe );
+
+            Uint64 ctrl = 0;
+
+            for ( ;; )
+            {
+                const Uint32 seq = group.seq.load( std::memory_order_acquire );
+                if ( seq & 1 )
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                ctrl = group.ctrl.load( std::memory_order_relaxed );
+                hit = false;
+
+                for ( Uint64 mask = MatchByte( ctrl, h2 ); 0 != mask; mask &= mask - 1 )
+                {
+                    // The slot may be torn by a writer, it is validated below.
+                    std::memcpy( &found, &group.slots[ LowestIndex( mask )], sizeof( Slot ));
+
+                    if ( found.key == k )
+                    {
+                        hit = true;
+                        break;
+                    }
+                }
+
+                std::atomic_thread_fence( std::memory_order_acquire );
+                if ( seq == group.seq.load( std::memory_order_relaxed )) { break; }
+            }
+
+            if ( hit || 0 != MatchEmpty( ctrl )) { break; }
+        }
+
+        std::atomic_thread_fence( std::memory_order_acquire );
+        if ( tableSeq == m_tableSeq.load( std::memory_order_relaxed ))
+        {
+            return hit;
+        }
+    }
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+template< typename Function >
+inline void FlatHashMap< Key, Value, ReplicateP >::ForEach( Function f ) const
+{
+    auto ulock = UniqueLock( m_writeMutex );
+
+    const Table* table = m_table.load( std::memory_order_relaxed );
+
+    for ( Uint i = 0; i < table->NumGroups(); ++ i )
+    {
+        const Group& group = table->m_groups[i];
+
+        for ( Uint64 mask = ~group.ctrl.load( std::memory_order_relaxed ) & MSBS; 0 != mask; mask &= mask - 1 )
+        {
+            const Slot& slot = group.slots[ LowestIndex( mask )];
+            f( slot.key, slot.value );
+        }
+    }
+}
+
+
+//
+// Modifiers
+//
+
+template< typename Key, typename Value, typename ReplicateP >
+inline Bool FlatHashMap< Key, Value, ReplicateP >::Insert( const Key& k, const Value& v )
+{
+    auto ulock = UniqueLock( m_writeMutex );
+
+    const Uint64 hash = HashOf( k );
+
+    Group* group = nullptr;
+    Uint index = 0;
+    if ( this->FindSlot( k, hash, group, index )) { return false; }
+
+    this->InsertNew( k, hash, v );
+    this->Replicator::Insert( k, v );
+
+    return true;
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+template< typename InputIterator >
+inline Uint FlatHashMap< Key, Value, ReplicateP >::InsertRange( InputIterator first, InputIterator last )
+{
+    auto ulock = UniqueLock( m_writeMutex );
+
+    // Replicate the whole range at once.
+    this->Replicator::BeginBatch();
+    auto commit = ScopeExit( [this] { this->Replicator::CommitBatch(); } );
+
+    Uint count = 0;
+
+    for ( ; first != last; ++ first )
+    {
+        const Key& k = first->first;
+        const Uint64 hash = HashOf( k );
+
+        Group* group = nullptr;
+        Uint index = 0;
+        if ( this->FindSlot( k, hash, group, index )) { continue; }
+
+        this->InsertNew( k, hash, first->second );
+        this->Replicator::Insert( k, first->second );
+        ++ count;
+    }
+
+    return count;
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+inline Bool FlatHashMap< Key, Value, ReplicateP >::Upsert( const Key& k, const Value& v )
+{
+    auto ulock = UniqueLock( m_writeMutex );
+
+    const Uint64 hash = HashOf( k );
+
+    Group* group = nullptr;
+    Uint index = 0;
+    const Bool exists = this->FindSlot( k, hash, group, index );
+
+    if ( exists )
+    {
+        group->BeginWrite();
+        group->slots[ index ].value = v;
+        group->EndWrite();
+    }
+    else
+    {
+        this->InsertNew( k, hash, v );
+    }
+
+    this->Replicator::Insert( k, v );
+
+    return ! exists;
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+template< typename Factory >
+inline Value FlatHashMap< Key, Value, ReplicateP >::ComputeIfAbsent( const Key& k, Factory factory )
+{
+    // Fast path, without locking.
+    Slot found;
+    if ( this->LookUp( k, found )) { return found.value; }
+
+    auto ulock = UniqueLock( m_writeMutex );
+
+    const Uint64 hash = HashOf( k );
+
+    Group* group = nullptr;
+    Uint index = 0;
+    if ( this->FindSlot( k, hash, group, index )) { return group->slots[ index ].value; }
+
+    const Value v = factory();
+
+    this->InsertNew( k, hash, v );
+    this->Replicator::Insert( k, v );
+
+    return v;
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+inline Bool FlatHashMap< Key, Value, ReplicateP >::Erase( const Key& k )
+{
+    auto ulock = UniqueLock( m_writeMutex );
+
+    const Uint64 hash = HashOf( k );
+
+    Group* group = nullptr;
+    Uint index = 0;
+    if ( ! this->FindSlot( k, hash, group, index )) { return false; }
+
+    const Uint64 ctrl = group->ctrl.load( std::memory_order_relaxed );
+
+    // If the group still has an empty slot, no probing ever passes through it,
+    // therefore the slot can be emptied directly, without leaving a tombstone.
+    Byte mark = CTRL_EMPTY;
+    if ( 0 == MatchEmpty( ctrl ))
+    {
+        mark = CTRL_DELETED;
+        ++ m_table.load( std::memory_order_relaxed )->m_tombstones;
+    }
+
+    group->BeginWrite();
+    group->ctrl.store( SetCtrlByte( ctrl, index, mark ), std::memory_order_relaxed );
+    group->EndWrite();
+
+    -- m_size;
+    this->Replicator::Erase( k );
+
+    return true;
+}
+
+
+//
+// Instrumentation
+//
+
+template< typename Key, typename Value, typename ReplicateP >
+inline Uint64 FlatHashMap< Key, Value, ReplicateP >::GetMemoryBytes() const
+{
+    auto ulock = UniqueLock( m_writeMutex );
+
+    Uint64 numGroups = m_table.load( std::memory_order_relaxed )->NumGroups();
+
+    for ( Uint i = 0; i < m_retiredTables.size(); ++ i )
+    {
+        numGroups += m_retiredTables[i]->NumGroups();
+    }
+
+    return numGroups * sizeof( Group );
+}
+
+
+//
+// Writer Functions
+//
+
+template< typename Key, typename Value, typename ReplicateP >
+inline Bool FlatHashMap< Key, Value, ReplicateP >::FindSlot(
+    const Key& k, Uint64 hash, Group*& group, Uint& index ) const
+{
+    Table* table = m_table.load( std::memory_order_relaxed );
+    const Byte h2 = CtrlOf( hash );
+
+    for ( Uint probe = 0; probe < table->NumGroups(); ++ probe )
+    {
+        Group& current = table->GetGroup( hash, probe );
+        const Uint64 ctrl = current.ctrl.load( std::memory_order_relaxed );
+
+        for ( Uint64 mask = MatchByte( ctrl, h2 ); 0 != mask; mask &= mask - 1 )
+        {
+            const Uint i = LowestIndex( mask );
+
+            if ( current.slots[i].key == k )
+            {
+                group = &current;
+                index = i;
+                return true;
+            }
+        }
+
+        if ( 0 != MatchEmpty( ctrl )) { break; }
+    }
+
+    return false;
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+inline void FlatHashMap< Key, Value, ReplicateP >::InsertNew( const Key& k, Uint64 hash, const Value& v )
+{
+    Table* table = m_table.load( std::memory_order_relaxed );
+
+    if ( m_size + table->m_tombstones >= table->MaxLoad() )
+    {
+        this->Rehash();
+        table = m_table.load( std::memory_order_relaxed );
+    }
+
+    Place( *table, hash, k, v );
+    ++ m_size;
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+inline void FlatHashMap< Key, Value, ReplicateP >::Place( Table& table, Uint64 hash, const Key& k, const Value& v )
+{
+    for ( Uint probe = 0; ; ++ probe )
+    {
+        Group& group = table.GetGroup( hash, probe );
+        const Uint64 ctrl = group.ctrl.load( std::memory_order_relaxed );
+
+        const Uint64 mask = MatchEmptyOrDeleted( ctrl );
+        if ( 0 == mask ) { continue; }
+
+        const Uint index = LowestIndex( mask );
+
+        if ( CTRL_DELETED == static_cast< Byte >( ctrl >> ( index * 8 )))
+        {
+            -- table.m_tombstones;  // Reuse a tombstone.
+        }
+
+        group.BeginWrite();
+
+        Slot& slot = group.slots[ index ];
+        slot.key = k;
+        slot.value = v;
+        group.ctrl.store( SetCtrlByte( ctrl, index, CtrlOf( hash )), std::memory_order_relaxed );
+
+        group.EndWrite();
+        return;
+    }
+}
+
+
+//
+// Rehash
+// - Grows the table if it is more than half full of live entries.
+//   Otherwise it is full of tombstones, and is purged in place.
+//
+
+template< typename Key, typename Value, typename ReplicateP >
+inline void FlatHashMap< Key, Value, ReplicateP >::Rehash()
+{
+    Table* table = m_table.load( std::memory_order_relaxed );
+
+    // Collect the live entries.
+
+    std::vector< std::pair< Uint64, Slot > > entries;
+    entries.reserve( m_size );
+
+    for ( Uint i = 0; i < table->NumGroups(); ++ i )
+    {
+        const Group& group = table->m_groups[i];
+
+        for ( Uint64 mask = ~group.ctrl.load( std::memory_order_relaxed ) & MSBS; 0 != mask; mask &= mask - 1 )
+        {
+            const Slot& slot = group.slots[ LowestIndex( mask )];
+            entries.push_back( std::make_pair( HashOf( slot.key ), slot ));
+        }
+    }
+
+    if ( m_size * 2 >= table->MaxLoad() )
+    {
+        // Grow : Readers of the old table still see a consistent map,
+        //        since it is never modified after being retired.
+
+        Table* grown = new Table( table->NumGroups() * 2 );
+
+        for ( Uint i = 0; i < entries.size(); ++ i )
+        {
+            Place( *grown, entries[i].first, entries[i].second.key, entries[i].second.value );
+        }
+
+        m_table.store( grown, std::memory_order_release );
+        m_retiredTables.push_back( table );
+    }
+    else
+    {
+        // Purge : Entries are moving between groups,
+        //         readers would retry until it is done.
+
+        m_tableSeq.store( m_tableSeq.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_release );
+
+        for ( Uint i = 0; i < table->NumGroups(); ++ i )
+        {
+            table->m_groups[i].ctrl.store( LSBS * CTRL_EMPTY, std::memory_order_relaxed );
+        }
+
+        table->m_tombstones = 0;
+
+        for ( Uint i = 0; i < entries.size(); ++ i )
+        {
+            Place( *table, entries[i].first, entries[i].second.key, entries[i].second.value );
+        }
+
+        m_tableSeq.store( m_tableSeq.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+    }
+}
+
+
+//
+// Hashing and Group Operations
+// - std::hash of integers is often an identity function, therefore the hash is
+//   mixed, to spread both the group index and the control byte.
+//
+
+template< typename Key, typename Value, typename ReplicateP >
+inline Uint64 FlatHashMap< Key, Value, ReplicateP >::HashOf( const Key& k )
+{
+    Uint64 hash = static_cast< Uint64 >( std::hash< Key >()( k ));
+    hash *= 0x9E3779B97F4A7C15ull;
+    return hash ^ ( hash >> 32 );
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+inline Uint64 FlatHashMap< Key, Value, ReplicateP >::MatchByte( Uint64 ctrl, Byte b )
+{
+    // May have false positives next to a true match, keys are compared anyway.
+    const Uint64 x = ctrl ^ ( LSBS * b );
+    return ( x - LSBS ) & ~x & MSBS;
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+inline Uint64 FlatHashMap< Key, Value, ReplicateP >::MatchEmpty( Uint64 ctrl )
+{
+    // EMPTY is the only control byte with the highest bit set and bit 1 cleared.
+    return ctrl & ~( ctrl << 6 ) & MSBS;
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+inline Uint64 FlatHashMap< Key, Value, ReplicateP >::MatchEmptyOrDeleted( Uint64 ctrl )
+{
+    return ctrl & MSBS;
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+inline Uint FlatHashMap< Key, Value, ReplicateP >::LowestIndex( Uint64 mask )
+{
+    Uint index = 0;
+    while ( 0 == ( mask & 0x80 ))
+    {
+        mask >>= 8;
+        ++ index;
+    }
+    return index;
+}
+
+
+template< typename Key, typename Value, typename ReplicateP >
+inline Uint64 FlatHashMap< Key, Value, ReplicateP >::SetCtrlByte( Uint64 ctrl, Uint index, Byte b )
+{
+    const Uint shift = index * 8;
+    return ( ctrl & ~( 0xFFull << shift )) | ( static_cast< Uint64 >( b ) << shift );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Concurrent
+
+} // namespace Caramel
+
+#endif // __CARAMEL_CONCURRENT_FLAT_HASH_MAP_H
@@ -0,0 +1,173 @@
+// Caramel C++ Library - Concurrent Amenity - Intrusive Queue Header
+
+#ifndef __CARAMEL_CONCURRENT_INTRUSIVE_QUEUE_H
+#define __CARAMEL_CONCURRENT_INTRUSIVE_QUEUE_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <boost/noncopyable.hpp>
+#include <atomic>
+
+
+namespace Caramel
+{
+
+namespace Concurrent
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Intrusive Queue Node
+// - Derive the elements of IntrusiveQueue from it.
+//   A node can only be in one queue at a time.
+//
+
+struct IntrusiveQueueNode
+{
+    IntrusiveQueueNode() : queueNext( nullptr ) {}
+
+    std::atomic< IntrusiveQueueNode* > queueNext;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Concurrent Intrusive Queue
+// - A lock-free multiple-producer / single-consumer FIFO queue of nodes,
+//   by Dmitry Vyukov's algorithm.
+//
+//   The queue links the nodes by themselves, so it never allocates.
+//   It doesn't own the nodes, they must outlive their stay in the queue.
+//
+// USAGE:
+//   Push() is wait-free, and may be called by any thread.
+//   TryPop() may only be called by one thread at a time.
+//
+//   TryPop() returns null if the queue is empty, or if a Push() is in the
+//   middle of linking its node. Count the pushed nodes by yourself, if you
+//   need to tell these cases apart.
+//
+
+template< typename T >
+class IntrusiveQueue : public boost::noncopyable
+{
+public:
+
+    IntrusiveQueue();
+
+
+    /// Producer Operations ///
+
+    void Push( T* node );
+
+
+    /// Consumer Operations ///
+
+    T* TryPop();
+
+
+private:
+
+    /// Internal Functions ///
+
+    void PushNode( IntrusiveQueueNode* node );
+
+
+    /// Data Members ///
+
+    static const Uint CACHE_LINE_SIZE = 64;  // Common CPU cache line length.
+
+    typedef Byte CacheLinePad[ CACHE_LINE_SIZE ];
+
+    // Producers
+    std::atomic< IntrusiveQueueNode* > m_back;
+
+    // Consumer
+    CacheLinePad m_pad0;
+    IntrusiveQueueNode* m_front;
+    IntrusiveQueueNode m_stub;
+
+    CacheLinePad m_pad1;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+template< typename T >
+inline IntrusiveQueue< T >::IntrusiveQueue()
+    : m_back( &m_stub )
+    , m_front( &m_stub )
+{
+}
+
+
+template< typename T >
+inline void IntrusiveQueue< T >::Push( T* node )
+{
+    this->PushNode( node );
+}
+
+
+template< typename T >
+inline void IntrusiveQueue< T >::PushNode( IntrusiveQueueNode* node )
+{
+    node->queueNext.store( nullptr, std::memory_order_relaxed );
+
+    // The node is in the queue from here, but can't be popped
+    // until the previous one links to it.
+    IntrusiveQueueNode* prev = m_back.exchange( node, std::memory_order_acq_rel );
+    prev->queueNext.store( node, std::memory_order_release );
+}
+
+
+template< typename T >
+inline T* IntrusiveQueue< T >::TryPop()
+{
+    IntrusiveQueueNode* front = m_front;
+    IntrusiveQueueNode* next = front->queueNext.load( std::memory_order_acquire );
+
+    // Skip the stub.
+    if ( &m_stub == front )
+    {
+        if ( ! next ) { return nullptr; }
+
+        m_front = next;
+        front = next;
+        next = next->queueNext.load( std::memory_order_acquire );
+    }
+
+    if ( next )
+    {
+        m_front = next;
+        return static_cast< T* >( front );
+    }
+
+    // The front is the last one, or a Push() is in the middle.
+
+    if ( front != m_back.load( std::memory_order_acquire )) { return nullptr; }
+
+    // Put the stub back behind the last one, then it can be popped.
+    this->PushNode( &m_stub );
+
+    next = front->queueNext.load( std::memory_order_acquire );
+
+    if ( next )
+    {
+        m_front = next;
+        return static_cast< T* >( front );
+    }
+
+    return nullptr;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Concurrent
+
+} // namespace Caramel
+
+#endif // __CARAMEL_CONCURRENT_INTRUSIVE_QUEUE_H
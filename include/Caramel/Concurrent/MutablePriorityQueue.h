@@ -0,0 +1,311 @@
+// Caramel C++ Library - Concurrent Amenity - Mutable Priority Queue Header
+
+#ifndef __CARAMEL_CONCURRENT_MUTABLE_PRIORITY_QUEUE_H
+#define __CARAMEL_CONCURRENT_MUTABLE_PRIORITY_QUEUE_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Thread/LockContention.h>
+#include <Caramel/Thread/MutexLocks.h>
+#include <boost/heap/d_ary_heap.hpp>
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace Caramel
+{
+
+namespace Concurrent
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Concurrent Mutable Priority Queue
+// - Based on boost::heap::d_ary_heap, with mutability.
+//
+//   Push() returns a handle of the entry, which can be used to erase it
+//   or to update its key in O( log n ), as long as the entry is in the queue.
+//   A handle of a popped or erased entry is simply ignored.
+//
+//   The compare policy is the same as Concurrent::PriorityQueue :
+//   std::less pops the LARGEST key first, std::greater the SMALLEST.
+//
+
+template< typename Key, typename Value, typename KeyCompare = std::less< Key > >
+class MutablePriorityQueue : public boost::noncopyable
+{
+public:
+
+    typedef Uint64 Handle;  // 0 is an invalid handle.
+
+    MutablePriorityQueue();
+
+
+    /// Operations ///
+
+    Handle Push( const Key& k, const Value& v );
+    Handle Push( const Key& k, Value&& v );
+
+    // Construct the value in place.
+    // - Only if CARAMEL_HAS_VARIADIC_TEMPLATES is defined.
+#if defined( CARAMEL_HAS_VARIADIC_TEMPLATES )
+    template< typename... Args >
+    Handle Emplace( const Key& k, Args&&... args );
+#endif
+
+    // The value is moved out.
+    Bool TryPop( Value& v );
+
+    //
+    // Pop all entries which are not lower than the key in priority,
+    // and append them into values, in the order of popping.
+    // - Takes the lock only once. Returns the number of popped entries.
+    //
+    Uint PopAllUntil( const Key& key, std::vector< Value >& values );
+
+    // Returns false if the entry is not in the queue.
+    Bool Erase( Handle handle );
+    Bool UpdateKey( Handle handle, const Key& k );
+
+
+    /// Thread-safe Properties ///
+
+    // Returns false if the queue is empty.
+    Bool PeekTopKey( Key& key ) const;
+
+    Bool IsEmpty() const { return 0 == m_size; }
+    Uint Size()    const { return m_size; }
+
+
+    /// Instrumentation ///
+
+    // Name the lock in the contention report, see Thread/LockContention.h
+    void SetContentionName( const std::string& name ) { m_queueMutex.SetName( name ); }
+
+
+private:
+
+    /// Internal Types ///
+
+    struct Entry
+    {
+        Key key;
+        Value value;
+        Handle handle;
+
+        // The handle is assigned by PushEntry().
+        Entry( const Key& k, const Value& v ) : key( k ), value( v ), handle( 0 ) {}
+        Entry( const Key& k, Value&& v ) : key( k ), value( std::move( v )), handle( 0 ) {}
+
+#if defined( CARAMEL_HAS_VARIADIC_TEMPLATES )
+        template< typename... Args >
+        Entry( const Key& k, Args&&... args ) : key( k ), value( std::forward< Args >( args )... ), handle( 0 ) {}
+#endif
+    };
+
+    struct EntryCompare
+    {
+        KeyCompare compare;
+
+        Bool operator()( const Entry& lhs, const Entry& rhs ) const { return compare( lhs.key, rhs.key ); }
+    };
+
+
+    /// Internal Functions ///
+
+    Handle PushEntry( Entry&& entry );
+
+    void PopTop( Value& value );
+
+
+    /// Data Members ///
+
+    typedef boost::heap::d_ary_heap<
+        Entry,
+        boost::heap::arity< 4 >,
+        boost::heap::mutable_< true >,
+        boost::heap::compare< EntryCompare >
+    > QueueType;
+    QueueType m_queue;
+
+    typedef std::unordered_map< Handle, typename QueueType::handle_type > HandleMap;
+    HandleMap m_handles;
+
+    Handle m_lastHandle;
+
+    std::atomic< Uint > m_size;
+
+    mutable TrackedMutex m_queueMutex;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+template< typename Key, typename Value, typename KeyCompare >
+inline MutablePriorityQueue< Key, Value, KeyCompare >::MutablePriorityQueue()
+    : m_lastHandle( 0 )
+    , m_size( 0 )
+{
+}
+
+
+template< typename Key, typename Value, typename KeyCompare >
+inline Uint64 MutablePriorityQueue< Key, Value, KeyCompare >::Push( const Key& k, const Value& v )
+{
+    return this->PushEntry( Entry( k, v ));
+}
+
+
+template< typename Key, typename Value, typename KeyCompare >
+inline Uint64 MutablePriorityQueue< Key, Value, KeyCompare >::Push( const Key& k, Value&& v )
+{
+    return this->PushEntry( Entry( k, std::move( v )));
+}
+
+
+#if defined( CARAMEL_HAS_VARIADIC_TEMPLATES )
+
+template< typename Key, typename Value, typename KeyCompare >
+template< typename... Args >
+inline Uint64 MutablePriorityQueue< Key, Value, KeyCompare >::Emplace( const Key& k, Args&&... args )
+{
+    return this->PushEntry( Entry( k, std::forward< Args >( args )... ));
+}
+
+#endif // CARAMEL_HAS_VARIADIC_TEMPLATES
+
+
+template< typename Key, typename Value, typename KeyCompare >
+inline Bool MutablePriorityQueue< Key, Value, KeyCompare >::TryPop( Value& value )
+{
+    if ( this->IsEmpty() ) { return false; }
+
+    auto ulock = UniqueLock( m_queueMutex );
+
+    if ( m_queue.empty() ) { return false; }
+
+    this->PopTop( value );
+    m_size = static_cast< Uint >( m_queue.size() );
+
+    return true;
+}
+
+
+template< typename Key, typename Value, typename KeyCompare >
+inline Uint MutablePriorityQueue< Key, Value, KeyCompare >::PopAllUntil( const Key& key, std::vector< Value >& values )
+{
+    if ( this->IsEmpty() ) { return 0; }
+
+    auto ulock = UniqueLock( m_queueMutex );
+
+    KeyCompare compare;
+    Uint count = 0;
+
+    while ( ! m_queue.empty() && ! compare( m_queue.top().key, key ))
+    {
+        values.push_back( Value() );
+        this->PopTop( values.back() );
+        ++ count;
+    }
+
+    m_size = static_cast< Uint >( m_queue.size() );
+
+    return count;
+}
+
+
+template< typename Key, typename Value, typename KeyCompare >
+inline Bool MutablePriorityQueue< Key, Value, KeyCompare >::Erase( Handle handle )
+{
+    auto ulock = UniqueLock( m_queueMutex );
+
+    auto iter = m_handles.find( handle );
+    if ( m_handles.end() == iter ) { return false; }
+
+    m_queue.erase( iter->second );
+    m_handles.erase( iter );
+    m_size = static_cast< Uint >( m_queue.size() );
+
+    return true;
+}
+
+
+template< typename Key, typename Value, typename KeyCompare >
+inline Bool MutablePriorityQueue< Key, Value, KeyCompare >::UpdateKey( Handle handle, const Key& k )
+{
+    auto ulock = UniqueLock( m_queueMutex );
+
+    auto iter = m_handles.find( handle );
+    if ( m_handles.end() == iter ) { return false; }
+
+    ( *iter->second ).key = k;
+    m_queue.update( iter->second );
+
+    return true;
+}
+
+
+template< typename Key, typename Value, typename KeyCompare >
+inline Bool MutablePriorityQueue< Key, Value, KeyCompare >::PeekTopKey( Key& key ) const
+{
+    if ( this->IsEmpty() ) { return false; }
+
+    auto ulock = UniqueLock( m_queueMutex );
+
+    if ( m_queue.empty() ) { return false; }
+
+    key = m_queue.top().key;
+
+    return true;
+}
+
+
+template< typename Key, typename Value, typename KeyCompare >
+inline Uint64 MutablePriorityQueue< Key, Value, KeyCompare >::PushEntry( Entry&& entry )
+{
+    auto ulock = UniqueLock( m_queueMutex );
+
+    const Handle handle = ++ m_lastHandle;
+    entry.handle = handle;
+
+    // Without variadic templates the heap has no emplace(), the entry is copied.
+#if defined( CARAMEL_HAS_VARIADIC_TEMPLATES )
+    m_handles.insert( std::make_pair( handle, m_queue.emplace( std::move( entry ))));
+#else
+    m_handles.insert( std::make_pair( handle, m_queue.push( entry )));
+#endif
+    m_size = static_cast< Uint >( m_queue.size() );
+
+    return handle;
+}
+
+
+template< typename Key, typename Value, typename KeyCompare >
+inline void MutablePriorityQueue< Key, Value, KeyCompare >::PopTop( Value& value )
+{
+    // REMARKS: At this point, the m_queueMutex should have been locked.
+
+    // The heap orders only by keys, therefore it is safe to move the value
+    // out of the top entry, right before it is popped.
+    Entry& top = const_cast< Entry& >( m_queue.top() );
+
+    value = std::move( top.value );
+    m_handles.erase( top.handle );
+    m_queue.pop();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Concurrent
+
+} // namespace Caramel
+
+#endif // __CARAMEL_CONCURRENT_MUTABLE_PRIORITY_QUEUE_H
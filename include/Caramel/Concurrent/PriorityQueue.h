@@ -5,10 +5,14 @@
 #pragma once
 
 #include <Caramel/Caramel.h>
+#include <Caramel/Thread/LockContention.h>
 #include <Caramel/Thread/MutexLocks.h>
 #include <boost/heap/priority_queue.hpp>
 #include <boost/noncopyable.hpp>
+#include <atomic>
 #include <functional>
+#include <utility>
+#include <vector>
 
 
 namespace Caramel
@@ -27,28 +31,53 @@ namespace Concurrent
 //
 //   If you want the SMALLEST key popped first, use std::greater.   
 //
+//   If you need to erase or update a pushed entry, use MutablePriorityQueue.
+//
 
 template< typename Key, typename Value, typename KeyCompare = std::less< Key > >
 class PriorityQueue : public boost::noncopyable
 {
 public:
 
+    PriorityQueue();
+
+
     /// Operations ///
 
     void Push( const Key& k, const Value& v );
+    void Push( const Key& k, Value&& v );
 
+    // Construct the value in place.
+    // - Only if CARAMEL_HAS_VARIADIC_TEMPLATES is defined.
+#if defined( CARAMEL_HAS_VARIADIC_TEMPLATES )
+    template< typename... Args >
+    void Emplace( const Key& k, Args&&... args );
+#endif
+
+    // The value is moved out.
     Bool TryPop( Value& v );
 
+    //
+    // Pop all entries which are not lower than the key in priority,
+    // and append them into values, in the order of popping.
+    // - Takes the lock only once. Returns the number of popped entries.
+    //
+    Uint PopAllUntil( const Key& key, std::vector< Value >& values );
+
 
     /// Thread-safe Properties ///
 
     // Returns false if the queue is empty.
     Bool PeekTopKey( Key& key ) const;
 
+    Bool IsEmpty() const { return 0 == m_size; }
+    Uint Size()    const { return m_size; }
+
 
-    /// Not Thread-safe Properties ///
+    /// Instrumentation ///
 
-    Bool IsEmpty() const { return m_queue.empty(); }
+    // Name the lock in the contention report, see Thread/LockContention.h
+    void SetContentionName( const std::string& name ) { m_queueMutex.SetName( name ); }
 
 
 private:
@@ -62,6 +91,12 @@ private:
 
         Entry() {}
         Entry( const Key& k, const Value& v ) : key( k ), value( v ) {}
+        Entry( const Key& k, Value&& v ) : key( k ), value( std::move( v )) {}
+
+#if defined( CARAMEL_HAS_VARIADIC_TEMPLATES )
+        template< typename... Args >
+        explicit Entry( const Key& k, Args&&... args ) : key( k ), value( std::forward< Args >( args )... ) {}
+#endif
     };
 
     struct EntryCompare
@@ -72,13 +107,24 @@ private:
     };
 
 
+    /// Internal Functions ///
+
+    //
+    // The heap orders only by keys, therefore it is safe to move the value
+    // out of the top entry, right before it is popped.
+    //
+    Value&& MoveTopValue() { return std::move( const_cast< Entry& >( m_queue.top() ).value ); }
+
+
     /// Data Members ///
 
     typedef boost::heap::priority_queue<
         Entry, boost::heap::compare< EntryCompare > > QueueType;
     QueueType m_queue;
 
-    mutable std::mutex m_queueMutex;
+    std::atomic< Uint > m_size;
+
+    mutable TrackedMutex m_queueMutex;
 };
 
 
@@ -87,35 +133,97 @@ private:
 // Implementation
 //
 
+template< typename Key, typename Value, typename KeyCompare >
+inline PriorityQueue< Key, Value, KeyCompare >::PriorityQueue()
+    : m_size( 0 )
+{
+}
+
+
 template< typename Key, typename Value, typename KeyCompare >
 inline void PriorityQueue< Key, Value, KeyCompare >::Push( const Key& k, const Value& v )
 {
     auto ulock = UniqueLock( m_queueMutex );
 
     m_queue.push( Entry( k, v ));
+    m_size = static_cast< Uint >( m_queue.size() );
+}
+
+
+template< typename Key, typename Value, typename KeyCompare >
+inline void PriorityQueue< Key, Value, KeyCompare >::Push( const Key& k, Value&& v )
+{
+    auto ulock = UniqueLock( m_queueMutex );
+
+    // Without variadic templates the heap has no emplace(), the entry is copied.
+#if defined( CARAMEL_HAS_VARIADIC_TEMPLATES )
+    m_queue.emplace( k, std::move( v ));
+#else
+    m_queue.push( Entry( k, std::move( v )));
+#endif
+    m_size = static_cast< Uint >( m_queue.size() );
 }
 
 
+#if defined( CARAMEL_HAS_VARIADIC_TEMPLATES )
+
+template< typename Key, typename Value, typename KeyCompare >
+template< typename... Args >
+inline void PriorityQueue< Key, Value, KeyCompare >::Emplace( const Key& k, Args&&... args )
+{
+    auto ulock = UniqueLock( m_queueMutex );
+
+    m_queue.emplace( k, std::forward< Args >( args )... );
+    m_size = static_cast< Uint >( m_queue.size() );
+}
+
+#endif // CARAMEL_HAS_VARIADIC_TEMPLATES
+
+
 template< typename Key, typename Value, typename KeyCompare >
 inline Bool PriorityQueue< Key, Value, KeyCompare >::TryPop( Value& value )
 {
-    if ( m_queue.empty() ) { return false; }
+    if ( this->IsEmpty() ) { return false; }
 
     auto ulock = UniqueLock( m_queueMutex );
 
     if ( m_queue.empty() ) { return false; }
 
-    value = m_queue.top().value;
+    value = this->MoveTopValue();
     m_queue.pop();
+    m_size = static_cast< Uint >( m_queue.size() );
 
     return true;
 }
 
 
+template< typename Key, typename Value, typename KeyCompare >
+inline Uint PriorityQueue< Key, Value, KeyCompare >::PopAllUntil( const Key& key, std::vector< Value >& values )
+{
+    if ( this->IsEmpty() ) { return 0; }
+
+    auto ulock = UniqueLock( m_queueMutex );
+
+    KeyCompare compare;
+    Uint count = 0;
+
+    while ( ! m_queue.empty() && ! compare( m_queue.top().key, key ))
+    {
+        values.push_back( this->MoveTopValue() );
+        m_queue.pop();
+        ++ count;
+    }
+
+    m_size = static_cast< Uint >( m_queue.size() );
+
+    return count;
+}
+
+
 template< typename Key, typename Value, typename KeyCompare >
 inline Bool PriorityQueue< Key, Value, KeyCompare >::PeekTopKey( Key& key ) const
 {
-    if ( m_queue.empty() ) { return false; }
+    if ( this->IsEmpty() ) { return false; }
 
     auto ulock = UniqueLock( m_queueMutex );
 
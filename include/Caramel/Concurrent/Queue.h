@@ -5,9 +5,11 @@
 #pragma once
 
 #include <Caramel/Caramel.h>
+#include <Caramel/Thread/LockContention.h>
 #include <Caramel/Thread/MutexLocks.h>
 #include <boost/noncopyable.hpp>
 #include <deque>
+#include <utility>
 
 
 namespace Caramel
@@ -29,7 +31,16 @@ public:
     /// Operations ///
 
     void Push( const T& x );
+    void Push( T&& x );
 
+    // Construct the element in place.
+    // - Only if CARAMEL_HAS_VARIADIC_TEMPLATES is defined.
+#if defined( CARAMEL_HAS_VARIADIC_TEMPLATES )
+    template< typename... Args >
+    void Emplace( Args&&... args );
+#endif
+
+    // The element is moved out.
     Bool TryPop( T& x );
 
 
@@ -38,12 +49,18 @@ public:
     Bool IsEmpty() const { return m_queue.empty(); }
 
 
+    /// Instrumentation ///
+
+    // Name the lock in the contention report, see Thread/LockContention.h
+    void SetContentionName( const std::string& name ) { m_queueMutex.SetName( name ); }
+
+
 private:
 
     typedef std::deque< T > QueueType;
     QueueType m_queue;
 
-    std::mutex m_queueMutex;
+    TrackedMutex m_queueMutex;
 };
 
 
@@ -60,6 +77,29 @@ inline void Queue< T >::Push( const T& x )
 }
 
 
+template< typename T >
+inline void Queue< T >::Push( T&& x )
+{
+    auto ulock = UniqueLock( m_queueMutex );
+
+    m_queue.push_back( std::move( x ));
+}
+
+
+#if defined( CARAMEL_HAS_VARIADIC_TEMPLATES )
+
+template< typename T >
+template< typename... Args >
+inline void Queue< T >::Emplace( Args&&... args )
+{
+    auto ulock = UniqueLock( m_queueMutex );
+
+    m_queue.emplace_back( std::forward< Args >( args )... );
+}
+
+#endif // CARAMEL_HAS_VARIADIC_TEMPLATES
+
+
 template< typename T >
 inline Bool Queue< T >::TryPop( T& x )
 {
@@ -69,7 +109,7 @@ inline Bool Queue< T >::TryPop( T& x )
 
     if ( m_queue.empty() ) { return false; }
 
-    x = m_queue.front();
+    x = std::move( m_queue.front() );
     m_queue.pop_front();
 
     return true;
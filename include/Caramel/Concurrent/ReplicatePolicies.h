@@ -5,6 +5,9 @@
 #pragma once
 
 #include <Caramel/Caramel.h>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
 
 
 namespace Caramel
@@ -13,6 +16,18 @@ namespace Caramel
 namespace Concurrent
 {
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Replicate Policies
+// - A concurrent map derives from the Dictionary of its policy, and calls
+//   Insert() / Erase() after each modification, with the map locked.
+//   MapT is the container type of the replica. A map built on a standard
+//   container passes it, so the replica keeps its order and key requirements.
+//
+//   A modifier touching several keys brackets the calls with BeginBatch() and
+//   CommitBatch(), then the replica is updated once for the whole batch.
+//
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // Replicate Nothing
@@ -20,10 +35,13 @@ namespace Concurrent
 
 struct ReplicateNothing
 {
-    template< typename Key, typename Value >
+    template< typename Key, typename Value, typename MapT = std::unordered_map< Key, Value > >
     class Dictionary
     {
     public:
+        void BeginBatch() {}
+        void CommitBatch() {}
+
         void Insert( const Key&, const Value& ) {}
         void Erase( const Key& ) {}
     };
@@ -31,17 +49,216 @@ struct ReplicateNothing
 };
 
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Dictionary Snapshot
+// - An immutable copy of a concurrent map at some moment.
+//   Since it is never modified, it can be read or iterated by any thread
+//   without locks. It shares the data with other snapshots of the same version.
+//   It has the container type of the replicated map, e.g. a snapshot of
+//   Concurrent::Map iterates in key order.
+//
+
+template< typename Key, typename Value, typename MapT = std::unordered_map< Key, Value > >
+class DictionarySnapshot
+{
+public:
+
+    typedef MapT MapType;
+
+    explicit DictionarySnapshot( std::shared_ptr< const MapType > map );
+
+
+    /// Properties ///
+
+    Bool IsEmpty() const { return m_map->empty(); }
+    Uint Size()    const { return static_cast< Uint >( m_map->size() ); }
+
+
+    /// Accessors ///
+
+    Bool Contains( const Key& k ) const;
+    Bool Find( const Key& k, Value& v ) const;
+
+
+    /// Iterators ///
+
+    typedef typename MapType::const_iterator ConstIterator;
+
+    ConstIterator Begin() const { return m_map->begin(); }
+    ConstIterator End()   const { return m_map->end(); }
+
+
+    /// STL Compatible ///
+
+    typedef typename MapType::const_iterator const_iterator;
+
+    const_iterator begin() const { return this->Begin(); }
+    const_iterator end()   const { return this->End(); }
+
+
+private:
+
+    std::shared_ptr< const MapType > m_map;
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // Replicate Snapshot
+// - Every modification of the map publishes a new snapshot, by copying the
+//   previous one and swapping the shared pointer atomically.
+//   GetSnapshot() is only an atomic pointer load, the m_mapMutex is not taken.
+//
+//   Fit for lookup tables which are read frequently but seldom written,
+//   because each modifier costs a full copy.
+//   In a batch, the copy is made at the first change and published at commit.
 //
 
 struct ReplicateSnapshot
 {
-    // TODO: Implements DictionarySnapshot and CollectionSnapshot
+    template< typename Key, typename Value, typename MapT = std::unordered_map< Key, Value > >
+    class Dictionary
+    {
+    public:
+
+        typedef DictionarySnapshot< Key, Value, MapT > SnapshotType;
+
+        Dictionary();
+
+        SnapshotType GetSnapshot() const;
+
+    protected:
+
+        // Called by the concurrent map, which has serialized modifiers.
+        void BeginBatch();
+        void CommitBatch();
+
+        void Insert( const Key& k, const Value& v );
+        void Erase( const Key& k );
+
+    private:
+
+        typedef typename SnapshotType::MapType MapType;
+
+        // Copy the latest version at the first change.
+        MapType& Pending();
+
+        std::shared_ptr< const MapType > m_snapshot;
+
+        // Not yet published changes.
+        std::shared_ptr< MapType > m_pending;
+        Bool m_inBatch;
+    };
+
+    // TODO: Implements CollectionSnapshot
 };
 
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+//
+// Dictionary Snapshot
+//
+
+template< typename Key, typename Value, typename MapT >
+inline DictionarySnapshot< Key, Value, MapT >::DictionarySnapshot( std::shared_ptr< const MapType > map )
+    : m_map( std::move( map ))
+{
+}
+
+
+template< typename Key, typename Value, typename MapT >
+inline Bool DictionarySnapshot< Key, Value, MapT >::Contains( const Key& k ) const
+{
+    return m_map->end() != m_map->find( k );
+}
+
+
+template< typename Key, typename Value, typename MapT >
+inline Bool DictionarySnapshot< Key, Value, MapT >::Find( const Key& k, Value& v ) const
+{
+    auto iter = m_map->find( k );
+    if ( m_map->end() == iter ) { return false; }
+    v = iter->second;
+    return true;
+}
+
+
+//
+// Replicate Snapshot
+//
+
+template< typename Key, typename Value, typename MapT >
+inline ReplicateSnapshot::Dictionary< Key, Value, MapT >::Dictionary()
+    : m_snapshot( std::make_shared< MapType >() )
+    , m_inBatch( false )
+{
+}
+
+
+template< typename Key, typename Value, typename MapT >
+inline DictionarySnapshot< Key, Value, MapT > ReplicateSnapshot::Dictionary< Key, Value, MapT >::GetSnapshot() const
+{
+    return SnapshotType( std::atomic_load( &m_snapshot ));
+}
+
+
+template< typename Key, typename Value, typename MapT >
+inline void ReplicateSnapshot::Dictionary< Key, Value, MapT >::BeginBatch()
+{
+    m_inBatch = true;
+}
+
+
+template< typename Key, typename Value, typename MapT >
+inline void ReplicateSnapshot::Dictionary< Key, Value, MapT >::CommitBatch()
+{
+    m_inBatch = false;
+
+    if ( ! m_pending ) { return; }
+
+    std::shared_ptr< const MapType > map = std::move( m_pending );
+    std::atomic_store( &m_snapshot, std::move( map ));
+}
+
+
+template< typename Key, typename Value, typename MapT >
+inline void ReplicateSnapshot::Dictionary< Key, Value, MapT >::Insert( const Key& k, const Value& v )
+{
+    this->Pending()[ k ] = v;
+
+    if ( ! m_inBatch ) { this->CommitBatch(); }
+}
+
+
+template< typename Key, typename Value, typename MapT >
+inline void ReplicateSnapshot::Dictionary< Key, Value, MapT >::Erase( const Key& k )
+{
+    const MapType& latest = m_pending ? *m_pending : *m_snapshot;
+    if ( latest.end() == latest.find( k )) { return; }
+
+    this->Pending().erase( k );
+
+    if ( ! m_inBatch ) { this->CommitBatch(); }
+}
+
+
+template< typename Key, typename Value, typename MapT >
+inline auto ReplicateSnapshot::Dictionary< Key, Value, MapT >::Pending() -> MapType&
+{
+    if ( ! m_pending )
+    {
+        m_pending = std::make_shared< MapType >( *m_snapshot );
+    }
+
+    return *m_pending;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 
 } // namespace Concurrent
@@ -0,0 +1,308 @@
+// Caramel C++ Library - Concurrent Amenity - SPSC Queue Header
+
+#ifndef __CARAMEL_CONCURRENT_SPSC_QUEUE_H
+#define __CARAMEL_CONCURRENT_SPSC_QUEUE_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Error/Assert.h>
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace Caramel
+{
+
+namespace Concurrent
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Concurrent SPSC Queue
+// - A wait-free single-producer / single-consumer ring buffer.
+//
+//   Exactly one thread may push, and exactly one thread may pop.
+//   Each side owns its index on its own cache line, and keeps a cached copy
+//   of the other side's index. The other side's cache line is only touched
+//   when the cached copy says the ring looks full ( or empty ).
+//
+//   The capacity must be a power of 2.
+//
+// USAGE:
+//   TryPush() and TryPop() are wait-free. Push() would yield until a slot is
+//   available, as Concurrent::BoundedQueue does.
+//   TryPushMany() and TryPopMany() publish their index only once per batch.
+//
+
+template< typename T >
+class SpscQueue : public boost::noncopyable
+{
+public:
+
+    explicit SpscQueue( Uint capacity );
+
+
+    /// Producer Operations ///
+
+    void Push( const T& x );
+    void Push( T&& x );
+
+    // Returns false if the queue is full, and x is left untouched.
+    Bool TryPush( const T& x );
+    Bool TryPush( T&& x );
+
+    //
+    // Push elements in [first, last) until the queue is full.
+    // Returns the number of pushed elements.
+    // - Wrap the iterators by std::make_move_iterator() to move them in.
+    //
+    template< typename InputIterator >
+    Uint TryPushMany( InputIterator first, InputIterator last );
+
+
+    /// Consumer Operations ///
+
+    // The element is moved out.
+    Bool TryPop( T& x );
+
+    //
+    // Pop at most maxCount elements, and move them into the output iterator.
+    // Returns the number of popped elements.
+    //
+    template< typename OutputIterator >
+    Uint TryPopMany( OutputIterator output, Uint maxCount );
+
+
+    /// Properties ///
+
+    Uint GetCapacity() const { return static_cast< Uint >( m_slots.size() ); }
+
+
+    /// Not Thread-safe Properties ///
+
+    Bool IsEmpty() const { return 0 == this->Size(); }
+    Uint Size()    const;
+
+
+private:
+
+    /// Internal Functions ///
+
+    // Returns false if the queue is full.
+    Bool AcquirePushSlot( std::size_t& tail );
+
+
+    /// Data Members ///
+    //
+    // The slots are read-only after construction.
+    // Each side's index and cache are kept on their own cache line.
+    //
+
+    static const Uint CACHE_LINE_SIZE = 64;  // Common CPU cache line length.
+
+    typedef Byte CacheLinePad[ CACHE_LINE_SIZE ];
+
+    CacheLinePad m_pad0;
+    std::vector< T > m_slots;
+    std::size_t m_indexMask;
+
+    // Producer
+    CacheLinePad m_pad1;
+    std::atomic< std::size_t > m_tail;
+    std::size_t m_cachedHead;
+
+    // Consumer
+    CacheLinePad m_pad2;
+    std::atomic< std::size_t > m_head;
+    std::size_t m_cachedTail;
+
+    CacheLinePad m_pad3;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+template< typename T >
+inline SpscQueue< T >::SpscQueue( Uint capacity )
+    : m_slots( capacity )
+    , m_indexMask( capacity - 1 )
+    , m_tail( 0 )
+    , m_cachedHead( 0 )
+    , m_head( 0 )
+    , m_cachedTail( 0 )
+{
+    CARAMEL_ASSERT( 0 < capacity && 0 == ( capacity & ( capacity - 1 )));
+}
+
+
+//
+// Producer Operations
+//
+
+template< typename T >
+inline void SpscQueue< T >::Push( const T& x )
+{
+    while ( ! this->TryPush( x ))
+    {
+        std::this_thread::yield();
+    }
+}
+
+
+template< typename T >
+inline void SpscQueue< T >::Push( T&& x )
+{
+    while ( ! this->TryPush( std::move( x )))
+    {
+        std::this_thread::yield();
+    }
+}
+
+
+template< typename T >
+inline Bool SpscQueue< T >::TryPush( const T& x )
+{
+    std::size_t tail = 0;
+    if ( ! this->AcquirePushSlot( tail )) { return false; }
+
+    m_slots[ tail & m_indexMask ] = x;
+    m_tail.store( tail + 1, std::memory_order_release );
+
+    return true;
+}
+
+
+template< typename T >
+inline Bool SpscQueue< T >::TryPush( T&& x )
+{
+    std::size_t tail = 0;
+    if ( ! this->AcquirePushSlot( tail )) { return false; }
+
+    m_slots[ tail & m_indexMask ] = std::move( x );
+    m_tail.store( tail + 1, std::memory_order_release );
+
+    return true;
+}
+
+
+template< typename T >
+template< typename InputIterator >
+inline Uint SpscQueue< T >::TryPushMany( InputIterator first, InputIterator last )
+{
+    const std::size_t capacity = m_slots.size();
+    const std::size_t begin = m_tail.load( std::memory_order_relaxed );
+
+    std::size_t tail = begin;
+
+    for ( ; first != last; ++ first, ++ tail )
+    {
+        if ( tail - m_cachedHead == capacity )
+        {
+            m_cachedHead = m_head.load( std::memory_order_acquire );
+            if ( tail - m_cachedHead == capacity ) { break; }  // Full
+        }
+
+        m_slots[ tail & m_indexMask ] = *first;
+    }
+
+    if ( tail != begin )
+    {
+        m_tail.store( tail, std::memory_order_release );
+    }
+
+    return static_cast< Uint >( tail - begin );
+}
+
+
+template< typename T >
+inline Bool SpscQueue< T >::AcquirePushSlot( std::size_t& tail )
+{
+    tail = m_tail.load( std::memory_order_relaxed );
+
+    if ( tail - m_cachedHead == m_slots.size() )
+    {
+        m_cachedHead = m_head.load( std::memory_order_acquire );
+        if ( tail - m_cachedHead == m_slots.size() ) { return false; }  // Full
+    }
+
+    return true;
+}
+
+
+//
+// Consumer Operations
+//
+
+template< typename T >
+inline Bool SpscQueue< T >::TryPop( T& x )
+{
+    const std::size_t head = m_head.load( std::memory_order_relaxed );
+
+    if ( head == m_cachedTail )
+    {
+        m_cachedTail = m_tail.load( std::memory_order_acquire );
+        if ( head == m_cachedTail ) { return false; }  // Empty
+    }
+
+    x = std::move( m_slots[ head & m_indexMask ] );
+    m_head.store( head + 1, std::memory_order_release );
+
+    return true;
+}
+
+
+template< typename T >
+template< typename OutputIterator >
+inline Uint SpscQueue< T >::TryPopMany( OutputIterator output, Uint maxCount )
+{
+    const std::size_t head = m_head.load( std::memory_order_relaxed );
+
+    if ( m_cachedTail - head < maxCount )
+    {
+        m_cachedTail = m_tail.load( std::memory_order_acquire );
+    }
+
+    std::size_t count = m_cachedTail - head;
+    if ( count > maxCount ) { count = maxCount; }
+
+    for ( std::size_t i = 0; i < count; ++ i )
+    {
+        *output = std::move( m_slots[( head + i ) & m_indexMask ] );
+        ++ output;
+    }
+
+    if ( 0 < count )
+    {
+        m_head.store( head + count, std::memory_order_release );
+    }
+
+    return static_cast< Uint >( count );
+}
+
+
+//
+// Properties
+//
+
+template< typename T >
+inline Uint SpscQueue< T >::Size() const
+{
+    const std::size_t head = m_head.load( std::memory_order_relaxed );
+    const std::size_t tail = m_tail.load( std::memory_order_relaxed );
+    return static_cast< Uint >( tail - head );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Concurrent
+
+} // namespace Caramel
+
+#endif // __CARAMEL_CONCURRENT_SPSC_QUEUE_H
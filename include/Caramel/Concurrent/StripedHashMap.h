@@ -0,0 +1,329 @@
+// Caramel C++ Library - Concurrent Amenity - Striped Hash Map Header
+
+#ifndef __CARAMEL_CONCURRENT_STRIPED_HASH_MAP_H
+#define __CARAMEL_CONCURRENT_STRIPED_HASH_MAP_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Concurrent/ReplicatePolicies.h>
+#include <Caramel/Thread/LockContention.h>
+#include <Caramel/Thread/MutexLocks.h>
+#include <boost/noncopyable.hpp>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+
+namespace Caramel
+{
+
+namespace Concurrent
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Concurrent Striped Hash Map
+// - Keys are hashed into independent shards, each has its own mutex and
+//   std::unordered_map. Threads accessing different shards never block
+//   each other, so read-heavy lookups scale with the number of cores.
+//
+//   The Shards must be a power of 2.
+//
+//   The Replicator hooks are called in a separated lock, therefore they are
+//   still serialized as in Detail::BasicMap. Only modifiers pay for it.
+//
+// NOTE: The ( Key, Value ) naming convention is belong to .NET Framework,
+//       not STL/Boost style.
+//
+
+template< typename Key, typename Value, Uint Shards = 16, typename ReplicatePolicy = ReplicateNothing >
+class StripedHashMap : public ReplicatePolicy::template Dictionary< Key, Value >
+                     , public boost::noncopyable
+{
+    static_assert( 1 <= Shards && 0 == ( Shards & ( Shards - 1 )),
+                   "Shards of StripedHashMap must be a power of 2" );
+
+public:
+
+    typedef Key   KeyType;
+    typedef Value ValueType;
+
+    typedef typename ReplicatePolicy::template Dictionary< Key, Value > Replicator;
+
+
+    /// Not Thread-safe Properties ///
+
+    Bool IsEmpty() const;
+    Uint Size()    const;
+
+
+    /// Accessors ///
+
+    Bool Contains( const Key& k ) const;
+    Bool Find( const Key& k, Value& v ) const;
+
+    //
+    // Call f( key, value ) on each entry, locking one shard at a time.
+    // - Don't access this map in f, otherwise it would deadlock.
+    //
+    template< typename Function >
+    void ForEach( Function f ) const;
+
+
+    /// Modifiers ///
+
+    Bool Insert( const Key& k, const Value& v );
+
+    // Same as Detail::BasicMap
+    Bool Upsert( const Key& k, const Value& v );
+
+    template< typename Factory >
+    Value ComputeIfAbsent( const Key& k, Factory factory );
+
+    Bool Erase( const Key& k );
+
+
+    /// Instrumentation ///
+
+    // Name the lock in the contention report, see Thread/LockContention.h
+    void SetContentionName( const std::string& name );
+
+
+private:
+
+    /// Internal Types ///
+
+    static const Uint CACHE_LINE_SIZE = 64;  // Common CPU cache line length.
+
+    typedef std::unordered_map< Key, Value > MapType;
+
+    struct Shard
+    {
+        MapType map;
+        mutable TrackedMutex mutex;
+
+        // Keep each shard's mutex away from its neighbours' cache line.
+        Byte pad[ CACHE_LINE_SIZE ];
+    };
+
+
+    /// Internal Functions ///
+
+    const Shard& GetShard( const Key& k ) const;
+    Shard&       GetShard( const Key& k );
+
+
+    /// Data Members ///
+
+    Shard m_shards[ Shards ];
+
+    std::mutex m_replicateMutex;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+//
+// Properties
+//
+
+template< typename Key, typename Value, Uint Shards, typename ReplicateP >
+inline Bool StripedHashMap< Key, Value, Shards, ReplicateP >::IsEmpty() const
+{
+    for ( Uint i = 0; i < Shards; ++ i )
+    {
+        if ( ! m_shards[i].map.empty() ) { return false; }
+    }
+    return true;
+}
+
+
+template< typename Key, typename Value, Uint Shards, typename ReplicateP >
+inline Uint StripedHashMap< Key, Value, Shards, ReplicateP >::Size() const
+{
+    std::size_t size = 0;
+    for ( Uint i = 0; i < Shards; ++ i )
+    {
+        size += m_shards[i].map.size();
+    }
+    return static_cast< Uint >( size );
+}
+
+
+//
+// Accessors
+//
+
+template< typename Key, typename Value, Uint Shards, typename ReplicateP >
+inline Bool StripedHashMap< Key, Value, Shards, ReplicateP >::Contains( const Key& k ) const
+{
+    const Shard& shard = this->GetShard( k );
+
+    auto ulock = UniqueLock( shard.mutex );
+    return shard.map.end() != shard.map.find( k );
+}
+
+
+template< typename Key, typename Value, Uint Shards, typename ReplicateP >
+inline Bool StripedHashMap< Key, Value, Shards, ReplicateP >::Find( const Key& k, Value& v ) const
+{
+    const Shard& shard = this->GetShard( k );
+
+    auto ulock = UniqueLock( shard.mutex );
+
+    auto iter = shard.map.find( k );
+    if ( shard.map.end() == iter ) { return false; }
+    v = iter->second;
+    return true;
+}
+
+
+template< typename Key, typename Value, Uint Shards, typename ReplicateP >
+template< typename Function >
+inline void StripedHashMap< Key, Value, Shards, ReplicateP >::ForEach( Function f ) const
+{
+    for ( Uint i = 0; i < Shards; ++ i )
+    {
+        const Shard& shard = m_shards[i];
+
+        auto ulock = UniqueLock( shard.mutex );
+
+        for ( auto iter = shard.map.begin(); shard.map.end() != iter; ++ iter )
+        {
+            f( iter->first, iter->second );
+        }
+    }
+}
+
+
+//
+// Modifiers
+//
+
+template< typename Key, typename Value, Uint Shards, typename ReplicateP >
+inline Bool StripedHashMap< Key, Value, Shards, ReplicateP >::Insert( const Key& k, const Value& v )
+{
+    Shard& shard = this->GetShard( k );
+
+    auto ulock = UniqueLock( shard.mutex );
+
+    const Bool inserted = shard.map.insert( std::make_pair( k, v )).second;
+
+    if ( inserted )
+    {
+        // Lock order : shard -> replicate.
+        auto rlock = UniqueLock( m_replicateMutex );
+        this->Replicator::Insert( k, v );
+    }
+
+    return inserted;
+}
+
+
+template< typename Key, typename Value, Uint Shards, typename ReplicateP >
+inline Bool StripedHashMap< Key, Value, Shards, ReplicateP >::Upsert( const Key& k, const Value& v )
+{
+    Shard& shard = this->GetShard( k );
+
+    auto ulock = UniqueLock( shard.mutex );
+
+    auto result = shard.map.insert( std::make_pair( k, v ));
+
+    if ( ! result.second )
+    {
+        result.first->second = v;
+    }
+
+    auto rlock = UniqueLock( m_replicateMutex );
+    this->Replicator::Insert( k, v );
+
+    return result.second;
+}
+
+
+template< typename Key, typename Value, Uint Shards, typename ReplicateP >
+template< typename Factory >
+inline Value StripedHashMap< Key, Value, Shards, ReplicateP >::ComputeIfAbsent( const Key& k, Factory factory )
+{
+    Shard& shard = this->GetShard( k );
+
+    auto ulock = UniqueLock( shard.mutex );
+
+    auto iter = shard.map.find( k );
+    if ( shard.map.end() != iter ) { return iter->second; }
+
+    iter = shard.map.insert( std::make_pair( k, factory() )).first;
+
+    auto rlock = UniqueLock( m_replicateMutex );
+    this->Replicator::Insert( k, iter->second );
+
+    return iter->second;
+}
+
+
+template< typename Key, typename Value, Uint Shards, typename ReplicateP >
+inline Bool StripedHashMap< Key, Value, Shards, ReplicateP >::Erase( const Key& k )
+{
+    Shard& shard = this->GetShard( k );
+
+    auto ulock = UniqueLock( shard.mutex );
+
+    const Bool erased = 0 < shard.map.erase( k );
+
+    if ( erased )
+    {
+        auto rlock = UniqueLock( m_replicateMutex );
+        this->Replicator::Erase( k );
+    }
+
+    return erased;
+}
+
+
+//
+// Instrumentation
+//
+
+template< typename Key, typename Value, Uint Shards, typename ReplicateP >
+inline void StripedHashMap< Key, Value, Shards, ReplicateP >::SetContentionName( const std::string& name )
+{
+    // All shards are reported as a whole.
+    for ( Uint i = 0; i < Shards; ++ i )
+    {
+        m_shards[i].mutex.SetName( name );
+    }
+}
+
+
+//
+// Shard Selection
+// - std::unordered_map would use the low bits of the same hash for its buckets,
+//   therefore we mix the high bits in to choose a shard.
+//
+
+template< typename Key, typename Value, Uint Shards, typename ReplicateP >
+inline auto StripedHashMap< Key, Value, Shards, ReplicateP >::GetShard( const Key& k ) const -> const Shard&
+{
+    std::size_t hash = std::hash< Key >()( k );
+    hash ^= ( hash >> 16 ) ^ ( hash >> 7 );
+    return m_shards[ hash & ( Shards - 1 ) ];
+}
+
+
+template< typename Key, typename Value, Uint Shards, typename ReplicateP >
+inline auto StripedHashMap< Key, Value, Shards, ReplicateP >::GetShard( const Key& k ) -> Shard&
+{
+    return const_cast< Shard& >( static_cast< const StripedHashMap* >( this )->GetShard( k ));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Concurrent
+
+} // namespace Caramel
+
+#endif // __CARAMEL_CONCURRENT_STRIPED_HASH_MAP_H
@@ -0,0 +1,297 @@
+// Caramel C++ Library - Concurrent Amenity - Work Stealing Deque Header
+
+#ifndef __CARAMEL_CONCURRENT_WORK_STEALING_DEQUE_H
+#define __CARAMEL_CONCURRENT_WORK_STEALING_DEQUE_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Error/Assert.h>
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <vector>
+
+
+namespace Caramel
+{
+
+namespace Concurrent
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Concurrent Work Stealing Deque
+// - The Chase-Lev deque, with a growable circular array.
+//   Memory orders follow Le, Pop, Cohen and Zappa Nardelli,
+//   "Correct and Efficient Work-Stealing for Weak Memory Models" (2013).
+//
+//   Only the owner thread can call PushBottom() and PopBottom(),
+//   they work in LIFO order, and are almost free of synchronization.
+//   Any other thread can call Steal(), which takes from the top in FIFO order.
+//
+//   T must be trivially copyable, e.g. a raw pointer or an integer,
+//   because a thief may read a slot which is being overwritten.
+//
+//   The arrays replaced by growing are kept until the deque is destroyed,
+//   since a thief may still be reading them.
+//
+
+template< typename T >
+class WorkStealingDeque : public boost::noncopyable
+{
+public:
+
+    // The initial capacity must be a power of 2.
+    explicit WorkStealingDeque( Uint initialCapacity = 64 );
+    ~WorkStealingDeque();
+
+
+    /// Owner Operations ///
+
+    void PushBottom( T x );
+
+    // Returns false if the deque is empty.
+    Bool PopBottom( T& x );
+
+
+    /// Thief Operations ///
+
+    // Returns false if the deque is empty, or lost the race to another thread.
+    Bool Steal( T& x );
+
+
+    /// Not Thread-safe Properties ///
+
+    Bool IsEmpty() const { return 0 >= this->SignedSize(); }
+    Uint Size()    const;
+
+
+private:
+
+    /// Internal Types ///
+
+    class Array : public boost::noncopyable
+    {
+    public:
+        explicit Array( Int64 capacity );
+        ~Array();
+
+        Int64 Capacity() const { return m_capacity; }
+
+        T    Get( Int64 i ) const { return m_slots[ i & ( m_capacity - 1 )].load( std::memory_order_relaxed ); }
+        void Put( Int64 i, T x )  { m_slots[ i & ( m_capacity - 1 )].store( x, std::memory_order_relaxed ); }
+
+        Array* Grow( Int64 bottom, Int64 top ) const;
+
+    private:
+        Int64 m_capacity;
+        std::atomic< T >* m_slots;
+    };
+
+
+    /// Internal Functions ///
+
+    Int64 SignedSize() const;
+
+
+    /// Data Members ///
+
+    static const Uint CACHE_LINE_SIZE = 64;  // Common CPU cache line length.
+
+    typedef Byte CacheLinePad[ CACHE_LINE_SIZE ];
+
+    std::atomic< Int64 > m_top;
+
+    CacheLinePad m_pad0;
+    std::atomic< Int64 > m_bottom;
+    std::atomic< Array* > m_array;
+
+    CacheLinePad m_pad1;
+    std::vector< Array* > m_retiredArrays;  // Accessed by the owner only.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+//
+// Array
+//
+
+template< typename T >
+inline WorkStealingDeque< T >::Array::Array( Int64 capacity )
+    : m_capacity( capacity )
+    , m_slots( new std::atomic< T >[ static_cast< std::size_t >( capacity ) ] )
+{
+}
+
+
+template< typename T >
+inline WorkStealingDeque< T >::Array::~Array()
+{
+    delete [] m_slots;
+}
+
+
+template< typename T >
+inline auto WorkStealingDeque< T >::Array::Grow( Int64 bottom, Int64 top ) const -> Array*
+{
+    Array* array = new Array( m_capacity * 2 );
+
+    for ( Int64 i = top; i < bottom; ++ i )
+    {
+        array->Put( i, this->Get( i ));
+    }
+
+    return array;
+}
+
+
+//
+// Work Stealing Deque
+//
+
+template< typename T >
+inline WorkStealingDeque< T >::WorkStealingDeque( Uint initialCapacity )
+    : m_top( 0 )
+    , m_bottom( 0 )
+    , m_array( nullptr )
+{
+    CARAMEL_ASSERT( 0 < initialCapacity && 0 == ( initialCapacity & ( initialCapacity - 1 )));
+
+    m_array.store( new Array( initialCapacity ), std::memory_order_relaxed );
+}
+
+
+template< typename T >
+inline WorkStealingDeque< T >::~WorkStealingDeque()
+{
+    delete m_array.load( std::memory_order_relaxed );
+
+    for ( Uint i = 0; i < m_retiredArrays.size(); ++ i )
+    {
+        delete m_retiredArrays[i];
+    }
+}
+
+
+//
+// Owner Operations
+//
+
+template< typename T >
+inline void WorkStealingDeque< T >::PushBottom( T x )
+{
+    const Int64 b = m_bottom.load( std::memory_order_relaxed );
+    const Int64 t = m_top.load( std::memory_order_acquire );
+    Array* a = m_array.load( std::memory_order_relaxed );
+
+    if ( b - t > a->Capacity() - 1 )
+    {
+        // Full, grow the array.
+        m_retiredArrays.push_back( a );
+        a = a->Grow( b, t );
+        m_array.store( a, std::memory_order_release );
+    }
+
+    a->Put( b, x );
+
+    std::atomic_thread_fence( std::memory_order_release );
+    m_bottom.store( b + 1, std::memory_order_relaxed );
+}
+
+
+template< typename T >
+inline Bool WorkStealingDeque< T >::PopBottom( T& x )
+{
+    const Int64 b = m_bottom.load( std::memory_order_relaxed ) - 1;
+    Array* a = m_array.load( std::memory_order_relaxed );
+
+    m_bottom.store( b, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+
+    Int64 t = m_top.load( std::memory_order_relaxed );
+
+    if ( t > b )
+    {
+        // Empty
+        m_bottom.store( b + 1, std::memory_order_relaxed );
+        return false;
+    }
+
+    const T popped = a->Get( b );
+
+    if ( t < b )
+    {
+        x = popped;
+        return true;
+    }
+
+    // The last one, race against thieves.
+
+    const Bool won = m_top.compare_exchange_strong(
+        t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed );
+
+    m_bottom.store( b + 1, std::memory_order_relaxed );
+
+    if ( won ) { x = popped; }
+    return won;
+}
+
+
+//
+// Thief Operations
+//
+
+template< typename T >
+inline Bool WorkStealingDeque< T >::Steal( T& x )
+{
+    Int64 t = m_top.load( std::memory_order_acquire );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    const Int64 b = m_bottom.load( std::memory_order_acquire );
+
+    if ( t >= b ) { return false; }  // Empty
+
+    Array* a = m_array.load( std::memory_order_acquire );
+    const T stolen = a->Get( t );
+
+    if ( ! m_top.compare_exchange_strong(
+            t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed ))
+    {
+        return false;  // Lost the race
+    }
+
+    x = stolen;
+    return true;
+}
+
+
+//
+// Properties
+//
+
+template< typename T >
+inline Int64 WorkStealingDeque< T >::SignedSize() const
+{
+    const Int64 b = m_bottom.load( std::memory_order_relaxed );
+    const Int64 t = m_top.load( std::memory_order_relaxed );
+    return b - t;
+}
+
+
+template< typename T >
+inline Uint WorkStealingDeque< T >::Size() const
+{
+    const Int64 size = this->SignedSize();
+    return 0 < size ? static_cast< Uint >( size ) : 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Concurrent
+
+} // namespace Caramel
+
+#endif // __CARAMEL_CONCURRENT_WORK_STEALING_DEQUE_H
@@ -32,6 +32,10 @@ public:
     
     Bool IsCaught() const { return m_caught; }
 
+    // The caught C++ exception, to rethrow it in another thread.
+    // - Null if nothing or a Windows structured exception is caught.
+    std::exception_ptr GetException() const { return m_exception; }
+
 
 protected: 
     
@@ -52,6 +56,7 @@ protected:
     /// Data Members ///
 
     Bool m_caught;
+    std::exception_ptr m_exception;
 };
 
 
@@ -0,0 +1,336 @@
+// Caramel C++ Library - Object Facility - Pool Header
+
+#ifndef __CARAMEL_OBJECT_POOL_H
+#define __CARAMEL_OBJECT_POOL_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Concurrent/BoundedQueue.h>
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+
+namespace Caramel
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Pool
+// - Recycles objects of T, to avoid the allocator in hot paths.
+//
+//   Objects are cached in two levels :
+//   1. Magazines : A few small stacks of objects, chosen by the thread id.
+//                  A thread claims a magazine by a single atomic exchange,
+//                  and falls back to the depot if another thread holds it.
+//   2. Depot     : A lock-free Concurrent::BoundedQueue shared by all threads.
+//                  Magazines are refilled from, or flushed into it, by halves.
+//
+//   At most DepotCapacity + NUM_MAGAZINES x MAGAZINE_SIZE objects are cached,
+//   the excess ones are deleted when released. Trim() deletes the cached ones.
+//
+//   Objects are reused as they are, they are not reset nor reconstructed.
+//   DepotCapacity must be a power of 2.
+//
+// CAUTION: Objects and handles must be released before the pool is destroyed.
+//
+// NOTE: Sprintf is built on it, don't use Trace or Exception macros here.
+//
+
+template< typename T, Uint DepotCapacity = 256 >
+class Pool : public boost::noncopyable
+{
+public:
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Handle
+    // - Owns an object of the pool, returns it to the pool when destroyed.
+    //
+
+    class Handle
+    {
+        friend class Pool;
+
+    public:
+
+        Handle() : m_pool( nullptr ), m_object( nullptr ) {}
+        Handle( Handle&& other );
+        ~Handle() { this->Reset(); }
+
+        Handle& operator=( Handle&& other );
+
+        T* Get() const { return m_object; }
+
+        T* operator->() const { return m_object; }
+        T& operator*()  const { return *m_object; }
+
+        Bool IsNull() const { return nullptr == m_object; }
+
+        // Return the object to the pool now.
+        void Reset();
+
+    private:
+
+        Handle( Pool* pool, T* object ) : m_pool( pool ), m_object( object ) {}
+
+        Handle( const Handle& );
+        Handle& operator=( const Handle& );
+
+        Pool* m_pool;
+        T*    m_object;
+    };
+
+
+    Pool();
+    ~Pool();
+
+
+    /// Operations ///
+
+    Handle Acquire() { return Handle( this, this->AcquireObject() ); }
+
+    // Raw interface, the object must be released by ReleaseObject().
+    T*   AcquireObject();
+    void ReleaseObject( T* object );
+
+    // Delete the cached objects. Returns the number of deleted ones.
+    // - A magazine held by another thread at the moment is skipped.
+    Uint Trim();
+
+
+    /// Not Thread-safe Properties ///
+
+    Uint CachedCount() const;
+
+
+private:
+
+    /// Internal Types ///
+
+    static const Uint NUM_MAGAZINES = 16;
+    static const Uint MAGAZINE_SIZE = 16;
+
+    static const Uint CACHE_LINE_SIZE = 64;  // Common CPU cache line length.
+
+    struct Magazine
+    {
+        std::atomic< Bool > busy;
+        Uint count;
+        T* objects[ MAGAZINE_SIZE ];
+
+        // Each magazine takes its own cache line.
+        Byte pad[ CACHE_LINE_SIZE ];
+
+        Magazine() : busy( false ), count( 0 ) {}
+
+        Bool TryClaim() { return ! busy.exchange( true, std::memory_order_acquire ); }
+        void Unclaim()  { busy.store( false, std::memory_order_release ); }
+    };
+
+
+    /// Internal Functions ///
+
+    Magazine& GetMagazine();
+
+
+    /// Data Members ///
+
+    Magazine m_magazines[ NUM_MAGAZINES ];
+
+    typedef Concurrent::BoundedQueue< T*, DepotCapacity > Depot;
+    Depot m_depot;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+//
+// Handle
+//
+
+template< typename T, Uint DepotCapacity >
+inline Pool< T, DepotCapacity >::Handle::Handle( Handle&& other )
+    : m_pool( other.m_pool )
+    , m_object( other.m_object )
+{
+    other.m_pool = nullptr;
+    other.m_object = nullptr;
+}
+
+
+template< typename T, Uint DepotCapacity >
+inline auto Pool< T, DepotCapacity >::Handle::operator=( Handle&& other ) -> Handle&
+{
+    if ( this != &other )
+    {
+        this->Reset();
+
+        m_pool = other.m_pool;
+        m_object = other.m_object;
+
+        other.m_pool = nullptr;
+        other.m_object = nullptr;
+    }
+    return *this;
+}
+
+
+template< typename T, Uint DepotCapacity >
+inline void Pool< T, DepotCapacity >::Handle::Reset()
+{
+    if ( ! m_object ) { return; }
+
+    m_pool->ReleaseObject( m_object );
+
+    m_pool = nullptr;
+    m_object = nullptr;
+}
+
+
+//
+// Pool
+//
+
+template< typename T, Uint DepotCapacity >
+inline Pool< T, DepotCapacity >::Pool()
+{
+}
+
+
+template< typename T, Uint DepotCapacity >
+inline Pool< T, DepotCapacity >::~Pool()
+{
+    this->Trim();
+}
+
+
+template< typename T, Uint DepotCapacity >
+inline T* Pool< T, DepotCapacity >::AcquireObject()
+{
+    T* object = nullptr;
+
+    Magazine& magazine = this->GetMagazine();
+
+    if ( magazine.TryClaim() )
+    {
+        if ( 0 == magazine.count )
+        {
+            // Refill half of the magazine from the depot.
+            while ( MAGAZINE_SIZE / 2 > magazine.count
+                 && m_depot.TryPop( magazine.objects[ magazine.count ]))
+            {
+                ++ magazine.count;
+            }
+        }
+
+        if ( 0 < magazine.count )
+        {
+            object = magazine.objects[ -- magazine.count ];
+        }
+
+        magazine.Unclaim();
+    }
+    else
+    {
+        m_depot.TryPop( object );
+    }
+
+    return object ? object : new T;
+}
+
+
+template< typename T, Uint DepotCapacity >
+inline void Pool< T, DepotCapacity >::ReleaseObject( T* object )
+{
+    Magazine& magazine = this->GetMagazine();
+
+    if ( magazine.TryClaim() )
+    {
+        if ( MAGAZINE_SIZE == magazine.count )
+        {
+            // Flush half of the magazine into the depot.
+            while ( MAGAZINE_SIZE / 2 < magazine.count )
+            {
+                T* flushed = magazine.objects[ -- magazine.count ];
+                if ( ! m_depot.TryPush( flushed ))
+                {
+                    delete flushed;
+                }
+            }
+        }
+
+        magazine.objects[ magazine.count ++ ] = object;
+        magazine.Unclaim();
+        return;
+    }
+
+    if ( ! m_depot.TryPush( object ))
+    {
+        delete object;
+    }
+}
+
+
+template< typename T, Uint DepotCapacity >
+inline Uint Pool< T, DepotCapacity >::Trim()
+{
+    Uint count = 0;
+
+    for ( Uint i = 0; i < NUM_MAGAZINES; ++ i )
+    {
+        Magazine& magazine = m_magazines[i];
+
+        if ( ! magazine.TryClaim() ) { continue; }
+
+        while ( 0 < magazine.count )
+        {
+            delete magazine.objects[ -- magazine.count ];
+            ++ count;
+        }
+
+        magazine.Unclaim();
+    }
+
+    T* object = nullptr;
+    while ( m_depot.TryPop( object ))
+    {
+        delete object;
+        ++ count;
+    }
+
+    return count;
+}
+
+
+template< typename T, Uint DepotCapacity >
+inline Uint Pool< T, DepotCapacity >::CachedCount() const
+{
+    Uint count = 0;
+
+    for ( Uint i = 0; i < NUM_MAGAZINES; ++ i )
+    {
+        count += m_magazines[i].count;
+    }
+
+    return count + m_depot.Size();
+}
+
+
+template< typename T, Uint DepotCapacity >
+inline auto Pool< T, DepotCapacity >::GetMagazine() -> Magazine&
+{
+    const std::size_t hash = std::hash< std::thread::id >()( std::this_thread::get_id() );
+    return m_magazines[ ( hash ^ ( hash >> 8 )) & ( NUM_MAGAZINES - 1 ) ];
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_OBJECT_POOL_H
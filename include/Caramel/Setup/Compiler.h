@@ -26,6 +26,13 @@
 #define CARAMEL_CDECL        __cdecl
 #define CARAMEL_DEPRECATED   __declspec( deprecated )
 
+// noexcept since Visual C++ 2015
+#if ( 1900 > _MSC_VER )
+#define CARAMEL_NOEXCEPT     throw()
+#else
+#define CARAMEL_NOEXCEPT     noexcept
+#endif
+
 
 #endif // Visual C++
 
@@ -51,6 +58,7 @@
 #define CARAMEL_STDCALL    __attribute__(( stdcall ))
 #define CARAMEL_CDECL      __attribute__(( cdecl ))
 #define CARAMEL_DEPRECATED
+#define CARAMEL_NOEXCEPT   noexcept
 
 
 #endif // GNU C++
@@ -77,11 +85,29 @@
 #define CARAMEL_STDCALL
 #define CARAMEL_CDECL
 #define CARAMEL_DEPRECATED
+#define CARAMEL_NOEXCEPT   noexcept
 
 
 #endif // Clang
 
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Language Features
+// - Optional features beyond C++11 or the oldest supported compiler,
+//   enabled by the compiler settings.
+//
+
+#if defined( __cpp_impl_coroutine ) && ( 201902L <= __cpp_impl_coroutine )
+#define CARAMEL_HAS_COROUTINES
+#endif
+
+// Variadic templates since Visual C++ 2013
+#if !defined( CARAMEL_COMPILER_IS_MSVC ) || ( 1800 <= _MSC_VER )
+#define CARAMEL_HAS_VARIADIC_TEMPLATES
+#endif
+
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // Setup Validation
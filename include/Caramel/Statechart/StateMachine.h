@@ -7,6 +7,7 @@
 #include <Caramel/Caramel.h>
 #include <Caramel/Chrono/TickClock.h>
 #include <Caramel/Statechart/State.h>
+#include <Caramel/Task/TaskFwd.h>
 
 
 namespace Caramel
@@ -26,7 +27,19 @@ class StateMachine
 {
 public:
 
+    // Use the built-in TaskPoller, call Process() to process events.
     explicit StateMachine( const std::string& name );
+
+    //
+    // Process events by an external executor, e.g. a TaskThreadPool.
+    // - The executor must outlive this machine, and drain its tasks
+    //   before this machine is destroyed.
+    // - The events are processed one at a time through a Strand, so no
+    //   thread of the executor is blocked by a lock. Events posted by one
+    //   thread are processed in that order.
+    //
+    StateMachine( const std::string& name, TaskExecutor& executor );
+
     ~StateMachine();
 
     //
@@ -0,0 +1,347 @@
+// Caramel C++ Library - Task Facility - Async Task Header
+
+#ifndef __CARAMEL_TASK_ASYNC_TASK_H
+#define __CARAMEL_TASK_ASYNC_TASK_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <cstddef>
+
+
+namespace Caramel
+{
+
+namespace Detail
+{
+
+//
+// Coroutine frames are recycled by pools of the Task facility.
+// Defined regardless of the coroutine support, in Task.cpp
+//
+
+void* AllocateAsyncFrame( std::size_t size );
+void  FreeAsyncFrame( void* frame, std::size_t size );
+
+} // namespace Detail
+
+} // namespace Caramel
+
+
+#if defined( CARAMEL_HAS_COROUTINES )
+
+#include <Caramel/Async/WaitableBool.h>
+#include <Caramel/Task/Future.h>
+#include <Caramel/Task/Task.h>
+#include <Caramel/Task/TaskExecutor.h>
+#include <coroutine>
+#include <exception>
+#include <memory>
+
+
+namespace Caramel
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Async Task
+// - A C++20 coroutine which runs on TaskExecutors.
+//   Only available if CARAMEL_HAS_COROUTINES is defined.
+//
+//   It starts at once in the calling thread, and runs until the first
+//   co_await which suspends it. Then it's resumed by the awaited event :
+//
+//   co_await ResumeOn( executor )          : Continue in a task of the executor.
+//   co_await ResumeAfter( executor, ticks ): Continue in a delayed task of the executor.
+//   co_await future                        : Get the value of a Future, or rethrow.
+//   co_await asyncTask                     : Get the result of another AsyncTask.
+//   co_await waitableBool                  : Continue when it becomes true.
+//
+//   Futures, AsyncTasks and WaitableBools resume the coroutine in the thread
+//   which fulfills them. Follow with ResumeOn() to get back to an executor.
+//
+//   The result is delivered by a Future, an exception thrown out of the
+//   coroutine fails the future.
+//
+//   Coroutine frames are pooled, and resuming only submits a Task of
+//   the coroutine handle, so each step costs no allocation.
+//
+// Example:
+//
+//   AsyncTask< Int > LoadAsync( TaskExecutor& io, TaskExecutor& main )
+//   {
+//       co_await ResumeOn( io );
+//       auto size = ReadTheFile();
+//       co_await ResumeOn( main );
+//       co_return size;
+//   }
+//
+
+namespace Detail
+{
+template< typename T > class AsyncPromise;
+template< typename T > class FutureAwaiter;
+} // namespace Detail
+
+
+template< typename T >
+class AsyncTask
+{
+public:
+
+    typedef Detail::AsyncPromise< T > promise_type;
+
+    explicit AsyncTask( std::shared_ptr< Detail::FutureState< T >> state );
+
+
+    /// Properties ///
+
+    Future< T > GetFuture() const { return Future< T >( m_state ); }
+
+    Bool IsReady() const { return m_state->IsReady(); }
+
+
+    /// Awaiter ///
+
+    Detail::FutureAwaiter< T > operator co_await() const;
+
+
+private:
+
+    std::shared_ptr< Detail::FutureState< T >> m_state;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Awaitables
+//
+
+namespace Detail
+{
+
+//
+// Executor Awaiter
+// - Submits the resumption to an executor, delayed if ticks is positive.
+//
+
+class ExecutorAwaiter
+{
+public:
+
+    ExecutorAwaiter( TaskExecutor& executor, const Ticks& delay );
+
+    Bool await_ready() const { return false; }
+    void await_suspend( std::coroutine_handle<> handle );
+    void await_resume() {}
+
+private:
+
+    TaskExecutor* m_executor;
+    Ticks m_delay;
+};
+
+
+//
+// Future Awaiter
+//
+
+template< typename T >
+class FutureAwaiter
+{
+public:
+
+    explicit FutureAwaiter( std::shared_ptr< FutureState< T >> state );
+
+    Bool await_ready() const { return m_state->IsReady(); }
+    void await_suspend( std::coroutine_handle<> handle );
+    typename FutureState< T >::ResultType await_resume() { return m_state->Get(); }
+
+private:
+
+    std::shared_ptr< FutureState< T >> m_state;
+};
+
+
+//
+// Waitable Bool Awaiter
+//
+
+class WaitableBoolAwaiter
+{
+public:
+
+    explicit WaitableBoolAwaiter( WaitableBool& flag ) : m_flag( &flag ) {}
+
+    Bool await_ready() const { return *m_flag; }
+    void await_suspend( std::coroutine_handle<> handle );
+    void await_resume() {}
+
+private:
+
+    WaitableBool* m_flag;
+};
+
+} // namespace Detail
+
+
+inline Detail::ExecutorAwaiter ResumeOn( TaskExecutor& executor )
+{
+    return Detail::ExecutorAwaiter( executor, Ticks::Zero() );
+}
+
+
+inline Detail::ExecutorAwaiter ResumeAfter( TaskExecutor& executor, const Ticks& delay )
+{
+    return Detail::ExecutorAwaiter( executor, delay );
+}
+
+
+template< typename T >
+inline Detail::FutureAwaiter< T > operator co_await( const Future< T >& future )
+{
+    return Detail::FutureAwaiter< T >( future.GetState() );
+}
+
+
+inline Detail::WaitableBoolAwaiter operator co_await( WaitableBool& flag )
+{
+    return Detail::WaitableBoolAwaiter( flag );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Async Promise
+//
+
+namespace Detail
+{
+
+template< typename T >
+class AsyncPromiseBase
+{
+public:
+
+    AsyncPromiseBase() : m_state( std::make_shared< FutureState< T >>() ) {}
+
+    static void* operator new( std::size_t size ) { return AllocateAsyncFrame( size ); }
+    static void  operator delete( void* frame, std::size_t size ) { FreeAsyncFrame( frame, size ); }
+
+    AsyncTask< T > get_return_object() { return AsyncTask< T >( m_state ); }
+
+    // Starts at once, and the frame is destroyed when it ends.
+    std::suspend_never initial_suspend() const { return std::suspend_never(); }
+    std::suspend_never final_suspend() const noexcept { return std::suspend_never(); }
+
+    void unhandled_exception() { m_state->SetException( std::current_exception() ); }
+
+protected:
+
+    std::shared_ptr< FutureState< T >> m_state;
+};
+
+
+template< typename T >
+class AsyncPromise : public AsyncPromiseBase< T >
+{
+public:
+
+    void return_value( T value ) { this->m_state->SetValue( std::move( value )); }
+};
+
+
+template<>
+class AsyncPromise< void > : public AsyncPromiseBase< void >
+{
+public:
+
+    void return_void() { this->m_state->SetValue(); }
+};
+
+} // namespace Detail
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+template< typename T >
+inline AsyncTask< T >::AsyncTask( std::shared_ptr< Detail::FutureState< T >> state )
+    : m_state( std::move( state ))
+{
+}
+
+
+template< typename T >
+inline Detail::FutureAwaiter< T > AsyncTask< T >::operator co_await() const
+{
+    return Detail::FutureAwaiter< T >( m_state );
+}
+
+
+namespace Detail
+{
+
+//
+// Executor Awaiter
+//
+
+inline ExecutorAwaiter::ExecutorAwaiter( TaskExecutor& executor, const Ticks& delay )
+    : m_executor( &executor )
+    , m_delay( delay )
+{
+}
+
+
+inline void ExecutorAwaiter::await_suspend( std::coroutine_handle<> handle )
+{
+    Task task( TaskName::Literal( "AsyncTask.Resume" ), [handle] { handle.resume(); } );
+
+    if ( Ticks::Zero() < m_delay )
+    {
+        task.DelayFor( m_delay );
+    }
+
+    // If it throws, the exception is rethrown in the coroutine.
+    m_executor->Submit( task );
+}
+
+
+//
+// Future Awaiter
+//
+
+template< typename T >
+inline FutureAwaiter< T >::FutureAwaiter( std::shared_ptr< FutureState< T >> state )
+    : m_state( std::move( state ))
+{
+}
+
+
+template< typename T >
+inline void FutureAwaiter< T >::await_suspend( std::coroutine_handle<> handle )
+{
+    // It may be ready already, then resumed right here.
+    m_state->OnReady( [handle] { handle.resume(); } );
+}
+
+
+//
+// Waitable Bool Awaiter
+//
+
+inline void WaitableBoolAwaiter::await_suspend( std::coroutine_handle<> handle )
+{
+    m_flag->OnTrue( [handle] { handle.resume(); } );
+}
+
+} // namespace Detail
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // CARAMEL_HAS_COROUTINES
+
+#endif // __CARAMEL_TASK_ASYNC_TASK_H
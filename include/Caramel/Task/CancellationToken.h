@@ -0,0 +1,54 @@
+// Caramel C++ Library - Task Facility - Cancellation Token Header
+
+#ifndef __CARAMEL_TASK_CANCELLATION_TOKEN_H
+#define __CARAMEL_TASK_CANCELLATION_TOKEN_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+
+
+namespace Caramel
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Cancellation Token
+// - Cancels a group of tasks at once. Copies share the same state.
+//   See Task::WithCancellation().
+//
+
+class CancellationTokenImpl;
+
+class CancellationToken
+{
+public:
+
+    CancellationToken();  // A new token, not cancelled yet.
+
+
+    //
+    // Cancel all tasks with this token.
+    // - The tasks added after it are cancelled immediately.
+    // - The running ones are not stopped.
+    //
+    void Cancel();
+
+    Bool IsCancelled() const;
+
+
+    /// Internal Accessors ///
+
+    std::shared_ptr< CancellationTokenImpl > GetImpl() const { return m_impl; }
+
+
+private:
+
+    std::shared_ptr< CancellationTokenImpl > m_impl;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_TASK_CANCELLATION_TOKEN_H
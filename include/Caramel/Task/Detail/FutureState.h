@@ -0,0 +1,383 @@
+// Caramel C++ Library - Task Facility - Detail - Future State Header
+
+#ifndef __CARAMEL_TASK_DETAIL_FUTURE_STATE_H
+#define __CARAMEL_TASK_DETAIL_FUTURE_STATE_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Error/Assert.h>
+#include <Caramel/Error/CatchException.h>
+#include <Caramel/Error/Exception.h>
+#include <Caramel/Task/TaskFwd.h>
+#include <Caramel/Thread/MutexLocks.h>
+#include <Caramel/Thread/SpinMutex.h>
+#include <boost/noncopyable.hpp>
+#include <boost/optional.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+
+namespace Caramel
+{
+
+namespace Detail
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Future State Base
+// - The shared state between a Future and its producer.
+//   It is a single allocation, no mutex or condition variable inside.
+//
+//   Continuations are chained into one TaskFunction, and run by the thread
+//   which makes the state ready. Wait() is also built on a continuation.
+//
+
+class FutureStateBase : public boost::noncopyable
+{
+public:
+
+    FutureStateBase() : m_ready( false ) {}
+
+
+    /// Operations ///
+
+    //
+    // Run the function when the state becomes ready.
+    // - If it is ready already, run it immediately in this thread.
+    // - The function should not throw.
+    //
+    void OnReady( TaskFunction&& f );
+
+    void Wait();
+
+    void SetException( std::exception_ptr exception );
+
+
+    /// Properties ///
+
+    Bool IsReady() const { return m_ready.load( std::memory_order_acquire ); }
+
+    // Valid after ready.
+    Bool IsFailed() const { return m_exception != nullptr; }
+
+    std::exception_ptr GetException() const { return m_exception; }
+
+
+protected:
+
+    void MakeReady();
+
+    void RethrowIfFailed() const;
+
+
+private:
+
+    std::atomic< Bool > m_ready;
+
+    // The continuations are protected by the spin mutex.
+    // - Most futures have at most one, which is kept out of the vector.
+    //   They run in the order of OnReady() calls.
+    SpinMutex    m_mutex;
+    TaskFunction m_continuation;
+    std::vector< TaskFunction > m_moreContinuations;
+
+    std::exception_ptr m_exception;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Future State
+//
+
+template< typename R >
+class FutureState : public FutureStateBase
+{
+public:
+
+    typedef const R& ResultType;
+
+    void SetValue( R&& value );
+    void SetValue( const R& value );
+
+    // Wait until ready, then returns the value or rethrows the exception.
+    ResultType Get();
+
+private:
+
+    boost::optional< R > m_value;
+};
+
+
+template<>
+class FutureState< void > : public FutureStateBase
+{
+public:
+
+    typedef void ResultType;
+
+    void SetValue() { this->MakeReady(); }
+
+    void Get();
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Future Invoker
+// - Calls a function with the value of a ready state, or without for void.
+//
+
+template< typename R >
+struct FutureInvoker
+{
+    template< typename Function >
+    static auto Invoke( FutureState< R >& state, Function& f ) -> decltype( f( state.Get() ))
+    {
+        return f( state.Get() );
+    }
+};
+
+
+template<>
+struct FutureInvoker< void >
+{
+    template< typename Function >
+    static auto Invoke( FutureState< void >& state, Function& f ) -> decltype( f() )
+    {
+        state.Get();
+        return f();
+    }
+};
+
+
+// The result type of a continuation, which takes the value of Future< R >.
+
+template< typename R, typename Function >
+struct ContinuationResult
+{
+    typedef typename std::decay< typename std::result_of< Function( const R& ) >::type >::type Type;
+};
+
+template< typename Function >
+struct ContinuationResult< void, Function >
+{
+    typedef typename std::decay< typename std::result_of< Function() >::type >::type Type;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Future Fulfiller
+// - Set the result of a function, or its exception, into a state.
+//
+
+template< typename R >
+struct FutureFulfiller
+{
+    template< typename Function >
+    static void Fulfill( FutureState< R >& state, const Function& f );
+};
+
+
+template<>
+struct FutureFulfiller< void >
+{
+    template< typename Function >
+    static void Fulfill( FutureState< void >& state, const Function& f );
+};
+
+
+// Returns a placeholder if the catcher has no C++ exception to rethrow.
+inline std::exception_ptr MakeFutureException( const Detail::ExceptionCatcherCore& xc )
+{
+    if ( xc.GetException() ) { return xc.GetException(); }
+
+    return std::make_exception_ptr(
+        Exception( __LINE__, __FILE__, __FUNCTION__, "Unknown exception caught in the task" ));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+inline void FutureStateBase::OnReady( TaskFunction&& f )
+{
+    {
+        SpinMutex::ScopedLock lock( m_mutex );
+
+        if ( ! m_ready.load( std::memory_order_relaxed ))
+        {
+            if ( ! m_continuation )
+            {
+                m_continuation = std::move( f );
+            }
+            else
+            {
+                m_moreContinuations.push_back( std::move( f ));
+            }
+            return;
+        }
+    }
+
+    f();
+}
+
+
+inline void FutureStateBase::Wait()
+{
+    if ( this->IsReady() ) { return; }
+
+    std::mutex mutex;
+    std::condition_variable becomesReady;
+    Bool ready = false;
+
+    this->OnReady( [&]
+    {
+        // Notify with the lock, this frame may be gone right after unlocking.
+        auto ulock = UniqueLock( mutex );
+        ready = true;
+        becomesReady.notify_all();
+    });
+
+    auto ulock = UniqueLock( mutex );
+
+    while ( ! ready )
+    {
+        becomesReady.wait( ulock );
+    }
+}
+
+
+inline void FutureStateBase::SetException( std::exception_ptr exception )
+{
+    m_exception = exception;
+    this->MakeReady();
+}
+
+
+inline void FutureStateBase::MakeReady()
+{
+    TaskFunction continuation;
+    std::vector< TaskFunction > moreContinuations;
+    {
+        SpinMutex::ScopedLock lock( m_mutex );
+
+        CARAMEL_ASSERT( ! m_ready.load( std::memory_order_relaxed ));
+
+        m_ready.store( true, std::memory_order_release );
+        continuation.swap( m_continuation );
+        moreContinuations.swap( m_moreContinuations );
+    }
+
+    if ( continuation )
+    {
+        continuation();
+    }
+
+    for ( auto& more : moreContinuations )
+    {
+        more();
+    }
+}
+
+
+inline void FutureStateBase::RethrowIfFailed() const
+{
+    if ( m_exception )
+    {
+        std::rethrow_exception( m_exception );
+    }
+}
+
+
+//
+// Future State
+//
+
+template< typename R >
+inline void FutureState< R >::SetValue( R&& value )
+{
+    m_value = std::move( value );
+    this->MakeReady();
+}
+
+
+template< typename R >
+inline void FutureState< R >::SetValue( const R& value )
+{
+    m_value = value;
+    this->MakeReady();
+}
+
+
+template< typename R >
+inline auto FutureState< R >::Get() -> ResultType
+{
+    this->Wait();
+    this->RethrowIfFailed();
+    return *m_value;
+}
+
+
+inline void FutureState< void >::Get()
+{
+    this->Wait();
+    this->RethrowIfFailed();
+}
+
+
+//
+// Future Fulfiller
+//
+
+template< typename R >
+template< typename Function >
+inline void FutureFulfiller< R >::Fulfill( FutureState< R >& state, const Function& f )
+{
+    boost::optional< R > value;
+
+    auto xc = CatchException( [&] { value = f(); } );
+
+    // Set outside the catcher, the continuations are not its business.
+    if ( xc )
+    {
+        state.SetException( MakeFutureException( xc ));
+    }
+    else
+    {
+        state.SetValue( std::move( *value ));
+    }
+}
+
+
+template< typename Function >
+inline void FutureFulfiller< void >::Fulfill( FutureState< void >& state, const Function& f )
+{
+    auto xc = CatchException( [&] { f(); } );
+
+    if ( xc )
+    {
+        state.SetException( MakeFutureException( xc ));
+    }
+    else
+    {
+        state.SetValue();
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Detail
+
+} // namespace Caramel
+
+#endif // __CARAMEL_TASK_DETAIL_FUTURE_STATE_H
@@ -0,0 +1,260 @@
+// Caramel C++ Library - Task Facility - Detail - Task Callable Header
+
+#ifndef __CARAMEL_TASK_DETAIL_TASK_CALLABLE_H
+#define __CARAMEL_TASK_DETAIL_TASK_CALLABLE_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace Caramel
+{
+
+namespace Detail
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Callable
+// - A move-only void() function object with small buffer optimization.
+//   Function objects up to INLINE_SIZE bytes, including a TaskFunction,
+//   are stored inside, larger ones are allocated. The choice is made at
+//   compile time, see IsInline.
+//
+//   Moves never throw : a function object is stored inside only if
+//   its move constructor doesn't throw.
+//
+//   Any function object converts to it implicitly, the Task constructor
+//   takes it instead of a TaskFunction.
+//
+
+class TaskCallable
+{
+public:
+
+    static const std::size_t INLINE_SIZE = 48;
+
+    TaskCallable();
+
+    template< typename Function >
+    TaskCallable(
+        Function&& f,
+        typename std::enable_if<
+            ! std::is_same< typename std::decay< Function >::type, TaskCallable >::value
+        >::type* = nullptr
+    );
+
+    TaskCallable( TaskCallable&& other ) CARAMEL_NOEXCEPT;
+    TaskCallable& operator=( TaskCallable&& other ) CARAMEL_NOEXCEPT;
+
+    ~TaskCallable();
+
+
+    /// Operations ///
+
+    void operator()() { m_manage( OP_INVOKE, *this, nullptr ); }
+
+
+    /// Properties ///
+
+    Bool IsEmpty() const { return nullptr == m_manage; }
+
+
+private:
+
+    TaskCallable( const TaskCallable& );
+    TaskCallable& operator=( const TaskCallable& );
+
+    enum Operation
+    {
+        OP_INVOKE,
+        OP_MOVE,     // Move from the other, which becomes empty.
+        OP_DESTROY,
+    };
+
+    typedef void ( *Manager )( Operation op, TaskCallable& self, TaskCallable* other );
+
+    template< typename F > struct InlineManager;
+    template< typename F > struct HeapManager;
+
+    template< typename F > struct IsInline;
+
+    template< typename Function >
+    void Construct( Function&& f, std::true_type /* inline */ );
+
+    template< typename Function >
+    void Construct( Function&& f, std::false_type /* inline */ );
+
+    void Reset();
+
+
+    /// Data Members ///
+
+    typedef std::aligned_storage< INLINE_SIZE >::type Storage;
+
+    Storage m_storage;
+    Manager m_manage;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+template< typename F >
+struct TaskCallable::InlineManager
+{
+    static F* Get( TaskCallable& c ) { return static_cast< F* >( static_cast< void* >( &c.m_storage )); }
+
+    static void Manage( Operation op, TaskCallable& self, TaskCallable* other )
+    {
+        switch ( op )
+        {
+        case OP_INVOKE:
+            ( *Get( self ))();
+            break;
+
+        case OP_MOVE:
+            new ( &self.m_storage ) F( std::move( *Get( *other )));
+            Get( *other )->~F();
+            break;
+
+        case OP_DESTROY:
+            Get( self )->~F();
+            break;
+        }
+    }
+};
+
+
+template< typename F >
+struct TaskCallable::IsInline
+    : std::integral_constant< Bool,
+        sizeof( F ) <= INLINE_SIZE
+     && std::alignment_of< Storage >::value % std::alignment_of< F >::value == 0
+     && std::is_nothrow_move_constructible< F >::value
+    >
+{};
+
+
+template< typename F >
+struct TaskCallable::HeapManager
+{
+    static F*& Get( TaskCallable& c ) { return *static_cast< F** >( static_cast< void* >( &c.m_storage )); }
+
+    static void Manage( Operation op, TaskCallable& self, TaskCallable* other )
+    {
+        switch ( op )
+        {
+        case OP_INVOKE:
+            ( *Get( self ))();
+            break;
+
+        case OP_MOVE:
+            Get( self ) = Get( *other );
+            break;
+
+        case OP_DESTROY:
+            delete Get( self );
+            break;
+        }
+    }
+};
+
+
+inline TaskCallable::TaskCallable()
+    : m_manage( nullptr )
+{
+}
+
+
+template< typename Function >
+inline TaskCallable::TaskCallable(
+    Function&& f,
+    typename std::enable_if<
+        ! std::is_same< typename std::decay< Function >::type, TaskCallable >::value
+    >::type*
+)
+{
+    typedef typename std::decay< Function >::type F;
+
+    this->Construct( std::forward< Function >( f ), IsInline< F >() );
+}
+
+
+template< typename Function >
+inline void TaskCallable::Construct( Function&& f, std::true_type )
+{
+    typedef typename std::decay< Function >::type F;
+
+    new ( &m_storage ) F( std::forward< Function >( f ));
+    m_manage = &InlineManager< F >::Manage;
+}
+
+
+template< typename Function >
+inline void TaskCallable::Construct( Function&& f, std::false_type )
+{
+    typedef typename std::decay< Function >::type F;
+
+    HeapManager< F >::Get( *this ) = new F( std::forward< Function >( f ));
+    m_manage = &HeapManager< F >::Manage;
+}
+
+
+inline TaskCallable::TaskCallable( TaskCallable&& other ) CARAMEL_NOEXCEPT
+    : m_manage( other.m_manage )
+{
+    if ( m_manage )
+    {
+        m_manage( OP_MOVE, *this, &other );
+        other.m_manage = nullptr;
+    }
+}
+
+
+inline TaskCallable& TaskCallable::operator=( TaskCallable&& other ) CARAMEL_NOEXCEPT
+{
+    if ( this != &other )
+    {
+        this->Reset();
+
+        m_manage = other.m_manage;
+
+        if ( m_manage )
+        {
+            m_manage( OP_MOVE, *this, &other );
+            other.m_manage = nullptr;
+        }
+    }
+    return *this;
+}
+
+
+inline TaskCallable::~TaskCallable()
+{
+    this->Reset();
+}
+
+
+inline void TaskCallable::Reset()
+{
+    if ( m_manage )
+    {
+        m_manage( OP_DESTROY, *this, nullptr );
+        m_manage = nullptr;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Detail
+
+} // namespace Caramel
+
+#endif // __CARAMEL_TASK_DETAIL_TASK_CALLABLE_H
@@ -0,0 +1,323 @@
+// Caramel C++ Library - Task Facility - Future Header
+
+#ifndef __CARAMEL_TASK_FUTURE_H
+#define __CARAMEL_TASK_FUTURE_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Error/CatchException.h>
+#include <Caramel/Error/Exception.h>
+#include <Caramel/Task/Detail/FutureState.h>
+#include <Caramel/Task/TaskExecutor.h>
+#include <atomic>
+#include <vector>
+
+
+namespace Caramel
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Future
+// - The result of a TaskT< R >, or of a continuation.
+//   Copies share the same state.
+//
+//   If the function throws, Get() rethrows the exception in the caller.
+//
+// Continuation :
+//   Then( executor, f ) submits f to the executor when this future is ready,
+//   and returns the future of f's result. No thread is blocked meanwhile.
+//   - f takes a const R&, or nothing for Future< void >.
+//   - If this future failed, f is skipped, the exception propagates to
+//     the returned future, and so on down the chain.
+//   - The executor must live until the continuation is submitted.
+//
+// CAUTION: Don't Wait() or Get() in a task of a single-thread executor,
+//          for a future which needs that executor to be ready.
+//
+
+template< typename R >
+class Future
+{
+public:
+
+    Future() {}  // Not a future, IsValid() returns false.
+
+    explicit Future( std::shared_ptr< Detail::FutureState< R >> state );
+
+
+    /// Operations ///
+
+    void Wait() const;
+
+    // Wait, then returns the value or rethrows the exception.
+    typename Detail::FutureState< R >::ResultType Get() const;
+
+    template< typename Function >
+    Future< typename Detail::ContinuationResult< R, Function >::Type >
+    Then( TaskExecutor& executor, Function f ) const;
+
+
+    /// Properties ///
+
+    Bool IsValid() const { return static_cast< Bool >( m_state ); }
+
+    Bool IsReady()  const;
+    Bool IsFailed() const;  // Ready with an exception.
+
+
+    /// Internal Accessors ///
+
+    std::shared_ptr< Detail::FutureState< R >> GetState() const { return m_state; }
+
+
+private:
+
+    std::shared_ptr< Detail::FutureState< R >> m_state;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// When All / When Any
+//
+// WhenAll : Ready when all futures are ready.
+//           Takes the values in the same order, or the first exception
+//           of them in the order. Future< void > results in Future< void >.
+//
+// WhenAny : Ready when any of the futures is ready, takes its index.
+//           The futures must not be empty.
+//
+
+namespace Detail
+{
+
+template< typename R >
+struct WhenAllResult
+{
+    typedef std::vector< R > Type;
+};
+
+template<>
+struct WhenAllResult< void >
+{
+    typedef void Type;
+};
+
+} // namespace Detail
+
+
+template< typename R >
+Future< typename Detail::WhenAllResult< R >::Type > WhenAll( const std::vector< Future< R >>& futures );
+
+template< typename R >
+Future< Uint > WhenAny( const std::vector< Future< R >>& futures );
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+template< typename R >
+inline Future< R >::Future( std::shared_ptr< Detail::FutureState< R >> state )
+    : m_state( std::move( state ))
+{
+}
+
+
+template< typename R >
+inline void Future< R >::Wait() const
+{
+    m_state->Wait();
+}
+
+
+template< typename R >
+inline typename Detail::FutureState< R >::ResultType Future< R >::Get() const
+{
+    return m_state->Get();
+}
+
+
+template< typename R >
+inline Bool Future< R >::IsReady() const
+{
+    return m_state && m_state->IsReady();
+}
+
+
+template< typename R >
+inline Bool Future< R >::IsFailed() const
+{
+    return this->IsReady() && m_state->IsFailed();
+}
+
+
+template< typename R >
+template< typename Function >
+inline Future< typename Detail::ContinuationResult< R, Function >::Type >
+Future< R >::Then( TaskExecutor& executor, Function f ) const
+{
+    typedef typename Detail::ContinuationResult< R, Function >::Type NextType;
+
+    auto state = m_state;
+    auto next = std::make_shared< Detail::FutureState< NextType >>();
+    TaskExecutor* pexecutor = &executor;
+
+    m_state->OnReady( [=]
+    {
+        // Propagate the exception without bothering the executor.
+        if ( state->IsFailed() )
+        {
+            next->SetException( state->GetException() );
+            return;
+        }
+
+        Task task( TaskName::Literal( "Continuation" ), [=]
+        {
+            Function func = f;
+            Detail::FutureFulfiller< NextType >::Fulfill(
+                *next, [&] { return Detail::FutureInvoker< R >::Invoke( *state, func ); } );
+        });
+
+        auto xc = CatchException( [&] { pexecutor->Submit( task ); } );
+        if ( xc )
+        {
+            next->SetException( Detail::MakeFutureException( xc ));
+        }
+    });
+
+    return Future< NextType >( next );
+}
+
+
+//
+// When All
+//
+
+namespace Detail
+{
+
+template< typename R >
+struct WhenAllCollector
+{
+    static void Collect( FutureState< std::vector< R >>& result, const std::vector< Future< R >>& futures )
+    {
+        std::vector< R > values;
+        values.reserve( futures.size() );
+
+        for ( Uint i = 0; i < futures.size(); ++ i )
+        {
+            values.push_back( futures[i].Get() );
+        }
+
+        result.SetValue( std::move( values ));
+    }
+};
+
+template<>
+struct WhenAllCollector< void >
+{
+    static void Collect( FutureState< void >& result, const std::vector< Future< void >>& )
+    {
+        result.SetValue();
+    }
+};
+
+
+template< typename R >
+struct WhenAllContext
+{
+    typedef typename WhenAllResult< R >::Type ResultType;
+
+    explicit WhenAllContext( const std::vector< Future< R >>& inputs )
+        : futures( inputs )
+        , remaining( static_cast< Uint >( inputs.size() ))
+        , result( std::make_shared< FutureState< ResultType >>() )
+    {}
+
+    void Complete()
+    {
+        for ( Uint i = 0; i < futures.size(); ++ i )
+        {
+            if ( futures[i].IsFailed() )
+            {
+                result->SetException( futures[i].GetState()->GetException() );
+                return;
+            }
+        }
+
+        WhenAllCollector< R >::Collect( *result, futures );
+    }
+
+    std::vector< Future< R >> futures;
+    std::atomic< Uint > remaining;
+    std::shared_ptr< FutureState< ResultType >> result;
+};
+
+} // namespace Detail
+
+
+template< typename R >
+inline Future< typename Detail::WhenAllResult< R >::Type > WhenAll( const std::vector< Future< R >>& futures )
+{
+    auto context = std::make_shared< Detail::WhenAllContext< R >>( futures );
+    auto result = Future< typename Detail::WhenAllResult< R >::Type >( context->result );
+
+    if ( futures.empty() )
+    {
+        context->Complete();
+        return result;
+    }
+
+    for ( Uint i = 0; i < futures.size(); ++ i )
+    {
+        futures[i].GetState()->OnReady( [=]
+        {
+            if ( 0 == -- context->remaining )
+            {
+                context->Complete();
+            }
+        });
+    }
+
+    return result;
+}
+
+
+//
+// When Any
+//
+
+template< typename R >
+inline Future< Uint > WhenAny( const std::vector< Future< R >>& futures )
+{
+    if ( futures.empty() )
+    {
+        CARAMEL_INVALID_ARGUMENT();
+    }
+
+    auto result = std::make_shared< Detail::FutureState< Uint >>();
+    auto done = std::make_shared< std::atomic< Bool >>( false );
+
+    for ( Uint i = 0; i < futures.size(); ++ i )
+    {
+        futures[i].GetState()->OnReady( [=]
+        {
+            if ( ! done->exchange( true ))
+            {
+                result->SetValue( i );
+            }
+        });
+    }
+
+    return Future< Uint >( result );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_TASK_FUTURE_H
@@ -0,0 +1,409 @@
+// Caramel C++ Library - Task Facility - Parallel Algorithms Header
+
+#ifndef __CARAMEL_TASK_PARALLEL_H
+#define __CARAMEL_TASK_PARALLEL_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Error/Assert.h>
+#include <Caramel/Task/TaskExecutor.h>
+#include <Caramel/Thread/MutexLocks.h>
+#include <Caramel/Thread/SpinMutex.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+
+
+namespace Caramel
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Parallel Algorithms
+// - Split a range of [first, last) into chunks, and run them by the caller
+//   together with helper tasks of an executor, e.g. a TaskStealingPool.
+//   The caller returns when all chunks are done.
+//
+//   Chunks are claimed on demand, starting at large ones and shrinking to
+//   the grain size near the end, so faster threads take more of the work.
+//
+//   Helpers are taken from a process-wide budget of the hardware threads.
+//   Nested calls, or calls in parallel, find fewer spare helpers, then the
+//   callers do more of the work themselves. Since the caller never waits for
+//   a helper to start, it may be called in a task of the same executor.
+//
+//   If a function throws, the remaining chunks are skipped, and the first
+//   exception is rethrown in the caller.
+//
+// ParallelFor       : f( i ) for each index.
+// ParallelReduce    : combine( ... map( i ) ... ), in any order.
+//                     The combine must be associative and commutative.
+// ParallelTransform : *( out + i ) = f( *( first + i )), for random access iterators.
+// ParallelSort      : Sort chunks of the grain size in parallel, then merge them.
+//
+
+//
+// The max number of helper tasks running at a time, across the process.
+// - The default is the number of hardware threads minus 1, for the callers.
+//
+void SetMaxParallelHelpers( Uint maxHelpers );
+Uint GetMaxParallelHelpers();
+
+
+template< typename Function >
+void ParallelFor( TaskExecutor& executor, Uint first, Uint last, Uint grain, Function f );
+
+template< typename T, typename MapFunction, typename CombineFunction >
+T ParallelReduce(
+    TaskExecutor& executor, Uint first, Uint last, Uint grain,
+    const T& identity, MapFunction map, CombineFunction combine );
+
+template< typename InputIterator, typename OutputIterator, typename Function >
+void ParallelTransform(
+    TaskExecutor& executor, InputIterator first, InputIterator last, OutputIterator out,
+    Uint grain, Function f );
+
+template< typename RandomIterator >
+void ParallelSort( TaskExecutor& executor, RandomIterator first, RandomIterator last, Uint grain );
+
+template< typename RandomIterator, typename Compare >
+void ParallelSort(
+    TaskExecutor& executor, RandomIterator first, RandomIterator last, Uint grain, Compare comp );
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Parallel Loop
+// - The shared state of the caller and the helpers.
+//
+
+namespace Detail
+{
+
+// Defined in Task.cpp, see TaskManager.
+Uint AcquireParallelHelpers( Uint wanted );
+void ReleaseParallelHelpers( Uint count );
+
+
+class ParallelLoop
+{
+public:
+
+    ParallelLoop( Uint first, Uint last, Uint grain, Uint participants );
+
+    //
+    // Claim and run chunks by f( begin, end ), until none is left.
+    // - A helper which starts late finds none, and never calls f.
+    //
+    template< typename RangeFunction >
+    void Run( RangeFunction& f );
+
+    // Wait until all chunks are done, then rethrow the first exception if any.
+    void Wait();
+
+
+private:
+
+    Bool Claim( Uint& begin, Uint& end );
+    void Done( Uint count );
+
+    const Uint m_last;
+    const Uint m_grain;
+    const Uint m_participants;
+
+    std::atomic< Uint > m_next;
+    std::atomic< Uint > m_remaining;  // Items not done yet.
+
+    std::atomic< Bool > m_failed;
+    std::exception_ptr  m_exception;
+
+    std::mutex m_mutex;
+    std::condition_variable m_allDone;
+};
+
+
+//
+// Run f( begin, end ) over chunks of [first, last).
+//
+template< typename RangeFunction >
+void ParallelRun( TaskExecutor& executor, Uint first, Uint last, Uint grain, RangeFunction f );
+
+} // namespace Detail
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+namespace Detail
+{
+
+inline ParallelLoop::ParallelLoop( Uint first, Uint last, Uint grain, Uint participants )
+    : m_last( last )
+    , m_grain( grain )
+    , m_participants( participants )
+    , m_next( first )
+    , m_remaining( last - first )
+    , m_failed( false )
+{
+}
+
+
+template< typename RangeFunction >
+inline void ParallelLoop::Run( RangeFunction& f )
+{
+    Uint begin = 0;
+    Uint end = 0;
+
+    while ( this->Claim( begin, end ))
+    {
+        if ( ! m_failed )
+        {
+            try
+            {
+                f( begin, end );
+            }
+            catch ( ... )
+            {
+                auto ulock = UniqueLock( m_mutex );
+
+                if ( ! m_failed )
+                {
+                    m_exception = std::current_exception();
+                    m_failed = true;
+                }
+            }
+        }
+
+        this->Done( end - begin );
+    }
+}
+
+
+inline Bool ParallelLoop::Claim( Uint& begin, Uint& end )
+{
+    Uint next = m_next.load();
+
+    for ( ;; )
+    {
+        if ( m_last <= next ) { return false; }
+
+        // Guided : a share of the rest for each participant, at least a grain.
+        const Uint rest = m_last - next;
+        const Uint size = std::min( rest, std::max( m_grain, rest / ( 2 * m_participants )));
+
+        if ( m_next.compare_exchange_weak( next, next + size ))
+        {
+            begin = next;
+            end = next + size;
+            return true;
+        }
+    }
+}
+
+
+inline void ParallelLoop::Done( Uint count )
+{
+    if ( count == m_remaining.fetch_sub( count ))
+    {
+        auto ulock = UniqueLock( m_mutex );
+        m_allDone.notify_all();
+    }
+}
+
+
+inline void ParallelLoop::Wait()
+{
+    {
+        auto ulock = UniqueLock( m_mutex );
+
+        while ( 0 < m_remaining )
+        {
+            m_allDone.wait( ulock );
+        }
+    }
+
+    if ( m_exception )
+    {
+        std::rethrow_exception( m_exception );
+    }
+}
+
+
+template< typename RangeFunction >
+inline void ParallelRun( TaskExecutor& executor, Uint first, Uint last, Uint grain, RangeFunction f )
+{
+    if ( last <= first ) { return; }
+
+    grain = std::max( grain, 1u );
+
+    const Uint numChunks = ( last - first + grain - 1 ) / grain;
+    const Uint numHelpers = AcquireParallelHelpers( numChunks - 1 );
+
+    if ( 0 == numHelpers )
+    {
+        f( first, last );
+        return;
+    }
+
+    auto loop = std::make_shared< ParallelLoop >( first, last, grain, numHelpers + 1 );
+
+    for ( Uint i = 0; i < numHelpers; ++ i )
+    {
+        // Returns the helper's slot when the task is destroyed, even if it never runs.
+        std::shared_ptr< void > slot( nullptr, [] ( void* ) { ReleaseParallelHelpers( 1 ); } );
+
+        try
+        {
+            executor.Submit( Task( TaskName::Literal( "ParallelHelper" ), [loop, f, slot] () mutable
+            {
+                loop->Run( f );
+            }));
+        }
+        catch ( ... )
+        {
+            // The caller does the work. The slot of this one is returned by its task.
+            ReleaseParallelHelpers( numHelpers - i - 1 );
+            break;
+        }
+    }
+
+    loop->Run( f );
+    loop->Wait();
+}
+
+} // namespace Detail
+
+
+//
+// Parallel For
+//
+
+template< typename Function >
+inline void ParallelFor( TaskExecutor& executor, Uint first, Uint last, Uint grain, Function f )
+{
+    Detail::ParallelRun( executor, first, last, grain, [&f] ( Uint begin, Uint end )
+    {
+        for ( Uint i = begin; i < end; ++ i )
+        {
+            f( i );
+        }
+    });
+}
+
+
+//
+// Parallel Reduce
+//
+
+template< typename T, typename MapFunction, typename CombineFunction >
+inline T ParallelReduce(
+    TaskExecutor& executor, Uint first, Uint last, Uint grain,
+    const T& identity, MapFunction map, CombineFunction combine )
+{
+    T total = identity;
+    SpinMutex totalMutex;
+
+    Detail::ParallelRun( executor, first, last, grain, [&] ( Uint begin, Uint end )
+    {
+        T partial = map( begin );
+
+        for ( Uint i = begin + 1; i < end; ++ i )
+        {
+            partial = combine( partial, map( i ));
+        }
+
+        SpinMutex::ScopedLock lock( totalMutex );
+        total = combine( total, partial );
+    });
+
+    return total;
+}
+
+
+//
+// Parallel Transform
+//
+
+template< typename InputIterator, typename OutputIterator, typename Function >
+inline void ParallelTransform(
+    TaskExecutor& executor, InputIterator first, InputIterator last, OutputIterator out,
+    Uint grain, Function f )
+{
+    const Uint size = static_cast< Uint >( std::distance( first, last ));
+
+    Detail::ParallelRun( executor, 0, size, grain, [&] ( Uint begin, Uint end )
+    {
+        std::transform( first + begin, first + end, out + begin, f );
+    });
+}
+
+
+//
+// Parallel Sort
+//
+
+template< typename RandomIterator >
+inline void ParallelSort( TaskExecutor& executor, RandomIterator first, RandomIterator last, Uint grain )
+{
+    typedef typename std::iterator_traits< RandomIterator >::value_type ValueType;
+
+    ParallelSort( executor, first, last, grain, std::less< ValueType >() );
+}
+
+
+template< typename RandomIterator, typename Compare >
+inline void ParallelSort(
+    TaskExecutor& executor, RandomIterator first, RandomIterator last, Uint grain, Compare comp )
+{
+    const Uint size = static_cast< Uint >( std::distance( first, last ));
+
+    grain = std::max( grain, 1u );
+
+    if ( size <= grain )
+    {
+        std::sort( first, last, comp );
+        return;
+    }
+
+    // Sorted runs of the grain size, the last one may be shorter.
+
+    const Uint numRuns = ( size + grain - 1 ) / grain;
+
+    ParallelFor( executor, 0, numRuns, 1, [&] ( Uint run )
+    {
+        std::sort( first + run * grain, first + std::min( size, ( run + 1 ) * grain ), comp );
+    });
+
+    // Merge the adjacent runs by pairs, doubling the run length each round.
+
+    for ( Uint width = grain; width < size; width *= 2 )
+    {
+        const Uint numPairs = ( size + 2 * width - 1 ) / ( 2 * width );
+
+        ParallelFor( executor, 0, numPairs, 1, [&] ( Uint pair )
+        {
+            const Uint begin  = pair * 2 * width;
+            const Uint middle = std::min( size, begin + width );
+            const Uint end    = std::min( size, begin + 2 * width );
+
+            if ( middle < end )
+            {
+                std::inplace_merge( first + begin, first + middle, first + end, comp );
+            }
+        });
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_TASK_PARALLEL_H
@@ -0,0 +1,70 @@
+// Caramel C++ Library - Task Facility - Strand Header
+
+#ifndef __CARAMEL_TASK_STRAND_H
+#define __CARAMEL_TASK_STRAND_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Task/TaskExecutor.h>
+
+
+namespace Caramel
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Strand
+// - Runs its tasks one at a time in the submitted order, by an underlying
+//   executor, e.g. a TaskThreadPool shared with other strands.
+//
+//   Objects which are only touched by the tasks of one strand need no lock.
+//   Tasks submitted by one thread run in that order. The tasks of a strand
+//   may run in different threads, but never concurrently.
+//
+//   Ready tasks wait in a lock-free queue. While the strand has tasks,
+//   one drain task is submitted to the underlying executor, which runs up to
+//   a batch of them, then yields the thread by submitting itself again.
+//
+//   Delayed and repeating tasks are scheduled by the underlying executor,
+//   and join the queue when they are due. Cancelling one drops it from
+//   the underlying executor at once.
+//   A cancelled task is dropped when it reaches the front of the queue.
+//
+//   An exception thrown by a task is caught and traced.
+//   If the underlying executor refuses the drain, e.g. it has been shut down,
+//   Submit() throws and the queued tasks are discarded.
+//
+//   The underlying executor must outlive the submitted tasks.
+//   The strand itself may be destroyed before its tasks are done.
+//
+
+class StrandImpl;
+
+class Strand : public TaskExecutor
+{
+public:
+
+    explicit Strand( TaskExecutor& executor );
+
+    void Submit( const Task& task ) override;
+
+    TaskCounters GetCounters() const override;
+
+
+    /// Properties ///
+
+    // True in a task of this strand.
+    Bool IsRunningInThisThread() const;
+
+
+private:
+
+    std::shared_ptr< StrandImpl > m_impl;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_TASK_STRAND_H
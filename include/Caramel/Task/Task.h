@@ -6,12 +6,50 @@
 
 #include <Caramel/Caramel.h>
 #include <Caramel/Chrono/TickClock.h>
+#include <Caramel/Task/Detail/TaskCallable.h>
 #include <Caramel/Task/TaskFwd.h>
+#include <Caramel/Task/TaskName.h>
 
 
 namespace Caramel
 {
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Priority
+// - Honored by TaskPoller, other executors ignore it.
+//
+
+enum TaskPriority
+{
+    TASK_PRIORITY_HIGH   = 0,
+    TASK_PRIORITY_NORMAL = 1,  // Default
+    TASK_PRIORITY_LOW    = 2,
+
+    TASK_PRIORITY_COUNT
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Repeat Mode
+// - How a repeating task is scheduled for its next run, see Task::Every().
+//
+
+enum TaskRepeatMode
+{
+    // Due times are on a fixed grid of intervals, no drift.
+    // Missed ticks are skipped, like TimedBool::Continue().
+    TASK_REPEAT_FIXED_RATE = 0,
+
+    // Like FIXED_RATE, but missed ticks are run back-to-back to catch up.
+    TASK_REPEAT_FIXED_RATE_CATCH_UP = 1,
+
+    // The next run is an interval after the previous run ends.
+    TASK_REPEAT_FIXED_DELAY = 2,
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // Task
@@ -25,7 +63,15 @@ public:
 
     Task();  // Create a "not-a-task". Submit it results in nothing.
 
-    Task( const std::string& name, TaskFunction&& f );
+    //
+    // Takes any function object, see Detail::TaskCallable.
+    // - The task is allocated from a pool, with the function object
+    //   inside if it is small.
+    // - The name is copied, unless it is TaskName::Literal() or Lazy(),
+    //   which keep pointers : their strings, and the owner's name of Lazy(),
+    //   must outlive the task. See TaskName.
+    //
+    Task( const TaskName& name, Detail::TaskCallable&& f );
 
 
     /// Delay : Schedule the task after due time. ///
@@ -33,18 +79,62 @@ public:
     Task& DelayFor( const Ticks& ticks );
 
 
+    //
+    // Repeat : Run the task every interval, until it is cancelled.
+    // - The first run is after an interval, or after DelayFor() if it is set.
+    // - The same task is rescheduled each time, nothing is allocated.
+    // - Drain() of the thread pools doesn't wait for the idle cycles.
+    //
+    Task& Every( const Ticks& interval, TaskRepeatMode mode = TASK_REPEAT_FIXED_RATE );
+
+
+    /// Priority ///
+
+    Task& WithPriority( TaskPriority priority );
+
+
+    /// Cancellation ///
+
+    // Cancel this task by the token, too. A task can have only one token.
+    Task& WithCancellation( const CancellationToken& token );
+
+    //
+    // A cancelled task doesn't run, and is dropped by its executor.
+    // - A delayed one is removed from the executor immediately.
+    // - It can't stop a running task.
+    // - Returns true if the task is cancelled before running,
+    //   or a repeating task is stopped.
+    //
+    Bool Cancel();
+
+
     /// Properties ///
 
     std::string Name() const;
 
+    TaskPriority Priority() const;
+
     Bool IsEmpty()     const;  // "Not a task"
     Bool IsCompleted() const;  // "Ran to Completion" or Cancelled
+    Bool IsRepeating() const;
+    Bool IsCancelled() const;
 
 
     /// Internal Accessors ///
     
     std::shared_ptr< TaskImpl > GetImpl() const { return m_impl; }
 
+    explicit Task( std::shared_ptr< TaskImpl > impl ) : m_impl( std::move( impl )) {}
+
+
+protected:
+
+    // Called if the task is cancelled before running. Set it before submitting.
+    void OnCancelled( Detail::TaskCallable&& f );
+
+    // Owned by the task, valid while it lives.
+    const TaskName& GetTaskName() const;
+
 
 private:
 
@@ -11,6 +11,20 @@
 namespace Caramel
 {
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Counters
+//
+
+struct TaskCounters
+{
+    TaskCounters() : runCount( 0 ), cancelledCount( 0 ) {}
+
+    Uint64 runCount;        // Including the tasks which throw.
+    Uint64 cancelledCount;  // Dropped without running.
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // Task Executor
@@ -24,6 +38,9 @@ public:
 
     virtual void Submit( const Task& task ) = 0;
 
+    // Optional statistics. An executor which doesn't count returns zeros.
+    virtual TaskCounters GetCounters() const { return TaskCounters(); }
+
 };
 
 
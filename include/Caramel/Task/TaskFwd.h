@@ -24,9 +24,17 @@ typedef std::function< void() > TaskFunction;
 // Forwards Declaration
 //
 
+class CancellationToken;
+class Strand;
 class Task;
 class TaskExecutor;
+class TaskGraph;
 class TaskPoller;
+class TaskStealingPool;
+class TaskThreadPool;
+
+template< typename R > class Future;
+template< typename R > class TaskT;
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,124 @@
+// Caramel C++ Library - Task Facility - Task Graph Header
+
+#ifndef __CARAMEL_TASK_TASK_GRAPH_H
+#define __CARAMEL_TASK_TASK_GRAPH_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Chrono/SecondClock.h>
+#include <Caramel/Task/Future.h>
+#include <Caramel/Task/TaskExecutor.h>
+#include <vector>
+
+
+namespace Caramel
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Graph Timing
+// - The durations of the nodes in a run, and its critical path :
+//   the chain of dependent nodes whose durations add up the longest.
+//
+
+struct TaskGraphNodeTiming
+{
+    std::string name;
+    Seconds startTime;  // Since the run started.
+    Seconds duration;
+};
+
+
+struct TaskGraphTiming
+{
+    Seconds wallTime;
+    Seconds criticalPathTime;
+
+    std::vector< Uint > criticalPath;  // Node ids, in the running order.
+    std::vector< TaskGraphNodeTiming > nodes;
+
+    //
+    // One line of the times, followed by the critical path, e.g.
+    //   Frame : wall 12.30 ms, critical path 10.10 ms
+    //     Load 2.00 ms -> Parse 3.10 ms -> Simulate 5.00 ms
+    //
+    std::string ToString( const std::string& graphName ) const;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Graph
+// - Nodes are functions, and edges are dependencies between them.
+//   Built once, then run many times on any TaskExecutor.
+//
+//   When a run starts, each node counts its unfinished predecessors.
+//   A finished node decreases the counters of its successors, and submits
+//   the ones reaching zero. Counters are atomic, no lock is taken.
+//   So independent branches run in parallel on a multi-threaded executor.
+//
+//   Run() returns a Future, ready when all nodes are done. If a node throws,
+//   the rest of the nodes are skipped, and the future fails by the exception.
+//
+//   A graph runs one at a time. It may be destroyed while running,
+//   the run continues to the end.
+//
+// USAGE:
+//   TaskGraph graph( "Frame" );
+//   auto load  = graph.AddNode( "Load",  [] { ... } );
+//   auto parse = graph.AddNode( "Parse", [] { ... } );
+//   graph.AddDependency( load, parse );  // Parse after load.
+//
+//   graph.Run( pool ).Get();
+//   CARAMEL_TRACE_INFO( "%s", graph.GetLastTiming().ToString( "Frame" ));
+//
+
+class TaskGraphImpl;
+
+class TaskGraph
+{
+public:
+
+    explicit TaskGraph( const std::string& name );
+
+
+    /// Building ///
+    //
+    // Not allowed while running.
+    //
+
+    Uint AddNode( const std::string& name, TaskFunction f );
+
+    // The after node runs when the before node is done.
+    void AddDependency( Uint before, Uint after );
+
+
+    /// Running ///
+
+    //
+    // Throws if the graph has a cycle, or if it is running.
+    //
+    Future< void > Run( TaskExecutor& executor );
+
+
+    /// Properties ///
+
+    Uint GetNodeCount() const;
+
+    Bool IsRunning() const;
+
+    // The timing of the last completed run.
+    TaskGraphTiming GetLastTiming() const;
+
+
+private:
+
+    std::shared_ptr< TaskGraphImpl > m_impl;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_TASK_TASK_GRAPH_H
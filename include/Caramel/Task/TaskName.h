@@ -0,0 +1,142 @@
+// Caramel C++ Library - Task Facility - Task Name Header
+
+#ifndef __CARAMEL_TASK_TASK_NAME_H
+#define __CARAMEL_TASK_TASK_NAME_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/String/Sprintf.h>
+
+
+namespace Caramel
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Name
+// - Names are only read for traces and errors, so they may cost nothing
+//   until then :
+//
+//   1. A string         : Copied, a short one fits in the std::string.
+//   2. Literal( s )     : Keeps the pointer only.
+//                         s must be a string literal, or in static storage.
+//   3. Lazy( format, owner, id )
+//                       : Keeps the format, a reference of the owner's name
+//                         and an id. Sprintf( format, owner, id ) is called
+//                         by ToString(). The format must be a string literal,
+//                         and the owner must outlive the task.
+//
+//   Task( "Poll", ... )
+//   Task( TaskName::Literal( "Strand.Drain" ), ... )
+//   Task( TaskName::Lazy( "Machine[%s].ProcessEvent[%d]", m_name, eventId ), ... )
+//
+
+class TaskName
+{
+public:
+
+    TaskName();  // Anonymous
+
+    TaskName( const Char* name );
+    TaskName( const std::string& name );
+    TaskName( std::string&& name );
+
+    static TaskName Literal( const Char* literal );
+    static TaskName Lazy( const Char* literalFormat, const std::string& owner, Int id );
+
+
+    /// Properties ///
+
+    std::string ToString() const;
+
+    Bool IsEmpty() const;
+
+
+private:
+
+    const Char*        m_literal;
+    const std::string* m_owner;
+    Int                m_id;
+
+    std::string m_string;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+inline TaskName::TaskName()
+    : m_literal( nullptr )
+    , m_owner( nullptr )
+    , m_id( 0 )
+{
+}
+
+
+inline TaskName::TaskName( const Char* name )
+    : m_literal( nullptr )
+    , m_owner( nullptr )
+    , m_id( 0 )
+    , m_string( name )
+{
+}
+
+
+inline TaskName::TaskName( const std::string& name )
+    : m_literal( nullptr )
+    , m_owner( nullptr )
+    , m_id( 0 )
+    , m_string( name )
+{
+}
+
+
+inline TaskName::TaskName( std::string&& name )
+    : m_literal( nullptr )
+    , m_owner( nullptr )
+    , m_id( 0 )
+    , m_string( std::move( name ))
+{
+}
+
+
+inline TaskName TaskName::Literal( const Char* literal )
+{
+    TaskName name;
+    name.m_literal = literal;
+    return name;
+}
+
+
+inline TaskName TaskName::Lazy( const Char* literalFormat, const std::string& owner, Int id )
+{
+    TaskName name;
+    name.m_literal = literalFormat;
+    name.m_owner = &owner;
+    name.m_id = id;
+    return name;
+}
+
+
+inline std::string TaskName::ToString() const
+{
+    if ( m_owner )   { return Sprintf( m_literal, *m_owner, m_id ); }
+    if ( m_literal ) { return std::string( m_literal ); }
+
+    return m_string;
+}
+
+
+inline Bool TaskName::IsEmpty() const
+{
+    return ! m_literal && m_string.empty();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_TASK_TASK_NAME_H
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <Caramel/Caramel.h>
+#include <Caramel/Chrono/SecondClock.h>
 #include <Caramel/Chrono/TickClock.h>
 #include <Caramel/Task/TaskExecutor.h>
 
@@ -12,9 +13,43 @@
 namespace Caramel
 {
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Lane Statistics
+//
+
+struct TaskLaneStats
+{
+    TaskLaneStats() : queueDepth( 0 ), dequeuedCount( 0 ) {}
+
+    Uint    queueDepth;     // Ready tasks waiting in the lane now.
+    Uint64  dequeuedCount;  // Including the cancelled ones.
+
+    // From ready to dequeued, a delayed task is ready when it is due.
+    Seconds totalWait;
+    Seconds maxWait;
+
+    Seconds AverageWait() const
+    {
+        return 0 == dequeuedCount ? Seconds::Zero() : Seconds( totalWait.count() / dequeuedCount );
+    }
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // Task Poller
+// - Runs tasks in the threads which call PollFor() or WaitAndPollFor().
+//
+//   Ready tasks wait in one lane per TaskPriority. Lanes are served by
+//   weighted rounds of 8 : 4 : 1 turns, higher lanes first in each round.
+//   An empty lane gives its turns away, and a new round starts when
+//   the lanes with turns left are empty.
+//
+//   It is weighted-fair, not strict : rounds carry over across PollFor()
+//   calls, so once the high lane has used its 8 turns, up to 4 normal and
+//   1 low tasks run before the next high one. A burst of high priority tasks
+//   gets 8 of each 13 turns, but can't starve the lower lanes.
 //
 
 class TaskPollerImpl;
@@ -27,6 +62,8 @@ public:
 
     void Submit( const Task& task ) override;
 
+    TaskCounters GetCounters() const override;
+
     void PollOne();
 
     //
@@ -35,6 +72,18 @@ public:
     //
     void PollFor( const Ticks& sliceTicks );
 
+    //
+    // Block until a task is ready or a delayed task is due, then PollFor().
+    // Returns false if no task is polled in max wait.
+    // An idle polling thread sleeps on a condition variable, costs no CPU.
+    //
+    Bool WaitAndPollFor( const Ticks& maxWait, const Ticks& sliceTicks );
+
+
+    /// Statistics ///
+
+    TaskLaneStats GetLaneStats( TaskPriority priority ) const;
+
 
 private:
 
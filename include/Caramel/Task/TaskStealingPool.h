@@ -0,0 +1,85 @@
+// Caramel C++ Library - Task Facility - Task Stealing Pool Header
+
+#ifndef __CARAMEL_TASK_TASK_STEALING_POOL_H
+#define __CARAMEL_TASK_TASK_STEALING_POOL_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Task/TaskExecutor.h>
+
+
+namespace Caramel
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Stealing Pool
+// - A work-stealing thread pool.
+//
+//   Each worker has its own Concurrent::WorkStealingDeque :
+//   - Tasks submitted by a running task of this pool are pushed to
+//     the local deque of its worker, without any lock.
+//   - A worker pops its local tasks in LIFO order, for cache locality.
+//   - A worker with no local task steals from a random victim, in FIFO order.
+//
+//   Tasks submitted by other threads go into a global injection queue.
+//   Workers take them in small batches into the local deques.
+//   Delayed tasks wait in a shared timing wheel until they are due.
+//
+//   Like TaskThreadPool, idle workers are blocked, not spinning.
+//   Tasks may run concurrently, in any order across the workers.
+//
+
+class TaskStealingPoolImpl;
+
+class TaskStealingPool : public TaskExecutor
+{
+public:
+
+    //
+    // Start the worker threads.
+    // - 0 means the number of hardware threads.
+    //
+    explicit TaskStealingPool( const std::string& name, Uint numThreads = 0 );
+
+    // Shutdown, if not yet.
+    ~TaskStealingPool();
+
+    //
+    // Throws if the pool has been shut down.
+    //
+    void Submit( const Task& task ) override;
+
+    //
+    // Block until all submitted tasks, including the delayed ones and
+    // the ones submitted by running tasks, are done.
+    // - Don't call it in tasks of this pool.
+    //
+    void Drain();
+
+    //
+    // Run the ready tasks, cancel the delayed ones, then stop and join the workers.
+    // - Call Drain() first to wait for the delayed tasks.
+    // - Throws if called in tasks of this pool.
+    //
+    void Shutdown();
+
+
+    /// Properties ///
+
+    Uint GetThreadCount() const;
+
+    TaskCounters GetCounters() const override;
+
+
+private:
+
+    std::shared_ptr< TaskStealingPoolImpl > m_impl;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_TASK_TASK_STEALING_POOL_H
@@ -0,0 +1,125 @@
+// Caramel C++ Library - Task Facility - Task with Result Header
+
+#ifndef __CARAMEL_TASK_TASK_T_H
+#define __CARAMEL_TASK_TASK_T_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Error/Exception.h>
+#include <Caramel/Task/Future.h>
+#include <Caramel/Task/Task.h>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+
+namespace Caramel
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task with Result
+// - A Task which returns a value, got by its Future.
+//   Submit it to any TaskExecutor, like a Task.
+//
+//   If the function throws, the future takes the exception.
+//   If the task is cancelled, the future fails with a Caramel::Exception.
+//
+
+template< typename R >
+class TaskT : public Task
+{
+public:
+
+    //
+    // Takes any function object returning R. Like a Task, it is stored
+    // inside the task if it is small, see Detail::TaskCallable.
+    //
+    template< typename Function >
+    TaskT( const TaskName& name, Function&& f );
+
+
+    /// Properties ///
+
+    Future< R > GetFuture() const { return Future< R >( m_state ); }
+
+
+private:
+
+    std::shared_ptr< Detail::FutureState< R >> m_state;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+namespace Detail
+{
+
+//
+// The function of a TaskT, moved into the Task.
+//
+template< typename R, typename Function >
+struct TaskTRunner
+{
+    TaskTRunner( std::shared_ptr< FutureState< R >> state, Function&& function )
+        : state( std::move( state ))
+        , function( std::move( function ))
+    {}
+
+    void operator()()
+    {
+        Function& f = function;
+        FutureFulfiller< R >::Fulfill( *state, [&f] { return f(); } );
+    }
+
+    std::shared_ptr< FutureState< R >> state;
+    Function function;
+};
+
+
+//
+// Formats the name only when the task is cancelled.
+// - The name is owned by the task, which owns this handler too.
+//
+template< typename R >
+struct TaskTCancelledHandler
+{
+    void operator()()
+    {
+        state->SetException( std::make_exception_ptr(
+            Exception( __LINE__, __FILE__, __FUNCTION__,
+                       Sprintf( "Task is cancelled, name: %s", name->ToString() ))));
+    }
+
+    std::shared_ptr< FutureState< R >> state;
+    const TaskName* name;
+};
+
+} // namespace Detail
+
+
+template< typename R >
+template< typename Function >
+inline TaskT< R >::TaskT( const TaskName& name, Function&& f )
+    : m_state( std::make_shared< Detail::FutureState< R >>() )
+{
+    typedef typename std::decay< Function >::type FunctionType;
+
+    FunctionType func( std::forward< Function >( f ));
+
+    static_cast< Task& >( *this ) = Task(
+        name, Detail::TaskTRunner< R, FunctionType >( m_state, std::move( func )));
+
+    Detail::TaskTCancelledHandler< R > handler = { m_state, &this->GetTaskName() };
+    this->OnCancelled( std::move( handler ));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_TASK_TASK_T_H
@@ -0,0 +1,78 @@
+// Caramel C++ Library - Task Facility - Task Thread Pool Header
+
+#ifndef __CARAMEL_TASK_TASK_THREAD_POOL_H
+#define __CARAMEL_TASK_TASK_THREAD_POOL_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Task/TaskExecutor.h>
+
+
+namespace Caramel
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Thread Pool
+// - Runs tasks by its own worker threads.
+//   Idle workers are blocked until a task is ready, or a delayed one is due.
+//
+//   Tasks may run concurrently, in any order across the workers.
+//   An exception thrown by a task is caught and traced, the worker continues.
+//
+
+class TaskThreadPoolImpl;
+
+class TaskThreadPool : public TaskExecutor
+{
+public:
+
+    //
+    // Start the worker threads.
+    // - 0 means the number of hardware threads.
+    //
+    explicit TaskThreadPool( const std::string& name, Uint numThreads = 0 );
+
+    // Shutdown, if not yet.
+    ~TaskThreadPool();
+
+    //
+    // Throws if the pool has been shut down.
+    //
+    void Submit( const Task& task ) override;
+
+    //
+    // Block until all submitted tasks, including the delayed ones and
+    // the ones submitted by running tasks, are done.
+    // - Don't call it in tasks of this pool.
+    //
+    void Drain();
+
+    //
+    // Run the ready tasks, cancel the delayed ones, then stop and join the workers.
+    // - Call Drain() first to wait for the delayed tasks.
+    // - Submitting tasks is still allowed while shutting down, but the delayed
+    //   ones are cancelled. It throws after the workers stopped.
+    // - Throws if called in tasks of this pool.
+    //
+    void Shutdown();
+
+
+    /// Properties ///
+
+    Uint GetThreadCount() const;
+
+    TaskCounters GetCounters() const override;
+
+
+private:
+
+    std::shared_ptr< TaskThreadPoolImpl > m_impl;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_TASK_TASK_THREAD_POOL_H
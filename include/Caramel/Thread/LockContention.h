@@ -0,0 +1,141 @@
+// Caramel C++ Library - Thread Facility - Lock Contention Header
+
+#ifndef __CARAMEL_THREAD_LOCK_CONTENTION_H
+#define __CARAMEL_THREAD_LOCK_CONTENTION_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <boost/noncopyable.hpp>
+#include <mutex>
+
+
+namespace Caramel
+{
+
+namespace Detail
+{
+class LockContentionEntry;
+} // namespace Detail
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Tracked Mutex
+// - A std::mutex which can report its contention, works with UniqueLock().
+//
+//   Only named mutexes are tracked, and only while LockContention is enabled.
+//   Otherwise it costs just one more branch than a std::mutex.
+//
+//   Mutexes with the same name share one entry in the report,
+//   e.g. all shards of a StripedHashMap.
+//
+
+class TrackedMutex : public boost::noncopyable
+{
+public:
+
+    TrackedMutex();
+
+    // Call it before the mutex is shared by threads.
+    void SetName( const std::string& name );
+
+
+    /// Lockable Operations ///
+
+    void lock();
+    bool try_lock();
+    void unlock();
+
+
+private:
+
+    void LockTracked();
+    void UnlockTracked();
+
+    std::mutex m_mutex;
+
+    Detail::LockContentionEntry* m_entry;  // nullptr if not named
+
+    // Accessed by the owner thread only.
+    Bool  m_tracking;
+    Int64 m_acquiredMicros;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Lock Contention
+// - Runtime switch and report of all named TrackedMutexes.
+//
+//   For each name, it records :
+//     acquisitions, contended acquisitions, total wait time and max hold time.
+//
+// USAGE:
+//   Name the concurrent containers by their SetContentionName(),
+//   call LockContention::Enable() at startup, then ReportToTrace() later.
+//
+
+class LockContention
+{
+public:
+
+    /// Facility Operations ///
+
+    static void Enable();
+    static void Disable();
+
+    static Bool IsEnabled();
+
+    // Reset all counters to zero, names are kept.
+    static void Reset();
+
+    static void ReportToTrace();
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+inline TrackedMutex::TrackedMutex()
+    : m_entry( nullptr )
+    , m_tracking( false )
+    , m_acquiredMicros( 0 )
+{
+}
+
+
+inline void TrackedMutex::lock()
+{
+    if ( m_entry && LockContention::IsEnabled() )
+    {
+        this->LockTracked();
+        return;
+    }
+
+    m_mutex.lock();
+}
+
+
+inline bool TrackedMutex::try_lock()
+{
+    return m_mutex.try_lock();
+}
+
+
+inline void TrackedMutex::unlock()
+{
+    if ( m_tracking )
+    {
+        this->UnlockTracked();
+    }
+
+    m_mutex.unlock();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_THREAD_LOCK_CONTENTION_H
@@ -14,6 +14,8 @@ namespace Caramel
 ///////////////////////////////////////////////////////////////////////////////
 //
 // Lock Functions
+// - Also work with TrackedMutex, which can report its contention.
+//   See Thread/LockContention.h
 //
 
 template< typename MutexType >
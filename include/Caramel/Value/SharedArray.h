@@ -88,8 +88,8 @@ public:
 
     typedef ValueType* Iterator;
 
-    Iterator Begin() { return &m_array[0]; }
-    Iterator End()   { return &m_array[ m_size ]; }
+    Iterator Begin() { return &this->m_array[0]; }
+    Iterator End()   { return &this->m_array[ this->m_size ]; }
 
 
     /// STL Compatible ///
@@ -129,7 +129,7 @@ ConstSharedArray< T >::ConstSharedArray( Uint size )
 {
     if ( 0 == size )
     {
-        CARAMEL_TRACE_FAIL_HERE( "Size can't be 0" );
+        CARAMEL_TRACE_ERROR_HERE( "Size can't be 0" );
         CARAMEL_INVALID_ARGUMENT();
     }
 
@@ -137,6 +137,14 @@ ConstSharedArray< T >::ConstSharedArray( Uint size )
 }
 
 
+template< typename T >
+const T& ConstSharedArray< T >::operator[]( Uint i ) const
+{
+    CARAMEL_ASSERT( i < m_size );
+    return m_array[i];
+}
+
+
 template< typename T >
 SharedArray< T >::SharedArray()
     : ConstSharedArray< T >()
@@ -151,6 +159,21 @@ SharedArray< T >::SharedArray ( Uint size )
 }
 
 
+template< typename T >
+T& SharedArray< T >::operator[]( Uint i )
+{
+    CARAMEL_ASSERT( i < this->m_size );
+    return this->m_array[i];
+}
+
+
+template< typename T >
+void SharedArray< T >::Reset( Uint size )
+{
+    *this = SharedArray( size );
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 
 } // namespace Caramel
@@ -48,6 +48,7 @@ ExceptionCatcherCore::ExceptionCatcherCore()
 void ExceptionCatcherCore::OnCatchCaramelException( const Exception& e )
 {
     m_caught = true;
+    m_exception = std::current_exception();
 
     CARAMEL_TRACE_ERROR( "Caramel::Exception caught, what: %s", e.What() );
 }
@@ -56,6 +57,7 @@ void ExceptionCatcherCore::OnCatchCaramelException( const Exception& e )
 void ExceptionCatcherCore::OnCatchStdException( const std::exception& e )
 {
     m_caught = true;
+    m_exception = std::current_exception();
 
     CARAMEL_TRACE_ERROR( "std::exception caught, what: %s", e.what() );
 }
@@ -64,6 +66,7 @@ void ExceptionCatcherCore::OnCatchStdException( const std::exception& e )
 void ExceptionCatcherCore::OnCatchUnknown()
 {
     m_caught = true;
+    m_exception = std::current_exception();
 
     CARAMEL_TRACE_ERROR( "Unknown exception caught" );
 }
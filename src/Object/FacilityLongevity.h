@@ -35,6 +35,8 @@ enum FacilityLongevity
     
     // Level 3
     FACILITY_LONGEVITY_SPRINTF          = FACILITY_LONGEVITY_LEVEL_3,
+    FACILITY_LONGEVITY_LOCK_CONTENTION  = FACILITY_LONGEVITY_LEVEL_3,
+    FACILITY_LONGEVITY_TASK             = FACILITY_LONGEVITY_LEVEL_3,
 };
 
 
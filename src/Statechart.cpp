@@ -30,7 +30,13 @@ namespace Statechart
 //
 
 StateMachine::StateMachine( const std::string& name )
-    : m_impl( new StateMachineImpl( name ))
+    : m_impl( new StateMachineImpl( name, nullptr ))
+{
+}
+
+
+StateMachine::StateMachine( const std::string& name, TaskExecutor& executor )
+    : m_impl( new StateMachineImpl( name, &executor ))
 {
 }
 
@@ -64,22 +70,22 @@ void StateMachine::Initiate( Int stateId )
     }
 
     Task task(
-        Sprintf( "Machine[%s].ProcessInitiate[%d]", m_impl->m_name, stateId ),
+        TaskName::Lazy( "Machine[%s].ProcessInitiate[%d]", m_impl->m_name, stateId ),
         [=] { m_impl->ProcessInitiate( initialState ); }
     );
 
-    m_impl->m_taskExecutor->Submit( task );
+    m_impl->m_strand->Submit( task );
 }
 
 
 void StateMachine::PostEvent( Int eventId )
 {
     Task task(
-        Sprintf( "Machine[%s].ProcessEvent[%d]", m_impl->m_name, eventId ),
+        TaskName::Lazy( "Machine[%s].ProcessEvent[%d]", m_impl->m_name, eventId ),
         [=] { m_impl->ProcessEvent( eventId ); }
     );
 
-    m_impl->m_taskExecutor->Submit( task );
+    m_impl->m_strand->Submit( task );
 }
 
 
@@ -105,20 +111,22 @@ Int StateMachine::GetCurrentStateId() const
 // Implementation
 //
 
-StateMachineImpl::StateMachineImpl( const std::string& name )
+StateMachineImpl::StateMachineImpl( const std::string& name, TaskExecutor* executor )
     : m_name( name )
-    , m_taskExecutor( nullptr )
-    , m_builtinTaskPoller( new TaskPoller )
     , m_transitNumber( 0 )
 {
-    m_taskExecutor = m_builtinTaskPoller.get();
+    if ( ! executor )
+    {
+        m_builtinTaskPoller.reset( new TaskPoller );
+        executor = m_builtinTaskPoller.get();
+    }
+
+    m_strand.reset( new Strand( *executor ));
 }
 
 
 void StateMachineImpl::ProcessInitiate( StatePtr initialState )
 {
-    auto ulock = UniqueLock( m_mutex );
-
     m_actionThreadId = ThisThread::GetId();
     auto guard = ScopeExit( [=] { m_actionThreadId = ThreadId(); } );
 
@@ -130,8 +138,6 @@ void StateMachineImpl::ProcessInitiate( StatePtr initialState )
 
 void StateMachineImpl::ProcessEvent( Int eventId )
 {
-    auto ulock = UniqueLock( m_mutex );
-
     m_actionThreadId = ThisThread::GetId();
     auto guard = ScopeExit( [=] { m_actionThreadId = ThreadId(); } );
 
@@ -152,7 +158,7 @@ void StateMachineImpl::ProcessEvent( Int eventId )
 
 void StateMachineImpl::DoTransit( StatePtr targetState )
 {
-    // REMARKS: At this point, the m_mutex should have been locked.
+    // REMARKS: Runs in the m_strand.
 
     this->ExitState();
 
@@ -261,6 +267,7 @@ State& State::Transition( Int eventId, Int targetStateId )
 StateImpl::StateImpl( Int stateId, const std::string& machineName )
     : m_id( stateId )
     , m_name( Sprintf( "Machine[%s].State[%d]", machineName, stateId ))
+    , m_autoTimerDuration( Ticks::Zero() )
 {
 }
 
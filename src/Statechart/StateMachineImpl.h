@@ -8,9 +8,9 @@
 #include "Statechart/StateImpl.h"
 #include <Caramel/Concurrent/HashMap.h>
 #include <Caramel/Statechart/StateMachine.h>
+#include <Caramel/Task/Strand.h>
 #include <Caramel/Task/TaskPoller.h>
 #include <Caramel/Thread/ThreadId.h>
-#include <mutex>
 
 
 namespace Caramel
@@ -30,7 +30,8 @@ class StateMachineImpl
 
 public:
 
-    explicit StateMachineImpl( const std::string& name );
+    // If executor is null, use the built-in TaskPoller.
+    StateMachineImpl( const std::string& name, TaskExecutor* executor );
 
     void ProcessInitiate( StatePtr initialState );
 
@@ -61,8 +62,10 @@ private:
 
     std::string m_name;
 
-    TaskExecutor* m_taskExecutor;
     std::unique_ptr< TaskPoller > m_builtinTaskPoller;
+
+    // All processing runs in this strand, one at a time without a lock.
+    std::unique_ptr< Strand > m_strand;
     
 
     typedef Concurrent::HashMap< Int, StatePtr > StateMap;
@@ -74,8 +77,6 @@ private:
     TickPoint m_currentStartTime;  // The start time of current state.
 
     ThreadId m_actionThreadId;
-
-    std::mutex m_mutex;
 };
 
 
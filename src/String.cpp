@@ -3,7 +3,6 @@
 #include "CaramelPch.h"
 
 #include "String/SprintfManager.h"
-#include <Caramel/Functional/ScopeExit.h>
 #include <Caramel/String/Algorithm.h>
 #include <Caramel/String/Sprintf.h>
 #include <Caramel/String/ToString.h>
@@ -49,8 +48,7 @@ namespace Detail
 
 std::string SprintfImpl( const Char* format, ... )
 {
-    SprintfBuffer* buffer = SprintfManager::Instance()->AllocateBuffer();
-    auto guard = ScopeExit( [ buffer ] { SprintfManager::Instance()->FreeBuffer( buffer ); } );
+    auto buffer = SprintfManager::Instance()->AllocateBuffer();
 
     Char* p = buffer->GetPointer();
 
@@ -132,40 +130,15 @@ Bool SprintfBuffer::CheckGuard() const
 //            Don't use these macros in Sprintf code.
 //
 
-SprintfManager::SprintfManager()
+SprintfManager::BufferPool::Handle SprintfManager::AllocateBuffer()
 {
-}
-
-
-SprintfManager::~SprintfManager()
-{
-    SprintfBuffer* buffer = nullptr;
-    while ( m_buffers.TryPop( buffer ))
-    {
-        delete buffer;
-    }
-}
-
-
-SprintfBuffer* SprintfManager::AllocateBuffer()
-{
-    SprintfBuffer* buffer = nullptr;
-    if ( ! m_buffers.TryPop( buffer ))
-    {
-        buffer = new SprintfBuffer;
-    }
+    auto buffer = m_buffers.Acquire();
 
     CARAMEL_ASSERT( buffer->CheckGuard() );
     return buffer;
 }
 
 
-void SprintfManager::FreeBuffer( SprintfBuffer* buffer )
-{
-    m_buffers.Push( buffer );
-}
-
-
 ///////////////////////////////////////////////////////////////////////////////
 //
 // UTF-8 String
@@ -6,7 +6,7 @@
 
 #include <Caramel/Caramel.h>
 #include "Object/FacilityLongevity.h"
-#include <Caramel/Concurrent/Queue.h>
+#include <Caramel/Object/Pool.h>
 #include <Caramel/Object/Singleton.h>
 
 
@@ -49,24 +49,26 @@ private:
 ///////////////////////////////////////////////////////////////////////////////
 //
 // Sprintf Manager
-// - Provide a cyclic list of buffers.
+// - Recycles the buffers by a Pool, the allocation takes no lock.
+//   At most MAX_CACHED_BUFFERS are kept in the depot of the pool,
+//   the excess ones are deleted when freed.
 //
 
 class SprintfManager : public Singleton< SprintfManager, FACILITY_LONGEVITY_SPRINTF >
 {
+    static const Uint MAX_CACHED_BUFFERS = 64;
+
 public:
 
-    SprintfManager();
-    ~SprintfManager();
+    typedef Pool< SprintfBuffer, MAX_CACHED_BUFFERS > BufferPool;
 
-    SprintfBuffer* AllocateBuffer();
-    void FreeBuffer( SprintfBuffer* buffer );
+    // The buffer returns to the pool when the handle is destroyed.
+    BufferPool::Handle AllocateBuffer();
 
 
 private:
 
-    typedef Concurrent::Queue< SprintfBuffer* > BufferQueue;
-    BufferQueue m_buffers;
+    BufferPool m_buffers;
 };
 
 
@@ -3,9 +3,22 @@
 #include "CaramelPch.h"
 
 #include "Task/TaskImpl.h"
+#include "Task/TaskManager.h"
 #include "Task/TaskPollerImpl.h"
+#include "Task/StrandImpl.h"
+#include "Task/TaskGraphImpl.h"
+#include "Task/TaskStealingPoolImpl.h"
+#include "Task/TaskThreadPoolImpl.h"
 #include <Caramel/Async/TimedBool.h>
 #include <Caramel/Chrono/SteadyClock.h>
+#include <Caramel/Error/CatchException.h>
+#include <Caramel/Functional/ScopeExit.h>
+#include <Caramel/Task/AsyncTask.h>
+#include <Caramel/Task/CancellationToken.h>
+#include <Caramel/Task/Parallel.h>
+#include <Caramel/Thread/ThisThread.h>
+#include <chrono>
+#include <thread>
 
 
 namespace Caramel
@@ -15,7 +28,14 @@ namespace Caramel
 // Contents
 //
 //   Task
+//   CancellationToken
 //   TaskPoller
+//   TaskThreadPool
+//   TaskStealingPool
+//   Strand
+//   TaskGraph
+//   AsyncTask
+//   Parallel Algorithms
 //
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -23,8 +43,13 @@ namespace Caramel
 // Task
 //
 
-Task::Task( const std::string& name, TaskFunction&& f )
-    : m_impl( new TaskImpl( name, std::move( f )))
+Task::Task()
+{
+}
+
+
+Task::Task( const TaskName& name, Detail::TaskCallable&& f )
+    : m_impl( std::allocate_shared< TaskImpl >( TaskAllocator< TaskImpl >(), name, std::move( f )))
 {
 }
 
@@ -36,14 +61,101 @@ Task& Task::DelayFor( const Ticks& duration )
 }
 
 
+Task& Task::Every( const Ticks& interval, TaskRepeatMode mode )
+{
+    m_impl->SetRepeat( interval, mode );
+    return *this;
+}
+
+
+Task& Task::WithPriority( TaskPriority priority )
+{
+    CARAMEL_ASSERT( TASK_PRIORITY_COUNT > priority );
+
+    m_impl->SetPriority( priority );
+    return *this;
+}
+
+
+Task& Task::WithCancellation( const CancellationToken& token )
+{
+    m_impl->SetCancellation( token.GetImpl() );
+    token.GetImpl()->AddTask( m_impl );
+    return *this;
+}
+
+
+Bool Task::Cancel()
+{
+    return m_impl ? m_impl->Cancel() : false;
+}
+
+
+void Task::OnCancelled( Detail::TaskCallable&& f )
+{
+    m_impl->SetCancelledHandler( std::move( f ));
+}
+
+
+const TaskName& Task::GetTaskName() const
+{
+    return m_impl->GetTaskName();
+}
+
+
+//
+// Properties
+//
+
+std::string Task::Name() const
+{
+    return m_impl ? m_impl->GetName() : std::string();
+}
+
+
+TaskPriority Task::Priority() const
+{
+    return m_impl ? m_impl->GetPriority() : TASK_PRIORITY_NORMAL;
+}
+
+
+Bool Task::IsEmpty() const
+{
+    return ! m_impl;
+}
+
+
+Bool Task::IsCompleted() const
+{
+    return m_impl && m_impl->IsCompleted();
+}
+
+
+Bool Task::IsRepeating() const
+{
+    return m_impl && m_impl->IsRepeating();
+}
+
+
+Bool Task::IsCancelled() const
+{
+    return m_impl && m_impl->IsCancelled();
+}
+
+
 //
 // Implementation
 //
 
-TaskImpl::TaskImpl( const std::string& name, TaskFunction&& f )
+TaskImpl::TaskImpl( const TaskName& name, Detail::TaskCallable&& f )
     : m_name( name )
-    , m_function( f )
+    , m_function( std::move( f ))
     , m_delayed( false )
+    , m_repeating( false )
+    , m_repeatMode( TASK_REPEAT_FIXED_RATE )
+    , m_priority( TASK_PRIORITY_NORMAL )
+    , m_state( STATE_PENDING )
+    , m_delayTimerId( 0 )
 {
 }
 
@@ -57,9 +169,260 @@ void TaskImpl::DelayFor( const Ticks& duration )
 }
 
 
-void TaskImpl::Run()
+void TaskImpl::ResetDelay( const Ticks& duration )
+{
+    m_delayDuration = duration;
+    m_delayed = Ticks::Zero() < duration;
+}
+
+
+void TaskImpl::SetRepeat( const Ticks& interval, TaskRepeatMode mode )
 {
+    if ( Ticks::Zero() >= interval )
+    {
+        CARAMEL_THROW( "Repeat interval must be positive, task: %s", m_name.ToString() );
+    }
+
+    m_repeatInterval = interval;
+    m_repeatMode = mode;
+    m_repeating = true;
+}
+
+
+TickPoint TaskImpl::FirstDueTime( const TickPoint& now )
+{
+    m_dueTime = now + ( m_delayed ? m_delayDuration : m_repeatInterval );
+    return m_dueTime;
+}
+
+
+TickPoint TaskImpl::NextDueTime( const TickPoint& now )
+{
+    CARAMEL_ASSERT( m_repeating );
+
+    switch ( m_repeatMode )
+    {
+    case TASK_REPEAT_FIXED_DELAY:
+        m_dueTime = now + m_repeatInterval;
+        break;
+
+    case TASK_REPEAT_FIXED_RATE_CATCH_UP:
+        m_dueTime += m_repeatInterval;
+        break;
+
+    default:
+        m_dueTime += m_repeatInterval;
+
+        // Skip the missed ticks, but stay on the grid.
+        if ( m_dueTime <= now )
+        {
+            const Int64 missed = ( now - m_dueTime ).count() / m_repeatInterval.count() + 1;
+            m_dueTime += Ticks( missed * m_repeatInterval.count() );
+        }
+        break;
+    }
+
+    return m_dueTime;
+}
+
+
+void TaskImpl::SetCancellation( CancellationTokenPtr token )
+{
+    CARAMEL_ASSERT( ! m_token );
+
+    m_token = token;
+}
+
+
+void TaskImpl::Resubmit()
+{
+    Int completed = STATE_COMPLETED;
+    m_state.compare_exchange_strong( completed, STATE_PENDING );
+}
+
+
+Bool TaskImpl::Run()
+{
+    if ( m_token && m_token->IsCancelled() )
+    {
+        Int pending = STATE_PENDING;
+
+        if ( m_state.compare_exchange_strong( pending, STATE_CANCELLED ) && ! m_cancelledHandler.IsEmpty() )
+        {
+            m_cancelledHandler();
+        }
+        return false;
+    }
+
+    // A completed task may be submitted again, see Resubmit().
+
+    Int state = m_state.load();
+    do
+    {
+        if ( STATE_CANCELLED == state ) { return false; }
+    }
+    while ( ! m_state.compare_exchange_weak( state, STATE_RUNNING ));
+
+    auto done = ScopeExit( [this]
+    {
+        // Unless it is cancelled during running.
+        // A repeating task is pending again for its next run.
+        Int running = STATE_RUNNING;
+        m_state.compare_exchange_strong( running, m_repeating ? STATE_PENDING : STATE_COMPLETED );
+    });
+
     m_function();
+    return true;
+}
+
+
+Bool TaskImpl::Cancel()
+{
+    // Only a pending task, or a running repeating one, can be cancelled.
+    // A completed task stays completed, it may be submitted again.
+
+    Int oldState = m_state.load();
+    do
+    {
+        if ( STATE_CANCELLED == oldState || STATE_COMPLETED == oldState ) { return false; }
+
+        // A running task completes anyway.
+        if ( STATE_RUNNING == oldState && ! m_repeating ) { return false; }
+    }
+    while ( ! m_state.compare_exchange_weak( oldState, STATE_CANCELLED ));
+
+    // A repeating task stops after this run.
+    if ( STATE_RUNNING == oldState ) { return true; }
+
+    // Drop it from the executor's timing wheel, if it is delayed there.
+
+    std::weak_ptr< DelayedTaskHost > host;
+    Uint64 timerId = 0;
+    {
+        SpinMutex::ScopedLock lock( m_delayHostMutex );
+        host = m_delayHost;
+        timerId = m_delayTimerId;
+    }
+
+    if ( auto delayHost = host.lock() )
+    {
+        delayHost->CancelDelayed( timerId, m_repeating );
+    }
+
+    if ( ! m_cancelledHandler.IsEmpty() )
+    {
+        m_cancelledHandler();
+    }
+
+    return true;
+}
+
+
+void TaskImpl::AttachDelayed( const std::weak_ptr< DelayedTaskHost >& host, Uint64 timerId )
+{
+    SpinMutex::ScopedLock lock( m_delayHostMutex );
+
+    m_delayHost = host;
+    m_delayTimerId = timerId;
+}
+
+
+Bool TaskImpl::IsCancelled() const
+{
+    return STATE_CANCELLED == m_state || ( m_token && m_token->IsCancelled() );
+}
+
+
+Bool TaskImpl::IsCompleted() const
+{
+    return STATE_COMPLETED == m_state || this->IsCancelled();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Cancellation Token
+//
+
+CancellationToken::CancellationToken()
+    : m_impl( new CancellationTokenImpl )
+{
+}
+
+
+void CancellationToken::Cancel()
+{
+    m_impl->Cancel();
+}
+
+
+Bool CancellationToken::IsCancelled() const
+{
+    return m_impl->IsCancelled();
+}
+
+
+//
+// Implementation
+//
+
+CancellationTokenImpl::CancellationTokenImpl()
+    : m_cancelled( false )
+    , m_pruneSize( 16 )
+{
+}
+
+
+void CancellationTokenImpl::Cancel()
+{
+    std::vector< std::weak_ptr< TaskImpl > > tasks;
+    {
+        auto ulock = UniqueLock( m_mutex );
+
+        if ( m_cancelled ) { return; }
+        m_cancelled = true;
+
+        tasks.swap( m_tasks );
+    }
+
+    for ( Uint i = 0; i < tasks.size(); ++ i )
+    {
+        if ( auto task = tasks[i].lock() )
+        {
+            task->Cancel();
+        }
+    }
+}
+
+
+void CancellationTokenImpl::AddTask( const std::shared_ptr< TaskImpl >& task )
+{
+    {
+        auto ulock = UniqueLock( m_mutex );
+
+        if ( ! m_cancelled )
+        {
+            m_tasks.push_back( task );
+
+            if ( m_tasks.size() >= m_pruneSize )
+            {
+                m_tasks.erase(
+                    std::remove_if( m_tasks.begin(), m_tasks.end(),
+                        [] ( const std::weak_ptr< TaskImpl >& t )
+                        {
+                            auto p = t.lock();
+                            return ! p || p->IsCompleted();
+                        }),
+                    m_tasks.end()
+                );
+
+                m_pruneSize = std::max( m_tasks.size() * 2, std::size_t( 16 ));
+            }
+            return;
+        }
+    }
+
+    task->Cancel();
 }
 
 
@@ -74,19 +437,27 @@ TaskPoller::TaskPoller()
 }
 
 
+TaskCounters TaskPoller::GetCounters() const
+{
+    TaskCounters counters;
+    counters.runCount = m_impl->m_runCount;
+    counters.cancelledCount = m_impl->m_cancelledCount;
+    return counters;
+}
+
+
 void TaskPoller::Submit( const Task& inputTask )
 {
     TaskPtr task = inputTask.GetImpl();
+    task->Resubmit();
 
     if ( task->IsDelayed() )
     {
-        const TickPoint dueTime = TickClock::Now() + task->GetDelayDuration();
-
-        m_impl->m_delayedTasks.Push( dueTime, task );
+        m_impl->ScheduleDelayed( task, task->FirstDueTime( TickClock::Now() ));
     }
     else
     {
-        m_impl->m_readyTasks.Push( task );
+        m_impl->PushReady( task );
     }
 }
 
@@ -99,28 +470,1900 @@ void TaskPoller::PollOne()
 
 void TaskPoller::PollFor( const Ticks& sliceTicks )
 {
-    while ( ! m_impl->m_delayedTasks.IsEmpty() )
+    m_impl->PollFor( sliceTicks );
+}
+
+
+Bool TaskPoller::WaitAndPollFor( const Ticks& maxWait, const Ticks& sliceTicks )
+{
+    const TickPoint deadline = TickClock::Now() + maxWait;
+
+    for ( ;; )
+    {
+        if ( m_impl->HasReadyTasks() || m_impl->HasDueTasks() )
+        {
+            // The ready ones may be taken by another polling thread.
+            if ( 0 < m_impl->PollFor( sliceTicks )) { return true; }
+        }
+
+        if ( TickClock::Now() >= deadline ) { return false; }
+
+        m_impl->WaitForWork( deadline );
+    }
+}
+
+
+TaskLaneStats TaskPoller::GetLaneStats( TaskPriority priority ) const
+{
+    CARAMEL_ASSERT( TASK_PRIORITY_COUNT > priority );
+
+    const TaskPollerImpl::Lane& lane = m_impl->m_lanes[ priority ];
+
+    TaskLaneStats stats;
+    stats.queueDepth    = lane.depth;
+    stats.dequeuedCount = lane.dequeuedCount;
+    stats.totalWait     = Seconds( boost::chrono::nanoseconds( lane.totalWaitNanos.load() ));
+    stats.maxWait       = Seconds( boost::chrono::nanoseconds( lane.maxWaitNanos.load() ));
+    return stats;
+}
+
+
+//
+// Implementation
+//
+
+namespace Detail
+{
+
+// Turns of each lane in a round, see TaskPoller.h
+static const Int POLLER_LANE_WEIGHTS[ TASK_PRIORITY_COUNT ] = { 8, 4, 1 };
+
+} // namespace Detail
+
+
+TaskPollerImpl::TaskPollerImpl()
+    : m_delayedCount( 0 )
+    , m_waitingCount( 0 )
+    , m_runCount( 0 )
+    , m_cancelledCount( 0 )
+{
+}
+
+
+Uint TaskPollerImpl::PollFor( const Ticks& sliceTicks )
+{
+    if ( 0 < m_delayedCount )
     {
-        TickPoint dueTime;
-        m_impl->m_delayedTasks.PeekTopKey( dueTime );
+        std::vector< TaskPtr > dueTasks;
+        {
+            auto ulock = UniqueLock( m_delayedMutex );
 
-        if ( TickClock::Now() < dueTime ) { break; }
+            m_delayedTasks.PopAllUntil( TickClock::Now(), dueTasks );
+            m_delayedCount = m_delayedTasks.Size();
+        }
 
-        TaskPtr readyTask;
-        m_impl->m_delayedTasks.TryPop( readyTask );
-        m_impl->m_readyTasks.Push( readyTask );
+        for ( Uint i = 0; i < dueTasks.size(); ++ i )
+        {
+            this->PushReady( dueTasks[i] );
+        }
     }
 
     TimedBool< TickClock > sliceTimeout( sliceTicks );
 
     TaskPtr task;
+    Uint polledCount = 0;
 
-    while ( m_impl->m_readyTasks.TryPop( task ))
+    while ( this->PopReady( task ))
     {
-        task->Run();
+        ++ polledCount;
+
+        // Cancelled tasks are dropped, not counted in the slice.
+        if ( ! this->RunTask( task )) { continue; }
+
+        if ( task->IsRepeating() && ! task->IsCancelled() )
+        {
+            this->ScheduleDelayed( task, task->NextDueTime( TickClock::Now() ));
+        }
 
         if ( sliceTimeout ) { break; }
     }
+
+    return polledCount;
+}
+
+
+void TaskPollerImpl::ScheduleDelayed( const TaskPtr& task, const TickPoint& dueTime )
+{
+    {
+        auto ulock = UniqueLock( m_delayedMutex );
+
+        const Uint64 timerId = m_delayedTasks.Schedule( dueTime, task );
+        task->AttachDelayed( shared_from_this(), timerId );
+
+        // Cancelled before attached, it doesn't see this poller.
+        if ( task->IsCancelled() )
+        {
+            m_delayedTasks.Cancel( timerId );
+            ++ m_cancelledCount;
+            return;
+        }
+
+        m_delayedCount = m_delayedTasks.Size();
+    }
+
+    // The earliest due time may change, the waiting threads check it again.
+    this->WakeWaiting();
+}
+
+
+Bool TaskPollerImpl::HasReadyTasks() const
+{
+    for ( Uint i = 0; i < TASK_PRIORITY_COUNT; ++ i )
+    {
+        if ( 0 < m_lanes[i].depth ) { return true; }
+    }
+    return false;
+}
+
+
+Bool TaskPollerImpl::HasDueTasks()
+{
+    if ( 0 == m_delayedCount ) { return false; }
+
+    auto ulock = UniqueLock( m_delayedMutex );
+
+    TickPoint nextTime;
+    return m_delayedTasks.GetNextAdvanceTime( nextTime ) && nextTime <= TickClock::Now();
+}
+
+
+void TaskPollerImpl::WaitForWork( const TickPoint& deadline )
+{
+    auto ulock = UniqueLock( m_waitMutex );
+
+    // Pairs with the check in WakeWaiting(), either this thread sees
+    // the new work, or the submitting thread sees the waiting count.
+    ++ m_waitingCount;
+
+    TickPoint wakeTime = deadline;
+
+    if ( ! this->HasReadyTasks() )
+    {
+        if ( 0 < m_delayedCount )
+        {
+            auto dlock = UniqueLock( m_delayedMutex );
+
+            TickPoint nextTime;
+            if ( m_delayedTasks.GetNextAdvanceTime( nextTime ) && nextTime < wakeTime )
+            {
+                wakeTime = nextTime;
+            }
+        }
+
+        const Ticks untilWake = wakeTime - TickClock::Now();
+
+        if ( Ticks::Zero() < untilWake )
+        {
+            m_workReady.wait_for( ulock, std::chrono::milliseconds( untilWake.ToInt64() ));
+        }
+    }
+
+    -- m_waitingCount;
+}
+
+
+void TaskPollerImpl::WakeWaiting()
+{
+    if ( 0 == m_waitingCount ) { return; }
+
+    { auto ulock = UniqueLock( m_waitMutex ); }
+    m_workReady.notify_all();
+}
+
+
+void TaskPollerImpl::CancelDelayed( Uint64 timerId, Bool )
+{
+    {
+        auto ulock = UniqueLock( m_delayedMutex );
+
+        if ( ! m_delayedTasks.Cancel( timerId )) { return; }
+
+        m_delayedCount = m_delayedTasks.Size();
+    }
+
+    ++ m_cancelledCount;
+}
+
+
+void TaskPollerImpl::PushReady( const TaskPtr& task )
+{
+    Lane& lane = m_lanes[ task->GetPriority() ];
+
+    ReadyTask ready;
+    ready.task = task;
+    ready.readyTime = HighResClock::now();
+
+    ++ lane.depth;
+    lane.Push( std::move( ready ));
+
+    this->WakeWaiting();
+}
+
+
+Bool TaskPollerImpl::PopReady( TaskPtr& task )
+{
+    ReadyTask ready;
+    Lane* lane = nullptr;
+
+    // Higher lanes first, within their turns of this round.
+    // The round goes on across the slices, see TaskPoller.h
+
+    for ( Uint i = 0; i < TASK_PRIORITY_COUNT; ++ i )
+    {
+        if ( 0 < m_lanes[i].credits && m_lanes[i].TryPop( ready ))
+        {
+            lane = &m_lanes[i];
+            -- lane->credits;
+            break;
+        }
+    }
+
+    // The lanes with turns left are empty, start a new round.
+
+    if ( ! lane )
+    {
+        for ( Uint i = 0; i < TASK_PRIORITY_COUNT; ++ i )
+        {
+            m_lanes[i].credits = Detail::POLLER_LANE_WEIGHTS[i];
+        }
+
+        for ( Uint i = 0; i < TASK_PRIORITY_COUNT; ++ i )
+        {
+            if ( m_lanes[i].TryPop( ready ))
+            {
+                lane = &m_lanes[i];
+                -- lane->credits;
+                break;
+            }
+        }
+
+        if ( ! lane ) { return false; }
+    }
+
+    -- lane->depth;
+
+    const auto wait = HighResClock::now() - ready.readyTime;
+    lane->RecordWait( boost::chrono::duration_cast< boost::chrono::nanoseconds >( wait ).count() );
+
+    task = std::move( ready.task );
+    return true;
+}
+
+
+TaskPollerImpl::Lane::Lane()
+    : depth( 0 )
+    , credits( 0 )
+    , dequeuedCount( 0 )
+    , totalWaitNanos( 0 )
+    , maxWaitNanos( 0 )
+{
+}
+
+
+void TaskPollerImpl::Lane::Push( ReadyTask&& ready )
+{
+    auto ulock = UniqueLock( mutex );
+
+    if ( tasks.full() )
+    {
+        tasks.set_capacity( std::max< std::size_t >( 16, tasks.capacity() * 2 ));
+    }
+
+    tasks.push_back( std::move( ready ));
+}
+
+
+Bool TaskPollerImpl::Lane::TryPop( ReadyTask& ready )
+{
+    auto ulock = UniqueLock( mutex );
+
+    if ( tasks.empty() ) { return false; }
+
+    ready = std::move( tasks.front() );
+    tasks.pop_front();
+    return true;
+}
+
+
+void TaskPollerImpl::Lane::RecordWait( Int64 waitNanos )
+{
+    ++ dequeuedCount;
+    totalWaitNanos += waitNanos;
+
+    Int64 maxWait = maxWaitNanos.load( std::memory_order_relaxed );
+
+    while ( waitNanos > maxWait
+         && ! maxWaitNanos.compare_exchange_weak( maxWait, waitNanos, std::memory_order_relaxed ))
+    {
+    }
+}
+
+
+Bool TaskPollerImpl::RunTask( const TaskPtr& task )
+{
+    if ( task->Run() )
+    {
+        ++ m_runCount;
+        return true;
+    }
+
+    ++ m_cancelledCount;
+    return false;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Thread Pool
+//
+
+TaskThreadPool::TaskThreadPool( const std::string& name, Uint numThreads )
+    : m_impl( new TaskThreadPoolImpl( name, numThreads ))
+{
+}
+
+
+TaskThreadPool::~TaskThreadPool()
+{
+    m_impl->Shutdown();
+}
+
+
+void TaskThreadPool::Submit( const Task& task )
+{
+    task.GetImpl()->Resubmit();
+    m_impl->Submit( task.GetImpl() );
+}
+
+
+void TaskThreadPool::Drain()
+{
+    m_impl->Drain();
+}
+
+
+void TaskThreadPool::Shutdown()
+{
+    m_impl->Shutdown();
+}
+
+
+Uint TaskThreadPool::GetThreadCount() const
+{
+    return static_cast< Uint >( m_impl->m_workers.size() );
+}
+
+
+TaskCounters TaskThreadPool::GetCounters() const
+{
+    TaskCounters counters;
+    counters.runCount = m_impl->m_runCount;
+    counters.cancelledCount = m_impl->m_cancelledCount;
+    return counters;
+}
+
+
+//
+// Implementation
+//
+
+TaskThreadPoolImpl::TaskThreadPoolImpl( const std::string& name, Uint numThreads )
+    : m_name( name )
+    , m_pendingCount( 0 )
+    , m_shuttingDown( false )
+    , m_stopping( false )
+    , m_joined( false )
+    , m_runCount( 0 )
+    , m_cancelledCount( 0 )
+{
+    if ( 0 == numThreads )
+    {
+        numThreads = std::max( std::thread::hardware_concurrency(), 1u );
+    }
+
+    for ( Uint i = 0; i < numThreads; ++ i )
+    {
+        m_workers.push_back( std::unique_ptr< Thread >(
+            new Thread( Sprintf( "%s[%u]", m_name, i ), [=] { this->RunWorker(); } )
+        ));
+    }
+}
+
+
+void TaskThreadPoolImpl::Submit( TaskPtr task )
+{
+    {
+        auto ulock = UniqueLock( m_mutex );
+
+        if ( m_stopping )
+        {
+            CARAMEL_THROW( "Thread pool %s has been shut down, task: %s", m_name, task->GetName() );
+        }
+
+        if ( task->IsDelayed() )
+        {
+            // A repeating task is pending only when it is due.
+            if ( this->ScheduleDelayed( task, task->FirstDueTime( TickClock::Now() ))
+              && ! task->IsRepeating() )
+            {
+                ++ m_pendingCount;
+            }
+        }
+        else
+        {
+            ++ m_pendingCount;
+            m_readyTasks.push_back( task );
+        }
+    }
+
+    // A delayed task also wakes a worker, to wait for the new earliest due time.
+    m_taskReady.notify_one();
+}
+
+
+void TaskThreadPoolImpl::Drain()
+{
+    auto ulock = UniqueLock( m_mutex );
+
+    while ( 0 < m_pendingCount )
+    {
+        m_drained.wait( ulock );
+    }
+}
+
+
+void TaskThreadPoolImpl::Shutdown()
+{
+    // A worker would wait for itself.
+    if ( this->IsWorkerThread() )
+    {
+        CARAMEL_THROW( "Thread pool %s can't be shut down by its own task", m_name );
+    }
+
+    {
+        auto ulock = UniqueLock( m_mutex );
+
+        m_shuttingDown = true;
+
+        // Wait for the ready tasks only.
+        // The running ones may still submit or repeat delayed tasks.
+
+        for ( ;; )
+        {
+            if ( ! m_delayedTasks.IsEmpty() )
+            {
+                this->CancelAllDelayed( ulock );
+                continue;
+            }
+
+            if ( 0 == m_pendingCount ) { break; }
+
+            m_drained.wait( ulock );
+        }
+
+        m_stopping = true;
+
+        if ( m_joined ) { return; }
+        m_joined = true;
+    }
+
+    m_taskReady.notify_all();
+
+    for ( Uint i = 0; i < m_workers.size(); ++ i )
+    {
+        m_workers[i]->Join();
+    }
+}
+
+
+void TaskThreadPoolImpl::RunWorker()
+{
+    TaskPtr task;
+
+    for ( ;; )
+    {
+        {
+            auto ulock = UniqueLock( m_mutex );
+
+            if ( ! this->WaitReadyTask( ulock, task )) { return; }
+        }
+
+        Bool ran = true;
+
+        auto xc = CatchException( [&] { ran = task->Run(); } );
+        if ( xc )
+        {
+            CARAMEL_TRACE_WARN( "Task throws, pool: %s, task: %s", m_name, task->GetName() );
+        }
+
+        ++ ( ran ? m_runCount : m_cancelledCount );
+
+        Bool drained = false;
+        {
+            auto ulock = UniqueLock( m_mutex );
+
+            if ( ran && task->IsRepeating() && ! task->IsCancelled() && ! m_stopping )
+            {
+                this->ScheduleDelayed( task, task->NextDueTime( TickClock::Now() ));
+            }
+
+            drained = ( 0 == -- m_pendingCount );
+        }
+
+        // Wake a worker to wait for the new earliest due time.
+        if ( task->IsRepeating() )
+        {
+            m_taskReady.notify_one();
+        }
+
+        task.reset();
+
+        if ( drained )
+        {
+            m_drained.notify_all();
+        }
+    }
+}
+
+
+Bool TaskThreadPoolImpl::WaitReadyTask( std::unique_lock< std::mutex >& ulock, TaskPtr& task )
+{
+    for ( ;; )
+    {
+        if ( ! m_delayedTasks.IsEmpty() )
+        {
+            this->PromoteDueTasks( TickClock::Now() );
+        }
+
+        if ( ! m_readyTasks.empty() )
+        {
+            task = std::move( m_readyTasks.front() );
+            m_readyTasks.pop_front();
+            return true;
+        }
+
+        if ( m_stopping ) { return false; }
+
+        TickPoint nextTime;
+
+        if ( ! m_delayedTasks.GetNextAdvanceTime( nextTime ))
+        {
+            m_taskReady.wait( ulock );
+        }
+        else
+        {
+            const Ticks untilNext = nextTime - TickClock::Now();
+            m_taskReady.wait_for( ulock, std::chrono::milliseconds( untilNext.ToInt64() ));
+        }
+    }
+}
+
+
+Bool TaskThreadPoolImpl::ScheduleDelayed( const TaskPtr& task, const TickPoint& dueTime )
+{
+    const Uint64 timerId = m_delayedTasks.Schedule( dueTime, task );
+    task->AttachDelayed( shared_from_this(), timerId );
+
+    // Cancelled before attached, it doesn't see this pool.
+    if ( task->IsCancelled() )
+    {
+        m_delayedTasks.Cancel( timerId );
+        ++ m_cancelledCount;
+        return false;
+    }
+
+    // Let Shutdown() cancel it.
+    if ( m_shuttingDown )
+    {
+        m_drained.notify_all();
+    }
+
+    return true;
+}
+
+
+void TaskThreadPoolImpl::CancelDelayed( Uint64 timerId, Bool repeating )
+{
+    Bool drained = false;
+    {
+        auto ulock = UniqueLock( m_mutex );
+
+        if ( ! m_delayedTasks.Cancel( timerId )) { return; }
+
+        ++ m_cancelledCount;
+
+        if ( repeating ) { return; }
+
+        drained = ( 0 == -- m_pendingCount );
+    }
+
+    if ( drained )
+    {
+        m_drained.notify_all();
+    }
+}
+
+
+void TaskThreadPoolImpl::PromoteDueTasks( const TickPoint& now )
+{
+    const std::size_t readyCount = m_readyTasks.size();
+
+    m_delayedTasks.PopAllUntil( now, m_readyTasks );
+
+    const std::size_t promoted = m_readyTasks.size() - readyCount;
+
+    for ( std::size_t i = readyCount; i < m_readyTasks.size(); ++ i )
+    {
+        if ( m_readyTasks[i]->IsRepeating() ) { ++ m_pendingCount; }
+    }
+
+    // This worker takes one, wake the others for the rest.
+    if ( 1 < promoted )
+    {
+        m_taskReady.notify_all();
+    }
+}
+
+
+void TaskThreadPoolImpl::CancelAllDelayed( std::unique_lock< std::mutex >& ulock )
+{
+    std::vector< TaskPtr > tasks;
+    m_delayedTasks.PopAll( tasks );
+
+    ulock.unlock();
+
+    // The timers are gone, Cancel() won't come back to this pool.
+    // Count them here even if they have been cancelled by other threads.
+
+    Uint pendingCount = 0;
+
+    for ( Uint i = 0; i < tasks.size(); ++ i )
+    {
+        tasks[i]->Cancel();
+
+        // A repeating task is pending only when it is due.
+        if ( ! tasks[i]->IsRepeating() ) { ++ pendingCount; }
+    }
+
+    m_cancelledCount += tasks.size();
+    tasks.clear();
+
+    ulock.lock();
+
+    m_pendingCount -= pendingCount;
+
+    if ( 0 == m_pendingCount )
+    {
+        m_drained.notify_all();
+    }
+}
+
+
+Bool TaskThreadPoolImpl::IsWorkerThread() const
+{
+    const ThreadId threadId = ThisThread::GetId();
+
+    for ( Uint i = 0; i < m_workers.size(); ++ i )
+    {
+        if ( threadId == m_workers[i]->GetId() ) { return true; }
+    }
+
+    return false;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Stealing Pool
+//
+
+TaskStealingPool::TaskStealingPool( const std::string& name, Uint numThreads )
+    : m_impl( new TaskStealingPoolImpl( name, numThreads ))
+{
+}
+
+
+TaskStealingPool::~TaskStealingPool()
+{
+    m_impl->Shutdown();
+}
+
+
+void TaskStealingPool::Submit( const Task& task )
+{
+    task.GetImpl()->Resubmit();
+    m_impl->Submit( task.GetImpl() );
+}
+
+
+void TaskStealingPool::Drain()
+{
+    m_impl->Drain();
+}
+
+
+void TaskStealingPool::Shutdown()
+{
+    m_impl->Shutdown();
+}
+
+
+Uint TaskStealingPool::GetThreadCount() const
+{
+    return static_cast< Uint >( m_impl->m_workers.size() );
+}
+
+
+TaskCounters TaskStealingPool::GetCounters() const
+{
+    TaskCounters counters;
+    counters.runCount = m_impl->m_runCount;
+    counters.cancelledCount = m_impl->m_cancelledCount;
+    return counters;
+}
+
+
+//
+// Implementation
+//
+
+namespace Detail
+{
+
+// A worker takes at most this number of tasks from the global queue at once.
+static const Uint STEALING_POOL_GLOBAL_BATCH = 32;
+
+// Check the global queue every this number of local tasks,
+// so the externally submitted tasks would not starve.
+static const Uint STEALING_POOL_GLOBAL_INTERVAL = 61;
+
+} // namespace Detail
+
+
+TaskStealingPoolImpl::TaskStealingPoolImpl( const std::string& name, Uint numThreads )
+    : m_name( name )
+    , m_globalCount( 0 )
+    , m_nextDueTicks( TickPoint::MaxValue().time_since_epoch().count() )
+    , m_sleepingCount( 0 )
+    , m_pendingCount( 0 )
+    , m_startedCount( 0 )
+    , m_shuttingDown( false )
+    , m_stopping( false )
+    , m_joined( false )
+    , m_runCount( 0 )
+    , m_cancelledCount( 0 )
+{
+    if ( 0 == numThreads )
+    {
+        numThreads = std::max( std::thread::hardware_concurrency(), 1u );
+    }
+
+    // All workers exist before any of them runs, since they look at each other.
+
+    for ( Uint i = 0; i < numThreads; ++ i )
+    {
+        m_workers.push_back( std::unique_ptr< Worker >( new Worker ));
+        m_workers[i]->random = i * 0x9E3779B9u + 1;
+    }
+
+    for ( Uint i = 0; i < numThreads; ++ i )
+    {
+        m_workers[i]->thread.Start( Sprintf( "%s[%u]", m_name, i ), [=] { this->RunWorker( i ); } );
+    }
+
+    auto ulock = UniqueLock( m_mutex );
+
+    while ( numThreads > m_startedCount )
+    {
+        m_started.wait( ulock );
+    }
+}
+
+
+void TaskStealingPoolImpl::Submit( TaskPtr task )
+{
+    Worker* self = task->IsDelayed() ? nullptr : this->FindCurrentWorker();
+
+    if ( self )
+    {
+        // Submitted by a running task, push to the local deque.
+        // The pool can't be stopped while a task is running.
+
+        ++ m_pendingCount;
+
+        self->tasks.PushBottom( this->HoldTask( task ));
+
+        // Pairs with the fence in Sleep(), either the sleeping worker
+        // sees this task, or this thread sees the sleeping count.
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+
+        if ( 0 < m_sleepingCount.load( std::memory_order_relaxed ))
+        {
+            { auto ulock = UniqueLock( m_mutex ); }
+            m_taskReady.notify_one();
+        }
+        return;
+    }
+
+    {
+        auto ulock = UniqueLock( m_mutex );
+
+        if ( m_stopping )
+        {
+            CARAMEL_THROW( "Thread pool %s has been shut down, task: %s", m_name, task->GetName() );
+        }
+
+        if ( task->IsDelayed() )
+        {
+            // A repeating task is pending only when it is due.
+            if ( this->ScheduleDelayed( task, task->FirstDueTime( TickClock::Now() ))
+              && ! task->IsRepeating() )
+            {
+                ++ m_pendingCount;
+            }
+        }
+        else
+        {
+            ++ m_pendingCount;
+            m_globalTasks.push_back( this->HoldTask( task ));
+            ++ m_globalCount;
+        }
+    }
+
+    // A delayed task also wakes a worker, to wait for the new earliest due time.
+    m_taskReady.notify_one();
+}
+
+
+void TaskStealingPoolImpl::Drain()
+{
+    auto ulock = UniqueLock( m_mutex );
+
+    while ( 0 < m_pendingCount )
+    {
+        m_drained.wait( ulock );
+    }
+}
+
+
+void TaskStealingPoolImpl::Shutdown()
+{
+    // A worker would wait for itself.
+    if ( this->FindCurrentWorker() )
+    {
+        CARAMEL_THROW( "Thread pool %s can't be shut down by its own task", m_name );
+    }
+
+    {
+        auto ulock = UniqueLock( m_mutex );
+
+        m_shuttingDown = true;
+
+        // Wait for the ready tasks only.
+        // The running ones may still submit or repeat delayed tasks.
+
+        for ( ;; )
+        {
+            if ( ! m_delayedTasks.IsEmpty() )
+            {
+                this->CancelAllDelayed( ulock );
+                continue;
+            }
+
+            if ( 0 == m_pendingCount ) { break; }
+
+            m_drained.wait( ulock );
+        }
+
+        m_stopping = true;
+
+        if ( m_joined ) { return; }
+        m_joined = true;
+    }
+
+    m_taskReady.notify_all();
+
+    for ( Uint i = 0; i < m_workers.size(); ++ i )
+    {
+        m_workers[i]->thread.Join();
+    }
+}
+
+
+void TaskStealingPoolImpl::RunWorker( Uint index )
+{
+    Worker& self = *m_workers[ index ];
+
+    {
+        auto ulock = UniqueLock( m_mutex );
+
+        self.threadId = std::this_thread::get_id();
+        ++ m_startedCount;
+    }
+
+    m_started.notify_all();
+
+    Uint localRuns = 0;
+
+    for ( ;; )
+    {
+        TaskHolder holder = nullptr;
+
+        if ( 0 == ( ++ localRuns % Detail::STEALING_POOL_GLOBAL_INTERVAL ))
+        {
+            holder = this->TakeGlobal( self );
+        }
+
+        if ( holder
+          || self.tasks.PopBottom( holder )
+          || ( holder = this->TakeGlobal( self ))
+          || ( holder = this->Steal( self )))
+        {
+            this->RunTask( holder );
+            continue;
+        }
+
+        if ( ! this->Sleep() ) { return; }
+    }
+}
+
+
+auto TaskStealingPoolImpl::FindCurrentWorker() -> Worker*
+{
+    // No thread-local storage here, the workers are few.
+
+    const std::thread::id threadId = std::this_thread::get_id();
+
+    for ( Uint i = 0; i < m_workers.size(); ++ i )
+    {
+        if ( threadId == m_workers[i]->threadId ) { return m_workers[i].get(); }
+    }
+
+    return nullptr;
+}
+
+
+auto TaskStealingPoolImpl::TakeGlobal( Worker& self ) -> TaskHolder
+{
+    const Int64 nowTicks = TickClock::Now().time_since_epoch().count();
+
+    if ( 0 == m_globalCount && nowTicks < m_nextDueTicks ) { return nullptr; }
+
+    auto ulock = UniqueLock( m_mutex );
+
+    this->PromoteDueTasks( TickClock::Now() );
+
+    if ( m_globalTasks.empty() ) { return nullptr; }
+
+    TaskHolder holder = m_globalTasks.front();
+    m_globalTasks.pop_front();
+
+    // Take a fair share of the rest into the local deque.
+
+    const Uint share = std::min(
+        static_cast< Uint >( m_globalTasks.size() / m_workers.size() ), Detail::STEALING_POOL_GLOBAL_BATCH );
+
+    for ( Uint i = 0; i < share; ++ i )
+    {
+        self.tasks.PushBottom( m_globalTasks.front() );
+        m_globalTasks.pop_front();
+    }
+
+    m_globalCount -= 1 + share;
+
+    return holder;
+}
+
+
+auto TaskStealingPoolImpl::Steal( Worker& self ) -> TaskHolder
+{
+    const Uint numWorkers = static_cast< Uint >( m_workers.size() );
+
+    if ( 1 == numWorkers ) { return nullptr; }
+
+    // Xorshift32
+    self.random ^= self.random << 13;
+    self.random ^= self.random >> 17;
+    self.random ^= self.random << 5;
+
+    const Uint start = self.random % numWorkers;
+
+    TaskHolder holder = nullptr;
+
+    for ( Uint i = 0; i < numWorkers; ++ i )
+    {
+        Worker& victim = *m_workers[( start + i ) % numWorkers ];
+
+        if ( &victim != &self && victim.tasks.Steal( holder ))
+        {
+            return holder;
+        }
+    }
+
+    return nullptr;
+}
+
+
+Bool TaskStealingPoolImpl::Sleep()
+{
+    auto ulock = UniqueLock( m_mutex );
+
+    ++ m_sleepingCount;
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+
+    Bool running = true;
+
+    for ( ;; )
+    {
+        this->PromoteDueTasks( TickClock::Now() );
+
+        if ( ! m_globalTasks.empty() || this->HasLocalTasks() ) { break; }
+
+        if ( m_stopping )
+        {
+            running = false;
+            break;
+        }
+
+        TickPoint nextTime;
+
+        if ( ! m_delayedTasks.GetNextAdvanceTime( nextTime ))
+        {
+            m_taskReady.wait( ulock );
+        }
+        else
+        {
+            const Ticks untilNext = nextTime - TickClock::Now();
+            m_taskReady.wait_for( ulock, std::chrono::milliseconds( untilNext.ToInt64() ));
+        }
+    }
+
+    -- m_sleepingCount;
+    return running;
+}
+
+
+TaskStealingPoolImpl::TaskHolder TaskStealingPoolImpl::HoldTask( const TaskPtr& task )
+{
+    TaskHolder holder = m_holders.AcquireObject();
+    *holder = task;
+    return holder;
+}
+
+
+void TaskStealingPoolImpl::RunTask( TaskHolder holder )
+{
+    TaskPtr task = std::move( *holder );
+    m_holders.ReleaseObject( holder );
+
+    Bool ran = true;
+
+    auto xc = CatchException( [&] { ran = task->Run(); } );
+    if ( xc )
+    {
+        CARAMEL_TRACE_WARN( "Task throws, pool: %s, task: %s", m_name, task->GetName() );
+    }
+
+    ++ ( ran ? m_runCount : m_cancelledCount );
+
+    if ( ran && task->IsRepeating() && ! task->IsCancelled() )
+    {
+        auto ulock = UniqueLock( m_mutex );
+
+        if ( ! m_stopping )
+        {
+            this->ScheduleDelayed( task, task->NextDueTime( TickClock::Now() ));
+        }
+    }
+
+    // Wake a worker to wait for the new earliest due time.
+    if ( task->IsRepeating() )
+    {
+        m_taskReady.notify_one();
+    }
+
+    task.reset();
+
+    this->Complete();
+}
+
+
+void TaskStealingPoolImpl::Complete()
+{
+    if ( 0 == -- m_pendingCount )
+    {
+        { auto ulock = UniqueLock( m_mutex ); }
+        m_drained.notify_all();
+    }
+}
+
+
+Bool TaskStealingPoolImpl::ScheduleDelayed( const TaskPtr& task, const TickPoint& dueTime )
+{
+    const Uint64 timerId = m_delayedTasks.Schedule( dueTime, task );
+    task->AttachDelayed( shared_from_this(), timerId );
+
+    // Cancelled before attached, it doesn't see this pool.
+    if ( task->IsCancelled() )
+    {
+        m_delayedTasks.Cancel( timerId );
+        ++ m_cancelledCount;
+        return false;
+    }
+
+    this->UpdateNextDueTicks();
+
+    // Let Shutdown() cancel it.
+    if ( m_shuttingDown )
+    {
+        m_drained.notify_all();
+    }
+
+    return true;
+}
+
+
+void TaskStealingPoolImpl::CancelDelayed( Uint64 timerId, Bool repeating )
+{
+    {
+        auto ulock = UniqueLock( m_mutex );
+
+        if ( ! m_delayedTasks.Cancel( timerId )) { return; }
+
+        this->UpdateNextDueTicks();
+        ++ m_cancelledCount;
+    }
+
+    if ( ! repeating )
+    {
+        this->Complete();
+    }
+}
+
+
+void TaskStealingPoolImpl::PromoteDueTasks( const TickPoint& now )
+{
+    if ( m_delayedTasks.IsEmpty() ) { return; }
+
+    std::vector< TaskPtr > dueTasks;
+    m_delayedTasks.PopAllUntil( now, dueTasks );
+
+    this->UpdateNextDueTicks();
+
+    if ( dueTasks.empty() ) { return; }
+
+    for ( Uint i = 0; i < dueTasks.size(); ++ i )
+    {
+        // A repeating task is pending only when it is due.
+        if ( dueTasks[i]->IsRepeating() ) { ++ m_pendingCount; }
+
+        m_globalTasks.push_back( this->HoldTask( dueTasks[i] ));
+    }
+
+    m_globalCount += static_cast< Uint >( dueTasks.size() );
+
+    // This worker takes one, wake the others for the rest.
+    if ( 1 < dueTasks.size() )
+    {
+        m_taskReady.notify_all();
+    }
+}
+
+
+void TaskStealingPoolImpl::UpdateNextDueTicks()
+{
+    TickPoint nextTime;
+
+    m_nextDueTicks = m_delayedTasks.GetNextAdvanceTime( nextTime )
+                   ? nextTime.time_since_epoch().count()
+                   : TickPoint::MaxValue().time_since_epoch().count();
+}
+
+
+void TaskStealingPoolImpl::CancelAllDelayed( std::unique_lock< std::mutex >& ulock )
+{
+    std::vector< TaskPtr > tasks;
+    m_delayedTasks.PopAll( tasks );
+
+    this->UpdateNextDueTicks();
+
+    ulock.unlock();
+
+    // The timers are gone, Cancel() won't come back to this pool.
+    // Count them here even if they have been cancelled by other threads.
+
+    for ( Uint i = 0; i < tasks.size(); ++ i )
+    {
+        tasks[i]->Cancel();
+        ++ m_cancelledCount;
+
+        // A repeating task is pending only when it is due.
+        if ( ! tasks[i]->IsRepeating() )
+        {
+            this->Complete();
+        }
+    }
+
+    tasks.clear();
+
+    ulock.lock();
+}
+
+
+Bool TaskStealingPoolImpl::HasLocalTasks() const
+{
+    for ( Uint i = 0; i < m_workers.size(); ++ i )
+    {
+        if ( ! m_workers[i]->tasks.IsEmpty() ) { return true; }
+    }
+
+    return false;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Strand
+//
+
+Strand::Strand( TaskExecutor& executor )
+    : m_impl( new StrandImpl( executor ))
+{
+}
+
+
+void Strand::Submit( const Task& task )
+{
+    task.GetImpl()->Resubmit();
+    m_impl->Submit( task.GetImpl() );
+}
+
+
+TaskCounters Strand::GetCounters() const
+{
+    TaskCounters counters;
+    counters.runCount = m_impl->m_runCount;
+    counters.cancelledCount = m_impl->m_cancelledCount;
+    return counters;
+}
+
+
+Bool Strand::IsRunningInThisThread() const
+{
+    return std::this_thread::get_id() == m_impl->m_drainThreadId.load();
+}
+
+
+//
+// Implementation
+//
+
+namespace Detail
+{
+
+// Tasks run by a drain before it yields the thread of the underlying executor.
+static const Uint STRAND_DRAIN_BATCH = 64;
+
+} // namespace Detail
+
+
+StrandImpl::StrandImpl( TaskExecutor& executor )
+    : m_executor( &executor )
+    , m_queuedCount( 0 )
+    , m_runCount( 0 )
+    , m_cancelledCount( 0 )
+{
+}
+
+
+void StrandImpl::Submit( const TaskPtr& task )
+{
+    if ( task->IsDelayed() )
+    {
+        this->ScheduleDelayed( task, task->FirstDueTime( TickClock::Now() ));
+    }
+    else
+    {
+        this->Enqueue( task );
+    }
+}
+
+
+void StrandImpl::Enqueue( const TaskPtr& task, const TimerPtr& timer, const TaskPtr& wrapper )
+{
+    Node* node = m_nodes.AcquireObject();
+    node->task = task;
+    node->timer = timer;
+    node->wrapper = wrapper;
+
+    m_queue.Push( node );
+
+    if ( 0 == m_queuedCount ++ )
+    {
+        this->SubmitDrain();
+    }
+}
+
+
+void StrandImpl::ScheduleDelayed(
+    const TaskPtr& task, const TickPoint& dueTime, TimerPtr timer, TaskPtr wrapper )
+{
+    if ( ! timer )
+    {
+        timer = std::make_shared< Timer >();
+        timer->strand = shared_from_this();
+        timer->task = task;
+
+        wrapper = Task( TaskName::Literal( "Strand.Due" ), [timer]
+        {
+            if ( auto strand = timer->strand.lock() )
+            {
+                strand->Enqueue( timer->task, timer, timer->wrapper.lock() );
+            }
+        }).GetImpl();
+
+        timer->wrapper = wrapper;
+        task->AttachDelayed( timer, 0 );
+
+        // Cancelled before attached, it doesn't see the timer.
+        if ( task->IsCancelled() )
+        {
+            ++ m_cancelledCount;
+            return;
+        }
+    }
+
+    else
+    {
+        // The wrapper enqueued this task, and may be finishing its run in
+        // another thread. Wait for that, so it is pending again when submitted.
+        while ( wrapper->IsRunning() )
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    wrapper->ResetDelay( dueTime - TickClock::Now() );
+
+    m_executor->Submit( Task( std::move( wrapper )));
+}
+
+
+void StrandImpl::Timer::CancelDelayed( Uint64, Bool )
+{
+    auto delayed = wrapper.lock();
+
+    if ( delayed && delayed->Cancel() )
+    {
+        if ( auto owner = strand.lock() )
+        {
+            ++ owner->m_cancelledCount;
+        }
+    }
+}
+
+
+void StrandImpl::SubmitDrain()
+{
+    auto self = shared_from_this();
+
+    try
+    {
+        m_executor->Submit( Task( TaskName::Literal( "Strand.Drain" ), [self] { self->Drain(); } ));
+    }
+    catch ( ... )
+    {
+        // No drain would take the queue, so later submits would wait forever.
+        this->DiscardQueued();
+        throw;
+    }
+}
+
+
+void StrandImpl::DiscardQueued()
+{
+    for ( ;; )
+    {
+        Node* node = nullptr;
+        while ( nullptr == ( node = m_queue.TryPop() ))
+        {
+            std::this_thread::yield();
+        }
+
+        CARAMEL_TRACE_WARN( "Task is discarded, strand task: %s", node->task->GetName() );
+
+        node->task.reset();
+        node->timer.reset();
+        node->wrapper.reset();
+        m_nodes.ReleaseObject( node );
+
+        ++ m_cancelledCount;
+
+        if ( 0 == -- m_queuedCount ) { return; }
+    }
+}
+
+
+void StrandImpl::Drain()
+{
+    for ( Uint i = 0; i < Detail::STRAND_DRAIN_BATCH; ++ i )
+    {
+        // Counted but not linked yet, the pushing thread is in the middle.
+        Node* node = nullptr;
+        while ( nullptr == ( node = m_queue.TryPop() ))
+        {
+            std::this_thread::yield();
+        }
+
+        // Cleared before the count, a next drain may start right after that.
+        m_drainThreadId = std::this_thread::get_id();
+        this->RunTask( *node );
+        m_drainThreadId = std::thread::id();
+
+        node->task.reset();
+        node->timer.reset();
+        node->wrapper.reset();
+        m_nodes.ReleaseObject( node );
+
+        if ( 0 == -- m_queuedCount ) { return; }
+    }
+
+    // Let other tasks of the underlying executor run, then continue.
+    this->SubmitDrain();
+}
+
+
+void StrandImpl::RunTask( Node& node )
+{
+    const TaskPtr& task = node.task;
+
+    Bool ran = true;
+
+    auto xc = CatchException( [&] { ran = task->Run(); } );
+    if ( xc )
+    {
+        CARAMEL_TRACE_WARN( "Task throws, strand task: %s", task->GetName() );
+    }
+
+    ++ ( ran ? m_runCount : m_cancelledCount );
+
+    if ( ran && task->IsRepeating() && ! task->IsCancelled() )
+    {
+        auto xs = CatchException( [&]
+        {
+            this->ScheduleDelayed(
+                task, task->NextDueTime( TickClock::Now() ), node.timer, node.wrapper );
+        });
+
+        if ( xs )
+        {
+            CARAMEL_TRACE_WARN( "Repeating task stops, it can't be scheduled, strand task: %s", task->GetName() );
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Graph
+//
+
+TaskGraph::TaskGraph( const std::string& name )
+    : m_impl( new TaskGraphImpl( name ))
+{
+}
+
+
+Uint TaskGraph::AddNode( const std::string& name, TaskFunction f )
+{
+    CARAMEL_ASSERT( ! m_impl->m_running );
+
+    m_impl->m_nodes.emplace_back( new TaskGraphImpl::Node( name, std::move( f )));
+    m_impl->m_dirty = true;
+
+    return static_cast< Uint >( m_impl->m_nodes.size() - 1 );
+}
+
+
+void TaskGraph::AddDependency( Uint before, Uint after )
+{
+    CARAMEL_ASSERT( ! m_impl->m_running );
+
+    const Uint numNodes = static_cast< Uint >( m_impl->m_nodes.size() );
+
+    if ( numNodes <= before || numNodes <= after || before == after )
+    {
+        CARAMEL_THROW( "Invalid dependency, graph: %s, before: %u, after: %u", m_impl->m_name, before, after );
+    }
+
+    m_impl->m_nodes[ before ]->successors.push_back( after );
+    ++ m_impl->m_nodes[ after ]->predecessorCount;
+    m_impl->m_dirty = true;
+}
+
+
+Future< void > TaskGraph::Run( TaskExecutor& executor )
+{
+    if ( m_impl->m_running.exchange( true ))
+    {
+        CARAMEL_THROW( "Graph %s is running", m_impl->m_name );
+    }
+
+    if ( m_impl->m_dirty )
+    {
+        try
+        {
+            m_impl->Sort();
+        }
+        catch ( ... )
+        {
+            m_impl->m_running = false;
+            throw;
+        }
+    }
+
+    auto state = std::make_shared< Detail::FutureState< void >>();
+
+    if ( m_impl->m_nodes.empty() )
+    {
+        m_impl->m_running = false;
+        state->SetValue();
+        return Future< void >( state );
+    }
+
+    for ( Uint i = 0; i < m_impl->m_nodes.size(); ++ i )
+    {
+        TaskGraphImpl::Node& node = *m_impl->m_nodes[i];
+        node.pendingCount = node.predecessorCount;
+        node.startNanos = 0;
+        node.endNanos = 0;
+    }
+
+    m_impl->m_remainingCount = static_cast< Uint >( m_impl->m_nodes.size() );
+    m_impl->m_executor = &executor;
+    m_impl->m_failed = false;
+    m_impl->m_exception = nullptr;
+    m_impl->m_state = state;
+    m_impl->m_startTime = TaskGraphImpl::HighResClock::now();
+
+    // Copied, the last root may finish the run before this loop ends.
+    const std::vector< Uint > roots = m_impl->m_roots;
+
+    for ( Uint i = 0; i < roots.size(); ++ i )
+    {
+        m_impl->SubmitNode( roots[i] );
+    }
+
+    return Future< void >( state );
+}
+
+
+Uint TaskGraph::GetNodeCount() const
+{
+    return static_cast< Uint >( m_impl->m_nodes.size() );
+}
+
+
+Bool TaskGraph::IsRunning() const
+{
+    return m_impl->m_running;
+}
+
+
+TaskGraphTiming TaskGraph::GetLastTiming() const
+{
+    SpinMutex::ScopedLock lock( m_impl->m_timingMutex );
+    return m_impl->m_lastTiming;
+}
+
+
+//
+// Timing
+//
+
+std::string TaskGraphTiming::ToString( const std::string& graphName ) const
+{
+    std::string result = Sprintf(
+        "%s : wall %.2f ms, critical path %.2f ms",
+        graphName, wallTime.ToDouble() * 1000, criticalPathTime.ToDouble() * 1000 );
+
+    for ( Uint i = 0; i < criticalPath.size(); ++ i )
+    {
+        const TaskGraphNodeTiming& node = nodes[ criticalPath[i] ];
+
+        result += ( 0 == i ) ? "\n  " : " -> ";
+        result += Sprintf( "%s %.2f ms", node.name, node.duration.ToDouble() * 1000 );
+    }
+
+    return result;
+}
+
+
+//
+// Implementation
+//
+
+TaskGraphImpl::TaskGraphImpl( const std::string& name )
+    : m_name( name )
+    , m_dirty( false )
+    , m_running( false )
+    , m_remainingCount( 0 )
+    , m_executor( nullptr )
+    , m_failed( false )
+{
+}
+
+
+TaskGraphImpl::Node::Node( const std::string& name, TaskFunction&& function )
+    : name( name )
+    , function( std::move( function ))
+    , predecessorCount( 0 )
+    , pendingCount( 0 )
+    , startNanos( 0 )
+    , endNanos( 0 )
+{
+}
+
+
+void TaskGraphImpl::Sort()
+{
+    // Kahn's algorithm.
+
+    const Uint numNodes = static_cast< Uint >( m_nodes.size() );
+
+    std::vector< Uint > counts( numNodes );
+    m_roots.clear();
+    m_order.clear();
+
+    for ( Uint i = 0; i < numNodes; ++ i )
+    {
+        counts[i] = m_nodes[i]->predecessorCount;
+        if ( 0 == counts[i] ) { m_roots.push_back( i ); }
+    }
+
+    m_order = m_roots;
+
+    for ( Uint k = 0; k < m_order.size(); ++ k )
+    {
+        const std::vector< Uint >& successors = m_nodes[ m_order[k] ]->successors;
+
+        for ( Uint j = 0; j < successors.size(); ++ j )
+        {
+            if ( 0 == -- counts[ successors[j] ]) { m_order.push_back( successors[j] ); }
+        }
+    }
+
+    if ( m_order.size() < numNodes )
+    {
+        CARAMEL_THROW( "Graph %s has a cycle", m_name );
+    }
+
+    m_dirty = false;
+}
+
+
+void TaskGraphImpl::SubmitNode( Uint index )
+{
+    auto self = shared_from_this();
+
+    Task task(
+        TaskName::Lazy( "Graph[%s].Node[%d]", m_name, static_cast< Int >( index )),
+        [self, index] { self->RunNode( index ); }
+    );
+
+    auto xc = CatchException( [&] { m_executor->Submit( task ); } );
+    if ( xc )
+    {
+        {
+            SpinMutex::ScopedLock lock( m_exceptionMutex );
+
+            if ( ! m_failed.exchange( true ))
+            {
+                m_exception = Detail::MakeFutureException( xc );
+            }
+        }
+
+        // Skipped, to finish the run.
+        this->RunNode( index );
+    }
+}
+
+
+void TaskGraphImpl::RunNode( Uint index )
+{
+    Node& node = *m_nodes[ index ];
+
+    node.startNanos = ( HighResClock::now() - m_startTime ).count();
+
+    if ( ! m_failed )
+    {
+        auto xc = CatchException( node.function );
+        if ( xc )
+        {
+            CARAMEL_TRACE_WARN( "Graph %s node %s throws", m_name, node.name );
+
+            SpinMutex::ScopedLock lock( m_exceptionMutex );
+
+            if ( ! m_failed.exchange( true ))
+            {
+                m_exception = Detail::MakeFutureException( xc );
+            }
+        }
+    }
+
+    node.endNanos = ( HighResClock::now() - m_startTime ).count();
+
+    for ( Uint i = 0; i < node.successors.size(); ++ i )
+    {
+        const Uint next = node.successors[i];
+
+        if ( 1 == m_nodes[ next ]->pendingCount.fetch_sub( 1 ))
+        {
+            this->SubmitNode( next );
+        }
+    }
+
+    if ( 1 == m_remainingCount.fetch_sub( 1 ))
+    {
+        this->Finish();
+    }
+}
+
+
+void TaskGraphImpl::Finish()
+{
+    TaskGraphTiming timing = this->MakeTiming();
+    {
+        SpinMutex::ScopedLock lock( m_timingMutex );
+        m_lastTiming = std::move( timing );
+    }
+
+    auto state = std::move( m_state );
+    const std::exception_ptr exception = m_exception;
+
+    // Run() may be called again from here.
+    m_running = false;
+
+    if ( exception )
+    {
+        state->SetException( exception );
+    }
+    else
+    {
+        state->SetValue();
+    }
+}
+
+
+TaskGraphTiming TaskGraphImpl::MakeTiming() const
+{
+    typedef boost::chrono::nanoseconds Nanos;
+
+    const Uint numNodes = static_cast< Uint >( m_nodes.size() );
+
+    TaskGraphTiming timing;
+    timing.nodes.resize( numNodes );
+
+    Int64 wallNanos = 0;
+
+    for ( Uint i = 0; i < numNodes; ++ i )
+    {
+        const Node& node = *m_nodes[i];
+
+        timing.nodes[i].name      = node.name;
+        timing.nodes[i].startTime = Seconds( Nanos( node.startNanos ));
+        timing.nodes[i].duration  = Seconds( Nanos( node.endNanos - node.startNanos ));
+
+        wallNanos = std::max( wallNanos, node.endNanos );
+    }
+
+    timing.wallTime = Seconds( Nanos( wallNanos ));
+
+    // Longest path by the durations, in the topological order.
+    // Before a node is visited, its pathNanos is the longest path of its predecessors.
+
+    std::vector< Int64 > pathNanos( numNodes, 0 );
+    std::vector< Uint >  prevNode( numNodes, numNodes );
+
+    Uint last = m_order.front();
+
+    for ( Uint k = 0; k < m_order.size(); ++ k )
+    {
+        const Uint i = m_order[k];
+        const Node& node = *m_nodes[i];
+
+        pathNanos[i] += node.endNanos - node.startNanos;
+
+        if ( pathNanos[ last ] < pathNanos[i] ) { last = i; }
+
+        for ( Uint j = 0; j < node.successors.size(); ++ j )
+        {
+            const Uint next = node.successors[j];
+
+            if ( numNodes == prevNode[ next ] || pathNanos[ next ] < pathNanos[i] )
+            {
+                pathNanos[ next ] = pathNanos[i];
+                prevNode[ next ] = i;
+            }
+        }
+    }
+
+    timing.criticalPathTime = Seconds( Nanos( pathNanos[ last ]));
+
+    for ( Uint i = last; numNodes != i; i = prevNode[i] )
+    {
+        timing.criticalPath.push_back( i );
+    }
+
+    std::reverse( timing.criticalPath.begin(), timing.criticalPath.end() );
+
+    return timing;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Async Task
+//
+
+namespace Detail
+{
+
+void* AllocateAsyncFrame( std::size_t size )
+{
+    return TaskManager::Instance()->AllocateFrame( size );
+}
+
+
+void FreeAsyncFrame( void* frame, std::size_t size )
+{
+    TaskManager::Instance()->FreeFrame( frame, size );
+}
+
+} // namespace Detail
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Parallel Algorithms
+//
+
+namespace Detail
+{
+
+Uint AcquireParallelHelpers( Uint wanted )
+{
+    return TaskManager::Instance()->AcquireHelpers( wanted );
+}
+
+
+void ReleaseParallelHelpers( Uint count )
+{
+    TaskManager::Instance()->ReleaseHelpers( count );
+}
+
+} // namespace Detail
+
+
+void SetMaxParallelHelpers( Uint maxHelpers )
+{
+    TaskManager::Instance()->SetMaxHelpers( maxHelpers );
+}
+
+
+Uint GetMaxParallelHelpers()
+{
+    return TaskManager::Instance()->GetMaxHelpers();
 }
 
 
@@ -0,0 +1,56 @@
+// Caramel C++ Library - Task Facility - Cancellation Token Private Header
+
+#ifndef __CARAMEL_TASK_CANCELLATION_TOKEN_IMPL_H
+#define __CARAMEL_TASK_CANCELLATION_TOKEN_IMPL_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Task/CancellationToken.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+
+namespace Caramel
+{
+
+class TaskImpl;
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Cancellation Token
+//
+
+class CancellationTokenImpl
+{
+public:
+
+    CancellationTokenImpl();
+
+    void Cancel();
+
+    Bool IsCancelled() const { return m_cancelled; }
+
+    // If this token has been cancelled, the task is cancelled now.
+    void AddTask( const std::shared_ptr< TaskImpl >& task );
+
+
+private:
+
+    std::atomic< Bool > m_cancelled;
+
+    std::mutex m_mutex;
+
+    // Tasks done are pruned when the list doubles.
+    std::vector< std::weak_ptr< TaskImpl > > m_tasks;
+    std::size_t m_pruneSize;
+};
+
+typedef std::shared_ptr< CancellationTokenImpl > CancellationTokenPtr;
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_TASK_CANCELLATION_TOKEN_IMPL_H
@@ -0,0 +1,115 @@
+// Caramel C++ Library - Task Facility - Strand Private Header
+
+#ifndef __CARAMEL_TASK_STRAND_IMPL_H
+#define __CARAMEL_TASK_STRAND_IMPL_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include "Task/TaskImpl.h"
+#include <Caramel/Concurrent/IntrusiveQueue.h>
+#include <Caramel/Object/Pool.h>
+#include <Caramel/Task/Strand.h>
+#include <atomic>
+#include <thread>
+
+
+namespace Caramel
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Strand
+//
+
+class StrandImpl : public std::enable_shared_from_this< StrandImpl >
+{
+    friend class Strand;
+
+public:
+
+    explicit StrandImpl( TaskExecutor& executor );
+
+    void Submit( const TaskPtr& task );
+
+
+private:
+
+    /// Internal Types ///
+
+    //
+    // A delayed or repeating task is scheduled in the underlying executor
+    // by a wrapper task, which enqueues it to the strand when due.
+    // - One wrapper per task, submitted again for each cycle.
+    // - The task attaches to this as its delayed host, so cancelling the task
+    //   cancels the wrapper, which drops it from the executor at once.
+    // - Owned by the wrapper's function while it is scheduled,
+    //   then by the queued node.
+    //
+    struct Timer : public DelayedTaskHost
+    {
+        void CancelDelayed( Uint64 timerId, Bool repeating ) override;
+
+        std::weak_ptr< StrandImpl > strand;
+        TaskPtr task;
+        std::weak_ptr< TaskImpl > wrapper;
+    };
+
+    typedef std::shared_ptr< Timer > TimerPtr;
+
+
+    // Holds a queued task, recycled by the m_nodes.
+    struct Node : public Concurrent::IntrusiveQueueNode
+    {
+        TaskPtr task;
+
+        // Of a delayed task, kept for its next cycle.
+        TimerPtr timer;
+        TaskPtr  wrapper;
+    };
+
+
+    /// Internal Functions ///
+
+    void Enqueue( const TaskPtr& task, const TimerPtr& timer = TimerPtr(), const TaskPtr& wrapper = TaskPtr() );
+
+    //
+    // Submit the wrapper of a task to the underlying executor.
+    // - The first time, the timer and the wrapper are created.
+    //
+    void ScheduleDelayed(
+        const TaskPtr& task, const TickPoint& dueTime,
+        TimerPtr timer = TimerPtr(), TaskPtr wrapper = TaskPtr() );
+
+    // If the underlying executor refuses the drain, the queued tasks are
+    // discarded, and the exception is rethrown.
+    void SubmitDrain();
+    void Drain();
+
+    // Drop the queued tasks without running them, as the drain would.
+    void DiscardQueued();
+
+    void RunTask( Node& node );
+
+
+    /// Data Members ///
+
+    TaskExecutor* m_executor;
+
+    Concurrent::IntrusiveQueue< Node > m_queue;
+    Pool< Node, 1024 > m_nodes;
+
+    // Queued tasks, including the one being run. The first one submits the drain.
+    std::atomic< Uint > m_queuedCount;
+
+    std::atomic< std::thread::id > m_drainThreadId;
+
+    std::atomic< Uint64 > m_runCount;
+    std::atomic< Uint64 > m_cancelledCount;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_TASK_STRAND_IMPL_H
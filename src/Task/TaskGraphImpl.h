@@ -0,0 +1,104 @@
+// Caramel C++ Library - Task Facility - Task Graph Private Header
+
+#ifndef __CARAMEL_TASK_TASK_GRAPH_IMPL_H
+#define __CARAMEL_TASK_TASK_GRAPH_IMPL_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Task/TaskGraph.h>
+#include <Caramel/Thread/SpinMutex.h>
+#include <boost/chrono/system_clocks.hpp>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <vector>
+
+
+namespace Caramel
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Graph
+//
+
+class TaskGraphImpl : public std::enable_shared_from_this< TaskGraphImpl >
+{
+    friend class TaskGraph;
+
+public:
+
+    explicit TaskGraphImpl( const std::string& name );
+
+
+private:
+
+    /// Internal Types ///
+
+    typedef boost::chrono::steady_clock HighResClock;
+
+    struct Node
+    {
+        Node( const std::string& name, TaskFunction&& function );
+
+        std::string  name;
+        TaskFunction function;
+
+        std::vector< Uint > successors;
+        Uint predecessorCount;
+
+        // Of the current run.
+        std::atomic< Uint > pendingCount;
+        Int64 startNanos;
+        Int64 endNanos;
+    };
+
+
+    /// Internal Functions ///
+
+    // Throws if there is a cycle.
+    // REMARKS: Updates the m_order, and clears the m_dirty.
+    void Sort();
+
+    void SubmitNode( Uint index );
+    void RunNode( Uint index );
+
+    void Finish();
+
+    TaskGraphTiming MakeTiming() const;
+
+
+    /// Data Members ///
+
+    std::string m_name;
+
+    std::vector< std::unique_ptr< Node >> m_nodes;
+    std::vector< Uint > m_roots;
+    std::vector< Uint > m_order;  // Topological
+    Bool m_dirty;  // Built since the last sort.
+
+    // Of the current run.
+
+    std::atomic< Bool > m_running;
+    std::atomic< Uint > m_remainingCount;
+
+    TaskExecutor* m_executor;
+    HighResClock::time_point m_startTime;
+
+    std::atomic< Bool > m_failed;
+    std::exception_ptr  m_exception;
+    SpinMutex m_exceptionMutex;
+
+    std::shared_ptr< Detail::FutureState< void >> m_state;
+
+    // Of the last completed run.
+    mutable SpinMutex m_timingMutex;
+    TaskGraphTiming m_lastTiming;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_TASK_TASK_GRAPH_IMPL_H
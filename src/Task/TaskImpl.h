@@ -5,12 +5,33 @@
 #pragma once
 
 #include <Caramel/Caramel.h>
+#include "Task/CancellationTokenImpl.h"
 #include <Caramel/Task/Task.h>
+#include <Caramel/Thread/SpinMutex.h>
+#include <atomic>
 
 
 namespace Caramel
 {
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Delayed Task Host
+// - An executor which holds delayed tasks in a TimingWheel.
+//   A cancelled task calls it to drop itself from the wheel in O(1).
+//
+
+class DelayedTaskHost
+{
+public:
+    virtual ~DelayedTaskHost() {}
+
+    // Drop the timer, if it has not expired.
+    // - A repeating task waiting for its next run is not pending in the host.
+    virtual void CancelDelayed( Uint64 timerId, Bool repeating ) = 0;
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // Task
@@ -20,34 +41,112 @@ class TaskImpl
 {
 public:
 
-    TaskImpl( const std::string& name, TaskFunction&& f );
+    TaskImpl( const TaskName& name, Detail::TaskCallable&& f );
 
 
     /// Operations ///
 
     void DelayFor( const Ticks& duration );
 
-    void Run();
+    // For an executor which submits the same task again with another delay.
+    // - Not delayed if the duration is not positive.
+    void ResetDelay( const Ticks& duration );
+
+    void SetRepeat( const Ticks& interval, TaskRepeatMode mode );
+
+    void SetPriority( TaskPriority priority ) { m_priority = priority; }
+
+    void SetCancellation( CancellationTokenPtr token );
+
+    void SetCancelledHandler( Detail::TaskCallable&& f ) { m_cancelledHandler = std::move( f ); }
+
+    // A completed task is pending again when it is submitted again.
+    void Resubmit();
+
+    // Returns false if the task is cancelled, it doesn't run.
+    Bool Run();
+
+    // Returns true if the task is cancelled before running.
+    Bool Cancel();
+
+    //
+    // Called by the executor when it puts this task into its timing wheel,
+    // with its lock held.
+    //
+    void AttachDelayed( const std::weak_ptr< DelayedTaskHost >& host, Uint64 timerId );
+
+    //
+    // Due times of a delayed task, called by its executor.
+    // - NextDueTime() is called after each run of a repeating task.
+    //
+    TickPoint FirstDueTime( const TickPoint& now );
+    TickPoint NextDueTime( const TickPoint& now );
 
 
     /// Properties ///
 
-    Bool IsDelayed() const { return m_delayed; }
+    std::string GetName() const { return m_name.ToString(); }
 
-    Ticks GetDelayDuration() const { return m_delayDuration; }
+    const TaskName& GetTaskName() const { return m_name; }
+
+    Bool IsDelayed() const { return m_delayed || m_repeating; }
+
+    Bool IsRepeating() const { return m_repeating; }
+
+    TaskPriority GetPriority() const { return m_priority; }
+
+    Bool IsCancelled() const;
+    Bool IsCompleted() const;
+
+    Bool IsRunning() const { return STATE_RUNNING == m_state; }
 
 
 private:
 
-    std::string  m_name;
-    TaskFunction m_function;
+    TaskName m_name;
+    Detail::TaskCallable m_function;
+
 
-    
     /// Delay ///
 
     Bool m_delayed;
     Ticks m_delayDuration;
 
+
+    /// Repeat ///
+
+    Bool m_repeating;
+    Ticks m_repeatInterval;
+    TaskRepeatMode m_repeatMode;
+
+    // Of the current cycle, accessed by the executor only.
+    TickPoint m_dueTime;
+
+    TaskPriority m_priority;
+
+
+    /// State ///
+
+    enum State
+    {
+        STATE_PENDING,
+        STATE_RUNNING,
+        STATE_COMPLETED,
+        STATE_CANCELLED,
+    };
+
+    std::atomic< Int > m_state;
+
+    CancellationTokenPtr m_token;
+
+    // Called once, if cancelled before running.
+    Detail::TaskCallable m_cancelledHandler;
+
+    // Where the task is delayed, protected by the spin mutex.
+    SpinMutex m_delayHostMutex;
+    std::weak_ptr< DelayedTaskHost > m_delayHost;
+    Uint64 m_delayTimerId;
+
 };
 
 typedef std::shared_ptr< TaskImpl > TaskPtr;
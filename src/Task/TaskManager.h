@@ -0,0 +1,221 @@
+// Caramel C++ Library - Task Facility - Task Manager Header
+
+#ifndef __CARAMEL_TASK_TASK_MANAGER_H
+#define __CARAMEL_TASK_TASK_MANAGER_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include "Object/FacilityLongevity.h"
+#include "Task/TaskImpl.h"
+#include <Caramel/Object/Pool.h>
+#include <Caramel/Object/Singleton.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+
+namespace Caramel
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Block
+// - Raw memory for a TaskImpl together with its shared_ptr control block.
+//
+
+struct TaskBlock
+{
+    static const std::size_t SIZE = sizeof( TaskImpl ) + 64;
+
+    std::aligned_storage< SIZE >::type storage;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Frame Block
+// - Raw memory for coroutine frames, in size classes of 256 to 2048 bytes.
+//
+
+template< std::size_t Size >
+struct FrameBlock
+{
+    typename std::aligned_storage< Size >::type storage;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Manager
+// - Recycles the task blocks and the coroutine frames by Pools,
+//   the allocation takes no lock.
+//   At most MAX_CACHED_BLOCKS are kept in the depot of each pool.
+//
+
+class TaskManager : public Singleton< TaskManager, FACILITY_LONGEVITY_TASK >
+{
+    static const Uint MAX_CACHED_BLOCKS = 1024;
+
+public:
+
+    TaskManager();
+
+    typedef Pool< TaskBlock, MAX_CACHED_BLOCKS > BlockPool;
+
+    void* AllocateBlock()            { return m_blocks.AcquireObject(); }
+    void  FreeBlock( void* block )   { m_blocks.ReleaseObject( static_cast< TaskBlock* >( block )); }
+
+
+    /// Coroutine Frames ///
+
+    // Larger frames than the size classes fall back to the operator new.
+    void* AllocateFrame( std::size_t size );
+    void  FreeFrame( void* frame, std::size_t size );
+
+
+    /// Parallel Helpers ///
+    //
+    // The parallel algorithms take helper tasks from a budget of the hardware
+    // threads but the caller's, so nested calls don't oversubscribe.
+    //
+
+    // Returns the number of taken helpers, at most wanted.
+    Uint AcquireHelpers( Uint wanted );
+    void ReleaseHelpers( Uint count );
+
+    // The taken helpers are not affected.
+    void SetMaxHelpers( Uint maxHelpers );
+    Uint GetMaxHelpers() const { return m_maxHelpers; }
+
+
+private:
+
+    BlockPool m_blocks;
+
+    Pool< FrameBlock< 256 >,  MAX_CACHED_BLOCKS > m_frames256;
+    Pool< FrameBlock< 512 >,  MAX_CACHED_BLOCKS > m_frames512;
+    Pool< FrameBlock< 1024 >, MAX_CACHED_BLOCKS > m_frames1024;
+    Pool< FrameBlock< 2048 >, MAX_CACHED_BLOCKS > m_frames2048;
+
+    std::atomic< Int > m_spareHelpers;  // May be negative for a while, after the max is lowered.
+    std::atomic< Uint > m_maxHelpers;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Allocator
+// - For std::allocate_shared< TaskImpl >, takes the blocks from TaskManager.
+//   Other sizes fall back to the std::allocator.
+//
+
+template< typename T >
+class TaskAllocator : public std::allocator< T >
+{
+public:
+
+    template< typename U >
+    struct rebind { typedef TaskAllocator< U > other; };
+
+    TaskAllocator() {}
+
+    template< typename U >
+    TaskAllocator( const TaskAllocator< U >& ) {}
+
+    T* allocate( std::size_t n, const void* = nullptr )
+    {
+        if ( 1 == n && sizeof( T ) <= TaskBlock::SIZE )
+        {
+            return static_cast< T* >( TaskManager::Instance()->AllocateBlock() );
+        }
+
+        return std::allocator< T >().allocate( n );
+    }
+
+    void deallocate( T* p, std::size_t n )
+    {
+        if ( 1 == n && sizeof( T ) <= TaskBlock::SIZE )
+        {
+            TaskManager::Instance()->FreeBlock( p );
+            return;
+        }
+
+        std::allocator< T >().deallocate( p, n );
+    }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Implementation
+//
+
+inline TaskManager::TaskManager()
+    : m_spareHelpers( 0 )
+    , m_maxHelpers( 0 )
+{
+    this->SetMaxHelpers( std::max( 1u, std::thread::hardware_concurrency() ) - 1 );
+}
+
+
+inline void* TaskManager::AllocateFrame( std::size_t size )
+{
+    if ( 256 >= size )  { return m_frames256.AcquireObject(); }
+    if ( 512 >= size )  { return m_frames512.AcquireObject(); }
+    if ( 1024 >= size ) { return m_frames1024.AcquireObject(); }
+    if ( 2048 >= size ) { return m_frames2048.AcquireObject(); }
+
+    return ::operator new( size );
+}
+
+
+inline void TaskManager::FreeFrame( void* frame, std::size_t size )
+{
+    if ( 256 >= size )       { m_frames256.ReleaseObject( static_cast< FrameBlock< 256 >* >( frame )); }
+    else if ( 512 >= size )  { m_frames512.ReleaseObject( static_cast< FrameBlock< 512 >* >( frame )); }
+    else if ( 1024 >= size ) { m_frames1024.ReleaseObject( static_cast< FrameBlock< 1024 >* >( frame )); }
+    else if ( 2048 >= size ) { m_frames2048.ReleaseObject( static_cast< FrameBlock< 2048 >* >( frame )); }
+    else
+    {
+        ::operator delete( frame );
+    }
+}
+
+
+inline Uint TaskManager::AcquireHelpers( Uint wanted )
+{
+    Int spare = m_spareHelpers.load();
+
+    for ( ;; )
+    {
+        const Int taken = std::min( spare, static_cast< Int >( wanted ));
+        if ( 0 >= taken ) { return 0; }
+
+        if ( m_spareHelpers.compare_exchange_weak( spare, spare - taken ))
+        {
+            return static_cast< Uint >( taken );
+        }
+    }
+}
+
+
+inline void TaskManager::ReleaseHelpers( Uint count )
+{
+    m_spareHelpers += static_cast< Int >( count );
+}
+
+
+inline void TaskManager::SetMaxHelpers( Uint maxHelpers )
+{
+    const Uint oldMax = m_maxHelpers.exchange( maxHelpers );
+    m_spareHelpers += static_cast< Int >( maxHelpers ) - static_cast< Int >( oldMax );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_TASK_TASK_MANAGER_H
@@ -6,9 +6,14 @@
 
 #include <Caramel/Caramel.h>
 #include "Task/TaskImpl.h"
-#include <Caramel/Concurrent/PriorityQueue.h>
-#include <Caramel/Concurrent/Queue.h>
+#include <Caramel/Chrono/TimingWheel.h>
 #include <Caramel/Task/TaskPoller.h>
+#include <Caramel/Thread/MutexLocks.h>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/circular_buffer.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 
 namespace Caramel
@@ -19,17 +24,88 @@ namespace Caramel
 // Task Poller
 //
 
-class TaskPollerImpl
+class TaskPollerImpl : public DelayedTaskHost
+                     , public std::enable_shared_from_this< TaskPollerImpl >
 {
     friend class TaskPoller;
 
+public:
+
+    void CancelDelayed( Uint64 timerId, Bool repeating ) override;
+
+
 private:
 
-    typedef Concurrent::PriorityQueue< TickPoint, TaskPtr > DelayedTaskQueue;
-    DelayedTaskQueue m_delayedTasks;
+    TaskPollerImpl();
+
+    // Returns the number of polled tasks, including the cancelled ones.
+    Uint PollFor( const Ticks& sliceTicks );
+
+    // Returns false if the task is cancelled.
+    Bool RunTask( const TaskPtr& task );
+
+    void ScheduleDelayed( const TaskPtr& task, const TickPoint& dueTime );
+
+    void PushReady( const TaskPtr& task );
+    Bool PopReady( TaskPtr& task );
+
+    // Delayed tasks, protected by the m_delayedMutex.
+    std::mutex m_delayedMutex;
+    TimingWheel< TaskPtr > m_delayedTasks;
+    std::atomic< Uint > m_delayedCount;  // Skip the lock if no delayed task.
+
+
+    /// Waiting ///
+
+    Bool HasReadyTasks() const;
+    Bool HasDueTasks();
+
+    // Until new work, the next due time, or the deadline.
+    void WaitForWork( const TickPoint& deadline );
+
+    void WakeWaiting();
+
+    std::mutex m_waitMutex;
+    std::condition_variable m_workReady;
+    std::atomic< Uint > m_waitingCount;
+
+
+    /// Ready Lanes ///
+
+    typedef boost::chrono::steady_clock HighResClock;
+
+    struct ReadyTask
+    {
+        TaskPtr task;
+        HighResClock::time_point readyTime;
+    };
+
+    struct Lane
+    {
+        Lane();
+
+        void Push( ReadyTask&& ready );
+        Bool TryPop( ReadyTask& ready );
+
+        void RecordWait( Int64 waitNanos );
+
+        // A ring which only grows, no allocation in steady state.
+        std::mutex mutex;
+        boost::circular_buffer< ReadyTask > tasks;
+        std::atomic< Uint > depth;
+
+        // Consecutive turns left in the current round.
+        std::atomic< Int > credits;
+
+        std::atomic< Uint64 > dequeuedCount;
+        std::atomic< Int64 >  totalWaitNanos;
+        std::atomic< Int64 >  maxWaitNanos;
+    };
+
+    Lane m_lanes[ TASK_PRIORITY_COUNT ];
 
-    typedef Concurrent::Queue< TaskPtr > ReadyTaskQueue;
-    ReadyTaskQueue m_readyTasks;
+    std::atomic< Uint64 > m_runCount;
+    std::atomic< Uint64 > m_cancelledCount;
 };
 
 
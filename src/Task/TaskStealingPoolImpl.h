@@ -0,0 +1,141 @@
+// Caramel C++ Library - Task Facility - Task Stealing Pool Private Header
+
+#ifndef __CARAMEL_TASK_TASK_STEALING_POOL_IMPL_H
+#define __CARAMEL_TASK_TASK_STEALING_POOL_IMPL_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include "Task/TaskImpl.h"
+#include <Caramel/Chrono/TimingWheel.h>
+#include <Caramel/Concurrent/WorkStealingDeque.h>
+#include <Caramel/Object/Pool.h>
+#include <Caramel/Task/TaskStealingPool.h>
+#include <Caramel/Thread/Thread.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace Caramel
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Stealing Pool
+//
+
+class TaskStealingPoolImpl : public DelayedTaskHost
+                           , public std::enable_shared_from_this< TaskStealingPoolImpl >
+{
+    friend class TaskStealingPool;
+
+public:
+
+    TaskStealingPoolImpl( const std::string& name, Uint numThreads );
+
+    void Submit( TaskPtr task );
+
+    void Drain();
+    void Shutdown();
+
+    void CancelDelayed( Uint64 timerId, Bool repeating ) override;
+
+
+private:
+
+    /// Internal Types ///
+
+    //
+    // The deques require trivially copyable elements,
+    // so each queued task is held by a pooled TaskPtr until it runs.
+    //
+    typedef TaskPtr* TaskHolder;
+
+    struct Worker
+    {
+        Worker() : random( 0 ) {}
+
+        Thread thread;
+        std::thread::id threadId;
+
+        Concurrent::WorkStealingDeque< TaskHolder > tasks;
+
+        Uint random;  // Xorshift state, to choose the victims.
+    };
+
+
+    /// Internal Functions ///
+
+    void RunWorker( Uint index );
+
+    Worker* FindCurrentWorker();
+
+    TaskHolder TakeGlobal( Worker& self );
+    TaskHolder Steal( Worker& self );
+
+    // Returns false if the workers should stop.
+    Bool Sleep();
+
+    TaskHolder HoldTask( const TaskPtr& task );
+    void RunTask( TaskHolder holder );
+
+    // A task is done or dropped.
+    void Complete();
+
+    // REMARKS: The m_mutex should have been locked.
+    void PromoteDueTasks( const TickPoint& now );
+    void UpdateNextDueTicks();
+
+    // Cancel all tasks in the timing wheel, with m_mutex unlocked meanwhile.
+    // REMARKS: The m_mutex should have been locked.
+    void CancelAllDelayed( std::unique_lock< std::mutex >& ulock );
+
+    // Returns false if the task has been cancelled.
+    // REMARKS: The m_mutex should have been locked.
+    Bool ScheduleDelayed( const TaskPtr& task, const TickPoint& dueTime );
+
+    Bool HasLocalTasks() const;
+
+
+    /// Data Members ///
+
+    std::string m_name;
+
+    std::vector< std::unique_ptr< Worker > > m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_taskReady;
+    std::condition_variable m_drained;
+
+    Pool< TaskPtr, 1024 > m_holders;
+
+    std::deque< TaskHolder > m_globalTasks;
+    std::atomic< Uint > m_globalCount;
+
+    TimingWheel< TaskPtr > m_delayedTasks;
+
+    std::atomic< Int64 > m_nextDueTicks;  // Next advance time of the wheel since the clock epoch, max if none.
+
+    std::atomic< Uint > m_sleepingCount;
+    std::atomic< Uint > m_pendingCount;  // Submitted but not done yet.
+
+    Uint m_startedCount;
+    std::condition_variable m_started;
+
+    Bool m_shuttingDown;  // Delayed tasks are cancelled.
+    Bool m_stopping;
+    Bool m_joined;
+
+    std::atomic< Uint64 > m_runCount;
+    std::atomic< Uint64 > m_cancelledCount;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_TASK_TASK_STEALING_POOL_IMPL_H
@@ -0,0 +1,95 @@
+// Caramel C++ Library - Task Facility - Task Thread Pool Private Header
+
+#ifndef __CARAMEL_TASK_TASK_THREAD_POOL_IMPL_H
+#define __CARAMEL_TASK_TASK_THREAD_POOL_IMPL_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include "Task/TaskImpl.h"
+#include <Caramel/Chrono/TimingWheel.h>
+#include <Caramel/Task/TaskThreadPool.h>
+#include <Caramel/Thread/Thread.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+
+namespace Caramel
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Thread Pool
+//
+
+class TaskThreadPoolImpl : public DelayedTaskHost
+                         , public std::enable_shared_from_this< TaskThreadPoolImpl >
+{
+    friend class TaskThreadPool;
+
+public:
+
+    TaskThreadPoolImpl( const std::string& name, Uint numThreads );
+
+    void Submit( TaskPtr task );
+
+    void Drain();
+    void Shutdown();
+
+    void CancelDelayed( Uint64 timerId, Bool repeating ) override;
+
+
+private:
+
+    /// Internal Functions ///
+
+    void RunWorker();
+
+    // Returns false if the workers should stop.
+    // REMARKS: The m_mutex should have been locked.
+    Bool WaitReadyTask( std::unique_lock< std::mutex >& ulock, TaskPtr& task );
+
+    void PromoteDueTasks( const TickPoint& now );
+
+    // Cancel all tasks in the timing wheel, with m_mutex unlocked meanwhile.
+    // REMARKS: The m_mutex should have been locked.
+    void CancelAllDelayed( std::unique_lock< std::mutex >& ulock );
+
+    Bool IsWorkerThread() const;
+
+    // Returns false if the task has been cancelled.
+    // REMARKS: The m_mutex should have been locked.
+    Bool ScheduleDelayed( const TaskPtr& task, const TickPoint& dueTime );
+
+
+    /// Data Members ///
+
+    std::string m_name;
+
+    std::vector< std::unique_ptr< Thread > > m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_taskReady;
+    std::condition_variable m_drained;
+
+    std::deque< TaskPtr > m_readyTasks;
+
+    TimingWheel< TaskPtr > m_delayedTasks;
+
+    Uint m_pendingCount;  // Submitted but not done yet.
+    Bool m_shuttingDown;  // Delayed tasks are cancelled.
+    Bool m_stopping;
+    Bool m_joined;
+
+    std::atomic< Uint64 > m_runCount;
+    std::atomic< Uint64 > m_cancelledCount;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_TASK_TASK_THREAD_POOL_IMPL_H
@@ -2,10 +2,14 @@
 
 #include "CaramelPch.h"
 
+#include "Thread/LockContentionManager.h"
 #include "Thread/ThreadIdImpl.h"
 #include "Thread/ThreadImpl.h"
 #include <Caramel/Error/CatchException.h>
+#include <Caramel/String/Sprintf.h>
+#include <Caramel/Thread/LockContention.h>
 #include <Caramel/Thread/ThisThread.h>
+#include <boost/chrono/system_clocks.hpp>
 #include <sstream>
 
 #if defined( CARAMEL_SYSTEM_IS_WINDOWS )
@@ -24,6 +28,8 @@ namespace Caramel
 //   Thread
 //   ThreadId
 //   ThisThread
+//   TrackedMutex
+//   LockContention
 //
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -211,6 +217,192 @@ void ThisThread::SleepFor( const Ticks& duration )
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Tracked Mutex
+//
+
+static Int64 NowInMicros()
+{
+    return boost::chrono::duration_cast< boost::chrono::microseconds >(
+        boost::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+
+void TrackedMutex::SetName( const std::string& name )
+{
+    m_entry = LockContentionManager::Instance()->GetEntry( name );
+}
+
+
+void TrackedMutex::LockTracked()
+{
+    if ( ! m_mutex.try_lock() )
+    {
+        const Int64 waitStart = NowInMicros();
+        m_mutex.lock();
+        m_entry->AddContention( NowInMicros() - waitStart );
+    }
+
+    m_entry->AddAcquisition();
+
+    m_tracking = true;
+    m_acquiredMicros = NowInMicros();
+}
+
+
+void TrackedMutex::UnlockTracked()
+{
+    m_tracking = false;
+    m_entry->UpdateHold( NowInMicros() - m_acquiredMicros );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Lock Contention
+//
+
+void LockContention::Enable()
+{
+    LockContentionManager::Instance()->enabled = true;
+}
+
+
+void LockContention::Disable()
+{
+    LockContentionManager::Instance()->enabled = false;
+}
+
+
+Bool LockContention::IsEnabled()
+{
+    return LockContentionManager::Instance()->enabled.load( std::memory_order_relaxed );
+}
+
+
+void LockContention::Reset()
+{
+    LockContentionManager::Instance()->Reset();
+}
+
+
+void LockContention::ReportToTrace()
+{
+    LockContentionManager::Instance()->ReportToTrace();
+}
+
+
+//
+// Manager
+//
+
+LockContentionManager::LockContentionManager()
+    : enabled( false )
+{
+}
+
+
+Detail::LockContentionEntry* LockContentionManager::GetEntry( const std::string& name )
+{
+    auto ulock = UniqueLock( m_entriesMutex );
+
+    auto& entry = m_entries[ name ];
+    if ( ! entry )
+    {
+        entry.reset( new Detail::LockContentionEntry );
+    }
+
+    return entry.get();
+}
+
+
+void LockContentionManager::Reset()
+{
+    auto ulock = UniqueLock( m_entriesMutex );
+
+    for ( auto iter = m_entries.begin(); m_entries.end() != iter; ++ iter )
+    {
+        iter->second->Reset();
+    }
+}
+
+
+void LockContentionManager::ReportToTrace()
+{
+    auto ulock = UniqueLock( m_entriesMutex );
+
+    CARAMEL_TRACE_DEBUG( "<Lock Contention Report>" );
+
+    for ( auto iter = m_entries.begin(); m_entries.end() != iter; ++ iter )
+    {
+        const Detail::LockContentionEntry& entry = *iter->second;
+
+        const Uint64 acquisitions = entry.acquisitions;
+        if ( 0 == acquisitions ) { continue; }
+
+        const std::string counts = Sprintf( "%llu / %llu contended",
+            acquisitions, static_cast< Uint64 >( entry.contentions ));
+
+        const std::string times = Sprintf( "wait %lld us, max hold %lld us",
+            static_cast< Int64 >( entry.totalWaitMicros ), static_cast< Int64 >( entry.maxHoldMicros ));
+
+        CARAMEL_TRACE_DEBUG( "[%s] : %s, %s", iter->first, counts, times );
+    }
+}
+
+
+//
+// Entry
+//
+
+namespace Detail
+{
+
+LockContentionEntry::LockContentionEntry()
+    : acquisitions( 0 )
+    , contentions( 0 )
+    , totalWaitMicros( 0 )
+    , maxHoldMicros( 0 )
+{
+}
+
+
+void LockContentionEntry::AddAcquisition()
+{
+    acquisitions.fetch_add( 1, std::memory_order_relaxed );
+}
+
+
+void LockContentionEntry::AddContention( Int64 waitMicros )
+{
+    contentions.fetch_add( 1, std::memory_order_relaxed );
+    totalWaitMicros.fetch_add( waitMicros, std::memory_order_relaxed );
+}
+
+
+void LockContentionEntry::UpdateHold( Int64 holdMicros )
+{
+    Int64 maxHold = maxHoldMicros.load( std::memory_order_relaxed );
+
+    while ( holdMicros > maxHold
+         && ! maxHoldMicros.compare_exchange_weak( maxHold, holdMicros, std::memory_order_relaxed ))
+    {
+    }
+}
+
+
+void LockContentionEntry::Reset()
+{
+    acquisitions = 0;
+    contentions = 0;
+    totalWaitMicros = 0;
+    maxHoldMicros = 0;
+}
+
+} // namespace Detail
+
+
 ///////////////////////////////////////////////////////////////////////////////
 
 } // namespace Caramel
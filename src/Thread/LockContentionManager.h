@@ -0,0 +1,87 @@
+// Caramel C++ Library - Thread Facility - Lock Contention Manager Header
+
+#ifndef __CARAMEL_THREAD_LOCK_CONTENTION_MANAGER_H
+#define __CARAMEL_THREAD_LOCK_CONTENTION_MANAGER_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include "Object/FacilityLongevity.h"
+#include <Caramel/Object/Singleton.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+
+
+namespace Caramel
+{
+
+namespace Detail
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Lock Contention Entry
+// - Counters of one name. Times are in microseconds.
+//
+
+class LockContentionEntry
+{
+public:
+
+    LockContentionEntry();
+
+    void AddAcquisition();
+    void AddContention( Int64 waitMicros );
+    void UpdateHold( Int64 holdMicros );
+
+    void Reset();
+
+    std::atomic< Uint64 > acquisitions;
+    std::atomic< Uint64 > contentions;
+    std::atomic< Int64 >  totalWaitMicros;
+    std::atomic< Int64 >  maxHoldMicros;
+};
+
+} // namespace Detail
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Lock Contention Manager
+//
+
+class LockContentionManager : public Singleton< LockContentionManager, FACILITY_LONGEVITY_LOCK_CONTENTION >
+{
+public:
+
+    LockContentionManager();
+
+    // Returns the entry of the name, create one if not exists.
+    // The entry is valid until the manager is destroyed.
+    Detail::LockContentionEntry* GetEntry( const std::string& name );
+
+    void Reset();
+
+    void ReportToTrace();
+
+
+    /// Properties ///
+
+    std::atomic< Bool > enabled;
+
+
+private:
+
+    typedef std::map< std::string, std::unique_ptr< Detail::LockContentionEntry > > EntryMap;
+    EntryMap m_entries;
+
+    std::mutex m_entriesMutex;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_THREAD_LOCK_CONTENTION_MANAGER_H
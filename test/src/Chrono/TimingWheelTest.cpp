@@ -0,0 +1,275 @@
+// Caramel C++ Library Test - Chrono - Timing Wheel Test
+
+#include "CaramelTestPch.h"
+
+#include <Caramel/Chrono/TimingWheel.h>
+#include <Caramel/Concurrent/PriorityQueue.h>
+#include <UnitTest++/UnitTest++.h>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+
+namespace Caramel
+{
+
+SUITE( TimingWheelSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Timing Wheel Test
+//
+
+TEST( TimingWheelTest )
+{
+    const TickPoint start = TickClock::Now();
+
+    TimingWheel< Int > wheel( start );
+
+    CHECK( true == wheel.IsEmpty() );
+
+    TickPoint next;
+    CHECK( false == wheel.GetNextAdvanceTime( next ));
+
+    wheel.Schedule( start + Ticks( 300 ), 3 );
+    wheel.Schedule( start + Ticks( 100 ), 1 );
+    const auto id2 = wheel.Schedule( start + Ticks( 200 ), 2 );
+    wheel.Schedule( start + Ticks( 70000 ), 4 );
+
+    CHECK( 4 == wheel.Size() );
+
+    // Within 256 ticks, it is exact.
+    CHECK( true == wheel.GetNextAdvanceTime( next ));
+    CHECK( start + Ticks( 100 ) == next );
+
+    std::vector< Int > values;
+
+    wheel.PopAllUntil( start + Ticks( 99 ), values );
+    CHECK( true == values.empty() );
+
+    wheel.PopAllUntil( start + Ticks( 100 ), values );
+    CHECK( 1 == values.size() );
+    CHECK( 1 == values[0] );
+
+
+    /// Cancel ///
+
+    CHECK( true == wheel.Cancel( id2 ));
+    CHECK( false == wheel.Cancel( id2 ));
+    CHECK( false == wheel.Cancel( 0 ));
+    CHECK( 2 == wheel.Size() );
+
+    // The freed node is reused, the old ID doesn't cancel the new timer.
+    const auto id5 = wheel.Schedule( start + Ticks( 250 ), 5 );
+    CHECK( id2 != id5 );
+    CHECK( false == wheel.Cancel( id2 ));
+
+    values.clear();
+    wheel.PopAllUntil( start + Ticks( 1000 ), values );
+
+    CHECK( 2 == values.size() );
+    CHECK( 5 == values[0] );
+    CHECK( 3 == values[1] );
+
+    CHECK( false == wheel.Cancel( id5 ));
+
+
+    /// Higher level ///
+
+    // The next advance is the re-hashing, not later than the due time.
+    CHECK( true == wheel.GetNextAdvanceTime( next ));
+    CHECK( start + Ticks( 70000 ) >= next );
+    CHECK( start + Ticks( 1000 ) < next );
+
+    values.clear();
+    wheel.PopAllUntil( start + Ticks( 69999 ), values );
+    CHECK( true == values.empty() );
+
+    wheel.PopAllUntil( start + Ticks( 70000 ), values );
+    CHECK( 1 == values.size() );
+    CHECK( 4 == values[0] );
+
+    CHECK( true == wheel.IsEmpty() );
+
+
+    /// Already due ///
+
+    wheel.Schedule( start, 6 );
+
+    values.clear();
+    wheel.PopAllUntil( start + Ticks( 70000 ), values );
+    CHECK( 1 == values.size() );
+    CHECK( 6 == values[0] );
+
+
+    /// Clear ///
+
+    wheel.Schedule( start + Ticks( 80000 ), 7 );
+    wheel.Schedule( start + Ticks( 90000 ), 8 );
+    wheel.Clear();
+
+    CHECK( true == wheel.IsEmpty() );
+
+    values.clear();
+    wheel.PopAllUntil( start + Ticks( 100000 ), values );
+    CHECK( true == values.empty() );
+
+
+    /// Pop All ///
+
+    wheel.Schedule( start + Ticks( 100000 ), 9 );
+    wheel.Schedule( start + Ticks( 10000000 ), 10 );
+    wheel.PopAll( values );
+
+    CHECK( true == wheel.IsEmpty() );
+    CHECK( 2 == values.size() );
+    CHECK( 19 == values[0] + values[1] );
+}
+
+
+TEST( TimingWheelRandomTest )
+{
+    // Compare with a std::multimap, over short and very long ( > 2^32 ticks ) delays.
+
+    const TickPoint start = TickClock::Now();
+
+    TimingWheel< Int > wheel( start );
+    std::multimap< Int64, Int > expected;
+    std::map< Int, TimingWheel< Int >::TimerId > ids;
+
+    std::mt19937 random( 1 );
+
+    Int64 now = 0;
+    Int nextValue = 0;
+    Bool allMatch = true;
+
+    for ( Int round = 0; round < 2000; ++ round )
+    {
+        for ( Int i = 0; i < 10; ++ i )
+        {
+            Int64 delay = 0;
+            switch ( random() % 4 )
+            {
+            case 0: delay = random() % 300; break;
+            case 1: delay = random() % 100000; break;
+            case 2: delay = random() % 20000000; break;
+            case 3: delay = static_cast< Int64 >( random() % 20 ) << 30; break;
+            }
+
+            const Int value = nextValue ++;
+            ids[ value ] = wheel.Schedule( start + Ticks( now + delay ), value );
+            expected.insert( std::make_pair( now + delay, value ));
+        }
+
+        // Cancel one in a while.
+        if ( 0 == round % 3 && ! expected.empty() )
+        {
+            auto iter = expected.begin();
+            std::advance( iter, random() % expected.size() );
+
+            allMatch = allMatch && wheel.Cancel( ids[ iter->second ]);
+            expected.erase( iter );
+        }
+
+        // Advance, sometimes by a long idle time.
+        now += ( 0 == round % 100 ) ? ( static_cast< Int64 >( random() % 8 ) << 30 ) : random() % 5000;
+
+        std::vector< Int > values;
+        wheel.PopAllUntil( start + Ticks( now ), values );
+
+        std::vector< Int > expectedValues;
+        while ( ! expected.empty() && expected.begin()->first <= now )
+        {
+            expectedValues.push_back( expected.begin()->second );
+            expected.erase( expected.begin() );
+        }
+
+        std::sort( values.begin(), values.end() );
+        std::sort( expectedValues.begin(), expectedValues.end() );
+
+        allMatch = allMatch && ( expectedValues == values );
+        allMatch = allMatch && ( expected.size() == wheel.Size() );
+    }
+
+    CHECK( true == allMatch );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Benchmark
+// - Many short timeouts, most of them cancelled, compared with the heap
+//   which TaskPoller used. The heap can't cancel, its timeouts expire as no-ops.
+//   The results are reported to the trace, no assertion on timings.
+//
+
+const Int BENCH_TIMERS = 200000;
+
+
+TEST( TimingWheelBenchmarkTest )
+{
+    const TickPoint start = TickClock::Now();
+
+    std::vector< Int > values;
+
+    /// Heap ///
+
+    TickClock clock;
+    {
+        Concurrent::PriorityQueue< TickPoint, Int, std::greater< TickPoint > > heap;
+
+        for ( Int i = 0; i < BENCH_TIMERS; ++ i )
+        {
+            heap.Push( start + Ticks( 1 + i % 5000 ), i );
+        }
+
+        for ( Int64 now = 0; now <= 5000; now += 10 )
+        {
+            heap.PopAllUntil( start + Ticks( now ), values );
+        }
+    }
+    const Int heapMs = clock.Slice().ToInt32();
+
+    CHECK( BENCH_TIMERS == values.size() );
+    values.clear();
+
+
+    /// Timing Wheel ///
+
+    {
+        TimingWheel< Int > wheel( start );
+        std::vector< TimingWheel< Int >::TimerId > ids( BENCH_TIMERS );
+
+        for ( Int i = 0; i < BENCH_TIMERS; ++ i )
+        {
+            ids[i] = wheel.Schedule( start + Ticks( 1 + i % 5000 ), i );
+        }
+
+        // Cancel 90% of them.
+        for ( Int i = 0; i < BENCH_TIMERS; ++ i )
+        {
+            if ( 0 != i % 10 ) { wheel.Cancel( ids[i] ); }
+        }
+
+        for ( Int64 now = 0; now <= 5000; now += 10 )
+        {
+            wheel.PopAllUntil( start + Ticks( now ), values );
+        }
+    }
+    const Int wheelMs = clock.Slice().ToInt32();
+
+    CHECK( BENCH_TIMERS / 10 == values.size() );
+
+    CARAMEL_TRACE_INFO( "%d timers : heap %d ms, wheel with 90%% cancelled %d ms", BENCH_TIMERS, heapMs, wheelMs );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE TimingWheelSuite
+
+} // namespace Caramel
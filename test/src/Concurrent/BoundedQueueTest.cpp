@@ -0,0 +1,124 @@
+// Caramel C++ Library Test - Concurrent - Bounded Queue Test
+
+#include "CaramelTestPch.h"
+
+#include <Caramel/Concurrent/BoundedQueue.h>
+#include <Caramel/Thread/Thread.h>
+#include <UnitTest++/UnitTest++.h>
+#include <atomic>
+#include <thread>
+
+
+namespace Caramel
+{
+
+SUITE( BoundedQueueSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Bounded Queue Test
+//
+
+TEST( BoundedQueueTest )
+{
+    typedef Concurrent::BoundedQueue< std::string, 4 > QueueType;
+    QueueType queue;
+
+    CHECK( 4 == queue.GetCapacity() );
+    CHECK( true == queue.IsEmpty() );
+
+    std::string value;
+    CHECK( false == queue.TryPop( value ));
+
+    queue.Push( "Reimu" );
+    queue.Push( "Marisa" );
+
+    CHECK( true == queue.TryPush( "Alice" ));
+    CHECK( true == queue.TryPush( "Sakuya" ));
+
+    // Full
+    CHECK( false == queue.TryPush( "Pachouli" ));
+    CHECK( false == queue.IsEmpty() );
+
+    CHECK( true == queue.TryPop( value ));
+    CHECK( "Reimu" == value );
+
+    // A slot is released, and the ring wraps around.
+    CHECK( true == queue.TryPush( "Pachouli" ));
+
+    CHECK( true == queue.TryPop( value ));
+    CHECK( "Marisa" == value );
+
+    CHECK( true == queue.TryPop( value ));
+    CHECK( "Alice" == value );
+
+    CHECK( true == queue.TryPop( value ));
+    CHECK( "Sakuya" == value );
+
+    CHECK( true == queue.TryPop( value ));
+    CHECK( "Pachouli" == value );
+
+    CHECK( false == queue.TryPop( value ));
+    CHECK( true == queue.IsEmpty() );
+}
+
+
+TEST( BoundedQueueRaceTest )
+{
+    typedef Concurrent::BoundedQueue< Int, 64 > QueueType;
+    QueueType queue;
+
+    const Int LOOP = 10000;
+
+    std::atomic< Int > popCount( 0 );
+    std::atomic< Int64 > popSum( 0 );
+
+    auto produce = [&]
+    {
+        for ( Int i = 1; i <= LOOP; ++ i )
+        {
+            queue.Push( i );
+        }
+    };
+
+    auto consume = [&]
+    {
+        Int value = 0;
+        while ( popCount < LOOP * 2 )
+        {
+            if ( queue.TryPop( value ))
+            {
+                popSum += value;
+                ++ popCount;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    Thread p1( "Produce1", produce );
+    Thread p2( "Produce2", produce );
+    Thread c1( "Consume1", consume );
+    Thread c2( "Consume2", consume );
+
+    p1.Join();
+    p2.Join();
+    c1.Join();
+    c2.Join();
+
+    const Int64 expected = static_cast< Int64 >( LOOP ) * ( LOOP + 1 );  // 2 x sum of 1 .. LOOP
+
+    CHECK( LOOP * 2 == popCount );
+    CHECK( expected == popSum );
+    CHECK( true == queue.IsEmpty() );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE BoundedQueueSuite
+
+} // namespace Caramel
@@ -0,0 +1,215 @@
+// Caramel C++ Library Test - Concurrent - Cache Test
+
+#include "CaramelTestPch.h"
+
+#include "Trace/CaptureListener.h"
+#include <Caramel/Concurrent/Cache.h>
+#include <Caramel/Functional/ScopeExit.h>
+#include <Caramel/Thread/ThisThread.h>
+#include <Caramel/Thread/Thread.h>
+#include <UnitTest++/UnitTest++.h>
+#include <atomic>
+#include <stdexcept>
+
+
+namespace Caramel
+{
+
+SUITE( ConcurrentCacheSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// LRU Cache Test
+//
+
+TEST( LruCacheTest )
+{
+    // One shard, so the eviction order is exact.
+    typedef Concurrent::Cache< Int, std::string, Concurrent::EvictLru, 1 > CacheType;
+    CacheType cache( 3 );
+
+    CHECK( 3 == cache.GetCapacity() );
+    CHECK( true == cache.IsEmpty() );
+
+    CHECK( true == cache.Upsert( 1, "Reimu" ));
+    CHECK( true == cache.Upsert( 2, "Marisa" ));
+    CHECK( true == cache.Upsert( 3, "Alice" ));
+    CHECK( false == cache.Upsert( 3, "Sakuya" ));
+    CHECK( 3 == cache.Size() );
+
+    // Touch 1, then 2 is the least recently used.
+
+    std::string value;
+    CHECK( true == cache.Find( 1, value ));
+    CHECK( "Reimu" == value );
+
+    cache.Upsert( 4, "Pachouli" );
+
+    CHECK( 3 == cache.Size() );
+    CHECK( false == cache.Contains( 2 ));
+    CHECK( true == cache.Contains( 1 ));
+    CHECK( true == cache.Contains( 3 ));
+    CHECK( true == cache.Contains( 4 ));
+
+    CHECK( true == cache.Find( 3, value ));
+    CHECK( "Sakuya" == value );
+
+    CHECK( true == cache.Erase( 3 ));
+    CHECK( false == cache.Erase( 3 ));
+    CHECK( 2 == cache.Size() );
+
+    const Concurrent::CacheStats stats = cache.GetStats();
+    CHECK( 2 == stats.hits );
+    CHECK( 0 == stats.misses );
+    CHECK( 1 == stats.evictions );
+
+    cache.Clear();
+    CHECK( true == cache.IsEmpty() );
+    CHECK( false == cache.Find( 1, value ));
+    CHECK( 1 == cache.GetStats().misses );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// TinyLFU Cache Test
+//
+
+template< typename CacheType >
+static Uint CountHotHits( CacheType& cache )
+{
+    const Int HOT_KEYS = 50;
+
+    // Make the hot keys popular.
+    for ( Int round = 0; round < 5; ++ round )
+    {
+        for ( Int i = 0; i < HOT_KEYS; ++ i )
+        {
+            cache.GetOrLoad( i, [=] { return i; } );
+        }
+    }
+
+    // A long scan of keys accessed only once.
+    for ( Int i = 1000; i < 3000; ++ i )
+    {
+        cache.GetOrLoad( i, [=] { return i; } );
+    }
+
+    Uint hits = 0;
+    Int value = 0;
+    for ( Int i = 0; i < HOT_KEYS; ++ i )
+    {
+        if ( cache.Find( i, value )) { ++ hits; }
+    }
+    return hits;
+}
+
+
+TEST( TinyLfuCacheTest )
+{
+    Concurrent::Cache< Int, Int, Concurrent::EvictLru, 4 > lru( 100 );
+    Concurrent::Cache< Int, Int, Concurrent::EvictTinyLfu, 4 > tinyLfu( 100 );
+
+    // LRU is flushed by the scan, while TinyLFU keeps the hot keys.
+
+    CHECK( 0 == CountHotHits( lru ));
+    CHECK( 40 <= CountHotHits( tinyLfu ));
+
+    CHECK( 100 >= tinyLfu.Size() );
+    CHECK( 0 < tinyLfu.GetStats().evictions );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Get or Load Test
+//
+
+TEST( CacheGetOrLoadTest )
+{
+    typedef Concurrent::Cache< Int, std::string > CacheType;
+    CacheType cache( 64 );
+
+    std::atomic< Uint > loads( 0 );
+
+    auto slowLoader = [&]
+    {
+        ++ loads;
+        ThisThread::SleepFor( Ticks( 50 ));
+        return std::string( "Reimu" );
+    };
+
+    // Concurrent misses of the same key are collapsed into one load.
+
+    std::string v1, v2, v3;
+
+    Thread t1( "Loader1", [&] { v1 = cache.GetOrLoad( 1, slowLoader ); } );
+    Thread t2( "Loader2", [&] { v2 = cache.GetOrLoad( 1, slowLoader ); } );
+    Thread t3( "Loader3", [&] { v3 = cache.GetOrLoad( 1, slowLoader ); } );
+
+    t1.Join();
+    t2.Join();
+    t3.Join();
+
+    CHECK( 1 == loads );
+    CHECK( "Reimu" == v1 );
+    CHECK( "Reimu" == v2 );
+    CHECK( "Reimu" == v3 );
+
+    CHECK( "Reimu" == cache.GetOrLoad( 1, [] { return std::string( "Marisa" ); } ));
+
+    const Concurrent::CacheStats stats = cache.GetStats();
+    CHECK( 1 == stats.loads );
+    CHECK( 1 == stats.hits );
+    CHECK( 3 == stats.misses );
+
+
+    /// Loader throws ///
+
+    auto badLoader = [] () -> std::string { throw std::runtime_error( "Not found" ); };
+
+    CHECK_THROW( cache.GetOrLoad( 2, badLoader ), std::runtime_error );
+    CHECK( false == cache.Contains( 2 ));
+
+    // Not cached, so the next load is called.
+    CHECK( "Alice" == cache.GetOrLoad( 2, [] { return std::string( "Alice" ); } ));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Report Test
+//
+
+TEST( CacheReportTest )
+{
+    Concurrent::Cache< Int, Int, Concurrent::EvictLru, 1 > cache( 2 );
+
+    cache.Upsert( 1, 1 );
+    cache.Upsert( 2, 2 );
+    cache.Upsert( 3, 3 );
+
+    Int value = 0;
+    cache.Find( 3, value );
+    cache.Find( 4, value );
+    cache.GetOrLoad( 5, [] { return 5; } );
+
+    CaptureListener listener;
+    listener.BindBuiltinChannels( Trace::LEVEL_DEBUG );
+    auto unbind = ScopeExit( [&] { listener.UnbindAllChannels(); } );
+
+    cache.ReportToTrace( "Stage" );
+
+    CHECK( "[Stage] : hits 1, misses 2, hit rate 33.3%, loads 1, evictions 2, size 2" == listener.Last() );
+
+    cache.ResetStats();
+    CHECK( 0 == cache.GetStats().misses );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE ConcurrentCacheSuite
+
+} // namespace Caramel
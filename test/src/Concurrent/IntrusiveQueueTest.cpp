@@ -0,0 +1,125 @@
+// Caramel C++ Library Test - Concurrent - Intrusive Queue Test
+
+#include "CaramelTestPch.h"
+
+#include <Caramel/Concurrent/IntrusiveQueue.h>
+#include <Caramel/Thread/Thread.h>
+#include <UnitTest++/UnitTest++.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+namespace Caramel
+{
+
+SUITE( IntrusiveQueueSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Intrusive Queue Test
+//
+
+struct Item : public Concurrent::IntrusiveQueueNode
+{
+    Item() : producer( 0 ), value( 0 ) {}
+
+    Int producer;
+    Int value;
+};
+
+
+TEST( IntrusiveQueueTest )
+{
+    Concurrent::IntrusiveQueue< Item > queue;
+
+    CHECK( nullptr == queue.TryPop() );
+
+    Item items[3];
+    for ( Int i = 0; i < 3; ++ i )
+    {
+        items[i].value = i;
+        queue.Push( &items[i] );
+    }
+
+    CHECK( &items[0] == queue.TryPop() );
+    CHECK( &items[1] == queue.TryPop() );
+
+    // A popped node can be pushed again.
+    queue.Push( &items[0] );
+
+    CHECK( &items[2] == queue.TryPop() );
+    CHECK( &items[0] == queue.TryPop() );
+    CHECK( nullptr == queue.TryPop() );
+
+    queue.Push( &items[1] );
+
+    CHECK( &items[1] == queue.TryPop() );
+    CHECK( nullptr == queue.TryPop() );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Intrusive Queue Race Test
+// - Each producer's items come out in its order.
+//
+
+TEST( IntrusiveQueueRaceTest )
+{
+    const Int NUM_PRODUCERS = 4;
+    const Int NUM_ITEMS = 10000;
+
+    Concurrent::IntrusiveQueue< Item > queue;
+
+    std::vector< Item > items( NUM_PRODUCERS * NUM_ITEMS );
+    std::vector< std::unique_ptr< Thread >> producers;
+
+    for ( Int p = 0; p < NUM_PRODUCERS; ++ p )
+    {
+        producers.emplace_back( new Thread( "Producer", [&, p]
+        {
+            for ( Int i = 0; i < NUM_ITEMS; ++ i )
+            {
+                Item& item = items[ p * NUM_ITEMS + i ];
+                item.producer = p;
+                item.value = i;
+                queue.Push( &item );
+            }
+        }));
+    }
+
+    std::vector< Int > expected( NUM_PRODUCERS, 0 );
+    Int popped = 0;
+    Bool ordered = true;
+
+    while ( NUM_PRODUCERS * NUM_ITEMS > popped )
+    {
+        Item* item = queue.TryPop();
+        if ( ! item )
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        ordered = ordered && ( expected[ item->producer ] == item->value );
+        expected[ item->producer ] = item->value + 1;
+        ++ popped;
+    }
+
+    for ( Uint i = 0; i < producers.size(); ++ i )
+    {
+        producers[i]->Join();
+    }
+
+    CHECK( true == ordered );
+    CHECK( nullptr == queue.TryPop() );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE IntrusiveQueueSuite
+
+} // namespace Caramel
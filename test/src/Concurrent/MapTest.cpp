@@ -3,7 +3,17 @@
 #include "CaramelTestPch.h"
 
 #include <Caramel/Concurrent/Map.h>
+#include <Caramel/Concurrent/FlatHashMap.h>
 #include <Caramel/Concurrent/HashMap.h>
+#include <Caramel/Concurrent/StripedHashMap.h>
+#include <Caramel/Thread/Thread.h>
+#include <boost/chrono.hpp>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include <UnitTest++/UnitTest++.h>
 
 
@@ -73,6 +83,621 @@ TEST( ConcurrentHashMapTest )
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Concurrent Map Compound Operations Test
+//
+
+TEST( ConcurrentMapCompoundTest )
+{
+    typedef Concurrent::Map< Int, std::string > MapType;
+    MapType map;
+
+    /// Insert Range ///
+
+    std::vector< std::pair< Int, std::string > > inputs;
+    inputs.push_back( std::make_pair( 1, "Reimu" ));
+    inputs.push_back( std::make_pair( 2, "Marisa" ));
+    inputs.push_back( std::make_pair( 2, "Alice" ));
+
+    CHECK( 2 == map.InsertRange( inputs.begin(), inputs.end() ));
+    CHECK( 2 == map.Size() );
+
+    /// Find Many ///
+
+    std::vector< Int > keys;
+    keys.push_back( 2 );
+    keys.push_back( 3 );
+    keys.push_back( 1 );
+
+    std::vector< std::pair< Int, std::string > > founds;
+
+    CHECK( 2 == map.FindMany( keys.begin(), keys.end(), std::back_inserter( founds )));
+    CHECK( 2 == founds.size() );
+    CHECK( 2 == founds[0].first && "Marisa" == founds[0].second );
+    CHECK( 1 == founds[1].first && "Reimu" == founds[1].second );
+
+    /// Upsert ///
+
+    std::string temp;
+
+    CHECK( false == map.Upsert( 2, "Alice" ));
+    CHECK( true == map.Find( 2, temp ));
+    CHECK( "Alice" == temp );
+
+    CHECK( true == map.Upsert( 3, "Sakuya" ));
+    CHECK( 3 == map.Size() );
+
+    /// Compute If Absent ///
+
+    Int calls = 0;
+    auto factory = [&] { ++ calls; return std::string( "Youmu" ); };
+
+    CHECK( "Reimu" == map.ComputeIfAbsent( 1, factory ));
+    CHECK( 0 == calls );
+
+    CHECK( "Youmu" == map.ComputeIfAbsent( 4, factory ));
+    CHECK( "Youmu" == map.ComputeIfAbsent( 4, factory ));
+    CHECK( 1 == calls );
+
+    /// Erase ///
+
+    CHECK( true == map.Erase( 4 ));
+    CHECK( false == map.Erase( 4 ));
+    CHECK( false == map.Contains( 4 ));
+
+    /// For Each ///
+
+    std::string names;
+    map.ForEach( [&] ( Int, const std::string& name ) { names += name; } );
+
+    CHECK( "ReimuAliceSakuya" == names );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Replicate Snapshot Test
+//
+
+TEST( ReplicateSnapshotTest )
+{
+    typedef Concurrent::HashMap< Int, std::string, Concurrent::ReplicateSnapshot > MapType;
+    MapType map;
+
+    auto snap0 = map.GetSnapshot();
+
+    CHECK( true == snap0.IsEmpty() );
+
+    map.Insert( 1, "Reimu" );
+    map.Insert( 2, "Marisa" );
+
+    auto snap1 = map.GetSnapshot();
+
+    CHECK( 2 == snap1.Size() );
+    CHECK( true == snap1.Contains( 1 ));
+
+    std::string temp;
+    CHECK( true == snap1.Find( 2, temp ));
+    CHECK( "Marisa" == temp );
+
+    // A failed insertion doesn't publish.
+    CHECK( false == map.Insert( 2, "Alice" ));
+    CHECK( true == map.GetSnapshot().Find( 2, temp ));
+    CHECK( "Marisa" == temp );
+
+    map.Insert( 3, "Alice" );
+
+    // Old snapshots are immutable.
+    CHECK( true == snap0.IsEmpty() );
+    CHECK( 2 == snap1.Size() );
+    CHECK( false == snap1.Contains( 3 ));
+
+    auto snap2 = map.GetSnapshot();
+
+    CHECK( 3 == snap2.Size() );
+
+    Int keySum = 0;
+    std::string::size_type nameLength = 0;
+    for ( auto& entry : snap2 )
+    {
+        keySum += entry.first;
+        nameLength += entry.second.length();
+    }
+
+    CHECK( 6 == keySum );
+    CHECK( std::string( "ReimuMarisaAlice" ).length() == nameLength );
+
+    // Erase and upsert are replicated, too.
+
+    map.Erase( 1 );
+    map.Upsert( 2, "Sakuya" );
+
+    auto snap3 = map.GetSnapshot();
+
+    CHECK( false == snap3.Contains( 1 ));
+    CHECK( true == snap3.Find( 2, temp ));
+    CHECK( "Sakuya" == temp );
+    CHECK( 3 == snap2.Size() );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Replicate Ordered Snapshot Test
+// - Snapshots of an ordered map keep the key order, and need no hash.
+//
+
+struct OrderedOnly
+{
+    OrderedOnly( Int v ) : value( v ) {}
+
+    Bool operator<( const OrderedOnly& rhs ) const { return value < rhs.value; }
+
+    Int value;
+};
+
+
+TEST( ReplicateOrderedSnapshotTest )
+{
+    typedef Concurrent::Map< OrderedOnly, std::string, Concurrent::ReplicateSnapshot > MapType;
+    MapType map;
+
+    map.Insert( 3, "Alice" );
+    map.Insert( 1, "Reimu" );
+    map.Insert( 2, "Marisa" );
+
+    std::string names;
+    for ( auto& entry : map.GetSnapshot() )
+    {
+        names += entry.second;
+    }
+
+    CHECK( "ReimuMarisaAlice" == names );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Replicate Batch Test
+// - InsertRange() replicates all keys in one batch.
+//
+
+struct ReplicateCount
+{
+    template< typename Key, typename Value, typename MapT = std::unordered_map< Key, Value > >
+    class Dictionary
+    {
+    public:
+
+        Dictionary() : batches( 0 ), batched( 0 ), unbatched( 0 ), m_inBatch( false ) {}
+
+        Int batches;
+        Int batched;
+        Int unbatched;
+
+    protected:
+
+        void BeginBatch()  { m_inBatch = true; ++ batches; }
+        void CommitBatch() { m_inBatch = false; }
+
+        void Insert( const Key&, const Value& ) { ++ ( m_inBatch ? batched : unbatched ); }
+        void Erase( const Key& ) { ++ ( m_inBatch ? batched : unbatched ); }
+
+    private:
+
+        Bool m_inBatch;
+    };
+};
+
+
+TEST( ReplicateBatchTest )
+{
+    std::vector< std::pair< Int, std::string > > inputs;
+    inputs.push_back( std::make_pair( 1, "Reimu" ));
+    inputs.push_back( std::make_pair( 2, "Marisa" ));
+    inputs.push_back( std::make_pair( 3, "Alice" ));
+
+    /// Hooks ///
+    {
+        Concurrent::HashMap< Int, std::string, ReplicateCount > map;
+
+        map.Insert( 1, "Sakuya" );
+        CHECK( 2 == map.InsertRange( inputs.begin(), inputs.end() ));
+
+        CHECK( 1 == map.batches );
+        CHECK( 2 == map.batched );
+        CHECK( 1 == map.unbatched );
+
+        std::vector< std::pair< Int, Int > > numbers;
+        numbers.push_back( std::make_pair( 1, 1 ));
+        numbers.push_back( std::make_pair( 2, 4 ));
+        numbers.push_back( std::make_pair( 3, 9 ));
+
+        Concurrent::FlatHashMap< Int, Int, ReplicateCount > flat;
+
+        CHECK( 3 == flat.InsertRange( numbers.begin(), numbers.end() ));
+
+        CHECK( 1 == flat.batches );
+        CHECK( 3 == flat.batched );
+        CHECK( 0 == flat.unbatched );
+    }
+
+    /// Snapshot ///
+    {
+        typedef Concurrent::HashMap< Int, std::string, Concurrent::ReplicateSnapshot > MapType;
+        MapType map;
+
+        map.Insert( 1, "Sakuya" );
+
+        auto snap0 = map.GetSnapshot();
+
+        CHECK( 2 == map.InsertRange( inputs.begin(), inputs.end() ));
+
+        auto snap1 = map.GetSnapshot();
+
+        CHECK( 1 == snap0.Size() );
+        CHECK( 3 == snap1.Size() );
+
+        std::string temp;
+        CHECK( true == snap1.Find( 1, temp ));
+        CHECK( "Sakuya" == temp );
+
+        // Nothing inserted, nothing published.
+        CHECK( 0 == map.InsertRange( inputs.begin(), inputs.end() ));
+        CHECK( 3 == map.GetSnapshot().Size() );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Concurrent Striped Hash Map Test
+//
+
+TEST( ConcurrentStripedHashMapTest )
+{
+    typedef Concurrent::StripedHashMap< Int, std::string > MapType;
+    MapType map;
+
+    CHECK( true == map.IsEmpty() );
+    CHECK( 0 == map.Size() );
+
+    map.Insert( 1, "Reimu" );
+    map.Insert( 2, "Marisa" );
+    map.Insert( 3, "Alice" );
+
+    CHECK( false == map.Insert( 3, "Pachouli" ));
+
+    CHECK( false == map.IsEmpty() );
+    CHECK( 3 == map.Size() );
+
+    CHECK( true == map.Contains( 1 ));
+    CHECK( false == map.Contains( 4 ));
+
+    std::string temp;
+    CHECK( true == map.Find( 1, temp ));
+    CHECK( "Reimu" == temp );
+
+    CHECK( false == map.Find( 4, temp ));
+
+    CHECK( false == map.Upsert( 3, "Pachouli" ));
+    CHECK( "Reimu" == map.ComputeIfAbsent( 1, [] { return std::string( "Sakuya" ); } ));
+
+    CHECK( true == map.Erase( 2 ));
+    CHECK( false == map.Contains( 2 ));
+
+    std::string names;
+    map.ForEach( [&] ( Int, const std::string& name ) { names += name; } );
+
+    CHECK( 13 == names.size() );  // "Reimu" + "Pachouli", in any order
+}
+
+
+TEST( ConcurrentStripedHashMapRaceTest )
+{
+    typedef Concurrent::StripedHashMap< Int, Int, 8 > MapType;
+    MapType map;
+
+    const Int COUNT = 10000;
+
+    // Each thread inserts the even or odd keys, and looks up all the others.
+
+    auto work = [&] ( Int parity )
+    {
+        for ( Int i = parity; i < COUNT; i += 2 )
+        {
+            map.Insert( i, i * 2 );
+        }
+
+        Int value = 0;
+        for ( Int i = 0; i < COUNT; ++ i )
+        {
+            if ( map.Find( i, value ))
+            {
+                CHECK( i * 2 == value );
+            }
+        }
+    };
+
+    Thread t1( "Even", [&] { work( 0 ); } );
+    Thread t2( "Odd",  [&] { work( 1 ); } );
+
+    t1.Join();
+    t2.Join();
+
+    CHECK( COUNT == map.Size() );
+    CHECK( true == map.Contains( COUNT - 1 ));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Concurrent Flat Hash Map Test
+//
+
+TEST( ConcurrentFlatHashMapTest )
+{
+    typedef Concurrent::FlatHashMap< Int, Int > MapType;
+    MapType map;
+
+    CHECK( true == map.IsEmpty() );
+    CHECK( 0 == map.Size() );
+
+    map.Insert( 1, 10 );
+    map.Insert( 2, 20 );
+    map.Insert( 3, 30 );
+
+    CHECK( false == map.Insert( 3, 40 ));
+
+    CHECK( false == map.IsEmpty() );
+    CHECK( 3 == map.Size() );
+
+    CHECK( true == map.Contains( 1 ));
+    CHECK( false == map.Contains( 4 ));
+
+    Int temp = 0;
+    CHECK( true == map.Find( 1, temp ));
+    CHECK( 10 == temp );
+
+    CHECK( false == map.Find( 4, temp ));
+
+    CHECK( false == map.Upsert( 3, 40 ));
+    CHECK( 10 == map.ComputeIfAbsent( 1, [] { return 50; } ));
+    CHECK( 50 == map.ComputeIfAbsent( 5, [] { return 50; } ));
+
+    CHECK( true == map.Erase( 2 ));
+    CHECK( false == map.Erase( 2 ));
+    CHECK( false == map.Contains( 2 ));
+
+    Int sum = 0;
+    map.ForEach( [&] ( Int, Int value ) { sum += value; } );
+
+    CHECK( 100 == sum );  // 10 + 40 + 50
+
+
+    /// Growing and Purging ///
+
+    const Int COUNT = 1000;
+
+    for ( Int i = 0; i < COUNT; ++ i )
+    {
+        map.Upsert( i, i * 2 );
+    }
+
+    CHECK( COUNT == map.Size() );
+
+    // Churn : Erase and insert keys over and over, leaving tombstones behind.
+
+    for ( Int round = 0; round < 10; ++ round )
+    {
+        for ( Int i = 0; i < COUNT; i += 2 )
+        {
+            CHECK( true == map.Erase( i ));
+        }
+
+        for ( Int i = 0; i < COUNT; i += 2 )
+        {
+            CHECK( true == map.Insert( i, i * 2 ));
+        }
+    }
+
+    CHECK( COUNT == map.Size() );
+
+    for ( Int i = 0; i < COUNT; ++ i )
+    {
+        CHECK( true == map.Find( i, temp ));
+        CHECK( i * 2 == temp );
+    }
+
+    std::vector< Int > keys;
+    keys.push_back( 7 );
+    keys.push_back( COUNT );
+    keys.push_back( 9 );
+
+    std::vector< std::pair< Int, Int > > found;
+    CHECK( 2 == map.FindMany( keys.begin(), keys.end(), std::back_inserter( found )));
+    CHECK( 9 == found[1].first );
+    CHECK( 18 == found[1].second );
+}
+
+
+TEST( ConcurrentFlatHashMapRaceTest )
+{
+    typedef Concurrent::FlatHashMap< Int, Int64 > MapType;
+    MapType map;
+
+    const Int COUNT = 2000;
+
+    // The writer keeps inserting, updating and erasing keys.
+    // A reader would see a key missing, but never a torn value.
+
+    std::atomic< Bool > done( false );
+
+    Thread writer( "Writer", [&]
+    {
+        for ( Int round = 1; round <= 5; ++ round )
+        {
+            for ( Int i = 0; i < COUNT; ++ i )
+            {
+                map.Upsert( i, static_cast< Int64 >( i ) * round * 0x100000001ll );
+            }
+
+            for ( Int i = round % 2; i < COUNT; i += 2 )
+            {
+                map.Erase( i );
+            }
+        }
+
+        done = true;
+    });
+
+    Bool consistent = true;
+    Int64 value = 0;
+
+    while ( ! done )
+    {
+        for ( Int i = 0; i < COUNT; ++ i )
+        {
+            if ( map.Find( i, value ))
+            {
+                // Both halves of the value must have been written together.
+                consistent = consistent && (( value >> 32 ) == ( value & 0xFFFFFFFF ));
+            }
+        }
+
+        std::this_thread::yield();
+    }
+
+    writer.Join();
+
+    CHECK( true == consistent );
+    CHECK( COUNT / 2 == map.Size() );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Flat Hash Map Benchmark
+// - Lookup latency percentiles and memory per entry, compared with HashMap.
+//   HashMap is measured as Detail::BasicMap over its std::unordered_map,
+//   with an allocator counting the bytes of nodes and buckets.
+//   The results are reported to the trace, no assertion on timings.
+//
+
+const Int BENCH_ENTRIES = 100000;
+const Int BENCH_LOOKUPS = 200000;
+
+static Uint64 s_countedBytes = 0;
+
+template< typename T >
+struct CountingAllocator
+{
+    typedef T value_type;
+
+    template< typename U >
+    struct rebind { typedef CountingAllocator< U > other; };
+
+    CountingAllocator() {}
+
+    template< typename U >
+    CountingAllocator( const CountingAllocator< U >& ) {}
+
+    T* allocate( std::size_t n )
+    {
+        s_countedBytes += n * sizeof( T );
+        return static_cast< T* >( ::operator new( n * sizeof( T )));
+    }
+
+    void deallocate( T* p, std::size_t n )
+    {
+        s_countedBytes -= n * sizeof( T );
+        ::operator delete( p );
+    }
+};
+
+template< typename T, typename U >
+inline Bool operator==( const CountingAllocator< T >&, const CountingAllocator< U >& ) { return true; }
+
+template< typename T, typename U >
+inline Bool operator!=( const CountingAllocator< T >&, const CountingAllocator< U >& ) { return false; }
+
+
+// Time each lookup, half of the keys are missing. Returns the sorted latencies in nanoseconds.
+template< typename MapType >
+static std::vector< Int64 > BenchmarkLookups( const MapType& map, Int64& sum )
+{
+    typedef boost::chrono::steady_clock HighResClock;
+
+    std::vector< Int64 > nanos( BENCH_LOOKUPS );
+    Int64 value = 0;
+
+    for ( Int i = 0; i < BENCH_LOOKUPS; ++ i )
+    {
+        const Int key = static_cast< Int >(( i * 7919ll ) % ( BENCH_ENTRIES * 2 ));
+
+        const auto start = HighResClock::now();
+        const Bool found = map.Find( key, value );
+        const auto elapsed = HighResClock::now() - start;
+
+        if ( found ) { sum += value; }
+
+        nanos[i] = boost::chrono::duration_cast< boost::chrono::nanoseconds >( elapsed ).count();
+    }
+
+    std::sort( nanos.begin(), nanos.end() );
+    return nanos;
+}
+
+
+static void ReportLookups( const Char* name, const std::vector< Int64 >& nanos, Uint64 bytes )
+{
+    CARAMEL_TRACE_INFO( "%s : %.1f bytes per entry", name, static_cast< Double >( bytes ) / BENCH_ENTRIES );
+    CARAMEL_TRACE_INFO( "%s : lookup p50 %d ns, p99 %d ns, p99.9 %d ns", name,
+        nanos[ nanos.size() / 2 ], nanos[ nanos.size() * 99 / 100 ], nanos[ nanos.size() * 999 / 1000 ] );
+}
+
+
+TEST( FlatHashMapBenchmarkTest )
+{
+    typedef std::unordered_map< Int, Int64, std::hash< Int >, std::equal_to< Int >,
+        CountingAllocator< std::pair< const Int, Int64 > > > CountedMapType;
+
+    Int64 hashSum = 0;
+    Int64 flatSum = 0;
+
+    /// HashMap ///
+    {
+        s_countedBytes = 0;
+
+        Concurrent::Detail::BasicMap< CountedMapType, Concurrent::ReplicateNothing > map;
+
+        for ( Int i = 0; i < BENCH_ENTRIES; ++ i )
+        {
+            map.Insert( i * 2, i );
+        }
+
+        const Uint64 bytes = s_countedBytes;
+
+        ReportLookups( "HashMap    ", BenchmarkLookups( map, hashSum ), bytes );
+    }
+
+    /// FlatHashMap ///
+    {
+        Concurrent::FlatHashMap< Int, Int64 > map;
+
+        for ( Int i = 0; i < BENCH_ENTRIES; ++ i )
+        {
+            map.Insert( i * 2, i );
+        }
+
+        ReportLookups( "FlatHashMap", BenchmarkLookups( map, flatSum ), map.GetMemoryBytes() );
+    }
+
+    CHECK( hashSum == flatSum );
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 
 } // SUITE ConcurrentMapSuite
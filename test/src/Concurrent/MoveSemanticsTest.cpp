@@ -0,0 +1,208 @@
+// Caramel C++ Library Test - Concurrent - Move Semantics Test
+
+#include "CaramelTestPch.h"
+
+#include <Caramel/Concurrent/BoundedQueue.h>
+#include <Caramel/Concurrent/HashMap.h>
+#include <Caramel/Concurrent/Map.h>
+#include <Caramel/Concurrent/PriorityQueue.h>
+#include <Caramel/Concurrent/Queue.h>
+#include <UnitTest++/UnitTest++.h>
+
+
+namespace Caramel
+{
+
+SUITE( ConcurrentMoveSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copy Counter
+// - Counts how many times the payloads are copied.
+//   Each copy stands for an extra refcount inc/dec or a heap copy
+//   of the real payloads, e.g. shared_ptr or std::string.
+//
+
+struct Payload
+{
+    static Uint s_copies;
+
+    Payload() {}
+    Payload( const std::string& text ) : text( text ) {}
+    Payload( const std::string& head, const std::string& tail ) : text( head + tail ) {}
+
+    Payload( const Payload& rhs ) : text( rhs.text ) { ++ s_copies; }
+    Payload( Payload&& rhs ) : text( std::move( rhs.text )) {}
+
+    Payload& operator=( const Payload& rhs ) { text = rhs.text; ++ s_copies; return *this; }
+    Payload& operator=( Payload&& rhs ) { text = std::move( rhs.text ); return *this; }
+
+    std::string text;
+};
+
+Uint Payload::s_copies = 0;
+
+const Uint LOOP = 1000;
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Queues
+//
+
+TEST( QueueMoveTest )
+{
+    Concurrent::Queue< Payload > queue;
+    Payload value;
+
+    // By copy : one copy in, one copy out in the old days.
+
+    Payload::s_copies = 0;
+
+    const Payload hello( "Hello" );
+    for ( Uint i = 0; i < LOOP; ++ i )
+    {
+        queue.Push( hello );
+        queue.TryPop( value );
+    }
+
+    CHECK( LOOP == Payload::s_copies );
+    CHECK( "Hello" == value.text );
+
+    // By move or emplace : no copy at all.
+
+    Payload::s_copies = 0;
+
+    for ( Uint i = 0; i < LOOP; ++ i )
+    {
+        queue.Push( Payload( "Reimu" ));
+        queue.TryPop( value );
+    }
+
+    CHECK( 0 == Payload::s_copies );
+    CHECK( "Reimu" == value.text );
+
+#if defined( CARAMEL_HAS_VARIADIC_TEMPLATES )
+
+    for ( Uint i = 0; i < LOOP; ++ i )
+    {
+        queue.Emplace( "Marisa", "Alice" );
+        queue.TryPop( value );
+    }
+
+    CHECK( 0 == Payload::s_copies );
+    CHECK( "MarisaAlice" == value.text );
+
+#endif
+}
+
+
+TEST( BoundedQueueMoveTest )
+{
+    Concurrent::BoundedQueue< Payload, 4 > queue;
+    Payload value;
+
+    Payload::s_copies = 0;
+
+    for ( Uint i = 0; i < LOOP; ++ i )
+    {
+        queue.Push( Payload( "Reimu" ));
+        queue.TryPop( value );
+    }
+
+    CHECK( 0 == Payload::s_copies );
+    CHECK( "Reimu" == value.text );
+
+    // A failed TryPush() doesn't steal the value.
+
+    for ( Uint i = 0; i < queue.GetCapacity(); ++ i )
+    {
+        queue.Push( Payload( "Marisa" ));
+    }
+
+    Payload alice( "Alice" );
+    CHECK( false == queue.TryPush( std::move( alice )));
+    CHECK( "Alice" == alice.text );
+}
+
+
+// The heap can't be moved into without emplace().
+#if defined( CARAMEL_HAS_VARIADIC_TEMPLATES )
+
+TEST( PriorityQueueMoveTest )
+{
+    Concurrent::PriorityQueue< Int, Payload > queue;
+    Payload value;
+
+    // Warm up : Growing the heap may copy the entries.
+    queue.Push( 1, Payload() );
+    queue.Push( 2, Payload() );
+    queue.TryPop( value );
+    queue.TryPop( value );
+
+    Payload::s_copies = 0;
+
+    for ( Uint i = 0; i < LOOP; ++ i )
+    {
+        queue.Push( 1, Payload( "Reimu" ));
+        queue.Emplace( 2, "Marisa", "Alice" );
+
+        queue.TryPop( value );
+        CHECK( "MarisaAlice" == value.text );
+
+        queue.TryPop( value );
+        CHECK( "Reimu" == value.text );
+    }
+
+    CHECK( 0 == Payload::s_copies );
+}
+
+#endif // CARAMEL_HAS_VARIADIC_TEMPLATES
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Maps
+//
+
+TEST( MapMoveTest )
+{
+    Concurrent::Map< Int, Payload > map;
+    Concurrent::HashMap< Int, Payload > hashMap;
+
+    Payload::s_copies = 0;
+
+    for ( Int i = 0; i < static_cast< Int >( LOOP ); ++ i )
+    {
+        map.Insert( i, Payload( "Reimu" ));
+        hashMap.Insert( i, Payload( "Marisa" ));
+    }
+
+    CHECK( 0 == Payload::s_copies );
+
+    Payload value;
+    CHECK( true == hashMap.Find( 1, value ));
+    CHECK( "Marisa" == value.text );
+
+#if defined( CARAMEL_HAS_VARIADIC_TEMPLATES )
+
+    Payload::s_copies = 0;
+
+    CHECK( true == hashMap.Emplace( -1, "Marisa", "Alice" ));
+    CHECK( false == map.Emplace( 0, "Sakuya" ));
+
+    CHECK( 0 == Payload::s_copies );
+
+    CHECK( true == hashMap.Find( -1, value ));
+    CHECK( "MarisaAlice" == value.text );
+
+#endif
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE ConcurrentMoveSuite
+
+} // namespace Caramel
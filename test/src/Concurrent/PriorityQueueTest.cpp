@@ -2,6 +2,7 @@
 
 #include "CaramelTestPch.h"
 
+#include <Caramel/Concurrent/MutablePriorityQueue.h>
 #include <Caramel/Concurrent/PriorityQueue.h>
 #include <UnitTest++/UnitTest++.h>
 
@@ -95,6 +96,101 @@ TEST( PriorityQueueTest )
 
         CHECK( false == queue.PeekTopKey( key ));
     }
+
+    // Pop all until
+    {
+        typedef Concurrent::PriorityQueue< Int, std::string, std::greater< Int > > QueueType;
+        QueueType queue;
+
+        CHECK( true == queue.IsEmpty() );
+
+        queue.Push( 4, "four" );
+        queue.Push( 1, "one" );
+        queue.Push( 3, "three" );
+        queue.Push( 2, "two" );
+
+        CHECK( 4 == queue.Size() );
+
+        std::vector< std::string > values;
+
+        CHECK( 0 == queue.PopAllUntil( 0, values ));
+        CHECK( true == values.empty() );
+
+        CHECK( 3 == queue.PopAllUntil( 3, values ));
+        CHECK( 3 == values.size() );
+        CHECK( "one" == values[0] );
+        CHECK( "two" == values[1] );
+        CHECK( "three" == values[2] );
+
+        CHECK( 1 == queue.Size() );
+
+        CHECK( 1 == queue.PopAllUntil( 10, values ));
+        CHECK( "four" == values[3] );
+
+        CHECK( true == queue.IsEmpty() );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Mutable Priority Queue Test
+//
+
+TEST( MutablePriorityQueueTest )
+{
+    typedef Concurrent::MutablePriorityQueue< Int, std::string, std::greater< Int > > QueueType;
+    QueueType queue;
+
+    const QueueType::Handle h1 = queue.Push( 1, "one" );
+    const QueueType::Handle h2 = queue.Push( 2, "two" );
+    const QueueType::Handle h3 = queue.Push( 3, "three" );
+
+    CHECK( 3 == queue.Size() );
+
+    Int key = 0;
+    CHECK( true == queue.PeekTopKey( key ));
+    CHECK( 1 == key );
+
+    // Erase
+
+    CHECK( true == queue.Erase( h1 ));
+    CHECK( false == queue.Erase( h1 ));
+    CHECK( 2 == queue.Size() );
+
+    CHECK( true == queue.PeekTopKey( key ));
+    CHECK( 2 == key );
+
+    // Update Key
+
+    CHECK( true == queue.UpdateKey( h3, 0 ));
+
+    std::string value;
+    CHECK( true == queue.TryPop( value ));
+    CHECK( "three" == value );
+
+    // The popped handle is no more valid.
+    CHECK( false == queue.Erase( h3 ));
+    CHECK( false == queue.UpdateKey( h3, 5 ));
+
+    // Pop all until
+
+    queue.Push( 4, "four" );
+    queue.Push( 6, "six" );
+
+    std::vector< std::string > values;
+    CHECK( 2 == queue.PopAllUntil( 5, values ));
+    CHECK( "two" == values[0] );
+    CHECK( "four" == values[1] );
+
+    CHECK( false == queue.Erase( h2 ));
+    CHECK( 1 == queue.Size() );
+
+    CHECK( true == queue.TryPop( value ));
+    CHECK( "six" == value );
+
+    CHECK( true == queue.IsEmpty() );
+    CHECK( false == queue.TryPop( value ));
 }
 
 
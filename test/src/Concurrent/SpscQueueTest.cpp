@@ -0,0 +1,301 @@
+// Caramel C++ Library Test - Concurrent - SPSC Queue Test
+
+#include "CaramelTestPch.h"
+
+#include <Caramel/Chrono/TickClock.h>
+#include <Caramel/Concurrent/Queue.h>
+#include <Caramel/Concurrent/SpscQueue.h>
+#include <Caramel/Thread/Thread.h>
+#include <Caramel/Trace/Trace.h>
+#include <UnitTest++/UnitTest++.h>
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+
+namespace Caramel
+{
+
+SUITE( SpscQueueSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// SPSC Queue Test
+//
+
+TEST( SpscQueueTest )
+{
+    Concurrent::SpscQueue< std::string > queue( 4 );
+
+    CHECK( 4 == queue.GetCapacity() );
+    CHECK( true == queue.IsEmpty() );
+
+    std::string value;
+    CHECK( false == queue.TryPop( value ));
+
+    queue.Push( "Reimu" );
+    queue.Push( "Marisa" );
+
+    CHECK( true == queue.TryPush( "Alice" ));
+    CHECK( true == queue.TryPush( "Sakuya" ));
+
+    // Full
+    CHECK( false == queue.TryPush( "Pachouli" ));
+    CHECK( 4 == queue.Size() );
+
+    CHECK( true == queue.TryPop( value ));
+    CHECK( "Reimu" == value );
+
+    // A slot is released, and the ring wraps around.
+    CHECK( true == queue.TryPush( "Pachouli" ));
+
+    CHECK( true == queue.TryPop( value ));
+    CHECK( "Marisa" == value );
+
+    CHECK( true == queue.TryPop( value ));
+    CHECK( "Alice" == value );
+
+    CHECK( true == queue.TryPop( value ));
+    CHECK( "Sakuya" == value );
+
+    CHECK( true == queue.TryPop( value ));
+    CHECK( "Pachouli" == value );
+
+    CHECK( false == queue.TryPop( value ));
+    CHECK( true == queue.IsEmpty() );
+}
+
+
+TEST( SpscQueueBatchTest )
+{
+    Concurrent::SpscQueue< Int > queue( 8 );
+
+    const Int values[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+
+    // Only 8 of them fit.
+    CHECK( 8 == queue.TryPushMany( std::begin( values ), std::end( values )));
+    CHECK( 0 == queue.TryPushMany( std::begin( values ), std::end( values )));
+
+    std::vector< Int > popped;
+
+    CHECK( 3 == queue.TryPopMany( std::back_inserter( popped ), 3 ));
+    CHECK( 3 == popped.size() );
+    CHECK( 1 == popped[0] );
+    CHECK( 3 == popped[2] );
+
+    // Wrap around
+    CHECK( 2 == queue.TryPushMany( std::begin( values ) + 8, std::end( values )));
+
+    CHECK( 7 == queue.TryPopMany( std::back_inserter( popped ), 100 ));
+    CHECK( 10 == popped.size() );
+
+    for ( Int i = 0; i < 10; ++ i )
+    {
+        CHECK( values[i] == popped[i] );
+    }
+
+    CHECK( 0 == queue.TryPopMany( std::back_inserter( popped ), 100 ));
+    CHECK( true == queue.IsEmpty() );
+}
+
+
+TEST( SpscQueueRaceTest )
+{
+    Concurrent::SpscQueue< Int > queue( 64 );
+
+    const Int LOOP = 100000;
+
+    auto produce = [&]
+    {
+        for ( Int i = 1; i <= LOOP; ++ i )
+        {
+            queue.Push( i );
+        }
+    };
+
+    Thread producer( "Producer", produce );
+
+    // The order must be preserved.
+
+    Int expected = 1;
+    Int value = 0;
+    Bool inOrder = true;
+
+    while ( expected <= LOOP )
+    {
+        if ( queue.TryPop( value ))
+        {
+            inOrder = inOrder && ( expected == value );
+            ++ expected;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.Join();
+
+    CHECK( true == inOrder );
+    CHECK( true == queue.IsEmpty() );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Benchmark
+// - One producer and one consumer, compared with Concurrent::Queue.
+//   The results are reported to the trace, no assertion on timings.
+//
+
+const Int BENCH_LOOP = 1000000;
+const Uint BENCH_BATCH = 64;
+
+
+static Int64 BenchmarkQueue()
+{
+    Concurrent::Queue< Int > queue;
+    TickClock clock;
+
+    Thread producer( "Producer", [&]
+    {
+        for ( Int i = 0; i < BENCH_LOOP; ++ i )
+        {
+            queue.Push( i );
+        }
+    });
+
+    Int64 sum = 0;
+    Int value = 0;
+
+    for ( Int count = 0; count < BENCH_LOOP; )
+    {
+        if ( queue.TryPop( value ))
+        {
+            sum += value;
+            ++ count;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.Join();
+
+    CARAMEL_TRACE_INFO( "Concurrent::Queue     : %d ms", clock.Elapsed().ToInt32() );
+    return sum;
+}
+
+
+static Int64 BenchmarkSpscQueue()
+{
+    Concurrent::SpscQueue< Int > queue( 1024 );
+    TickClock clock;
+
+    Thread producer( "Producer", [&]
+    {
+        for ( Int i = 0; i < BENCH_LOOP; ++ i )
+        {
+            queue.Push( i );
+        }
+    });
+
+    Int64 sum = 0;
+    Int value = 0;
+
+    for ( Int count = 0; count < BENCH_LOOP; )
+    {
+        if ( queue.TryPop( value ))
+        {
+            sum += value;
+            ++ count;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.Join();
+
+    CARAMEL_TRACE_INFO( "Concurrent::SpscQueue : %d ms", clock.Elapsed().ToInt32() );
+    return sum;
+}
+
+
+static Int64 BenchmarkSpscQueueBatch()
+{
+    Concurrent::SpscQueue< Int > queue( 1024 );
+    TickClock clock;
+
+    Thread producer( "Producer", [&]
+    {
+        Int batch[ BENCH_BATCH ];
+
+        for ( Int i = 0; i < BENCH_LOOP; )
+        {
+            const Int size = std::min( static_cast< Int >( BENCH_BATCH ), BENCH_LOOP - i );
+
+            for ( Int j = 0; j < size; ++ j )
+            {
+                batch[j] = i + j;
+            }
+
+            Int pushed = 0;
+            while ( pushed < size )
+            {
+                pushed += queue.TryPushMany( batch + pushed, batch + size );
+                if ( pushed < size ) { std::this_thread::yield(); }
+            }
+
+            i += size;
+        }
+    });
+
+    Int64 sum = 0;
+    std::vector< Int > values;
+    values.reserve( BENCH_BATCH );
+
+    for ( Int count = 0; count < BENCH_LOOP; )
+    {
+        values.clear();
+
+        const Uint popped = queue.TryPopMany( std::back_inserter( values ), BENCH_BATCH );
+        if ( 0 == popped )
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        for ( Uint i = 0; i < popped; ++ i )
+        {
+            sum += values[i];
+        }
+        count += popped;
+    }
+
+    producer.Join();
+
+    CARAMEL_TRACE_INFO( "SpscQueue batch       : %d ms", clock.Elapsed().ToInt32() );
+    return sum;
+}
+
+
+TEST( SpscQueueBenchmarkTest )
+{
+    const Int64 expected = static_cast< Int64 >( BENCH_LOOP ) * ( BENCH_LOOP - 1 ) / 2;
+
+    CHECK( expected == BenchmarkQueue() );
+    CHECK( expected == BenchmarkSpscQueue() );
+    CHECK( expected == BenchmarkSpscQueueBatch() );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE SpscQueueSuite
+
+} // namespace Caramel
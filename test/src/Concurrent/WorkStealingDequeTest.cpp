@@ -0,0 +1,144 @@
+// Caramel C++ Library Test - Concurrent - Work Stealing Deque Test
+
+#include "CaramelTestPch.h"
+
+#include <Caramel/Concurrent/WorkStealingDeque.h>
+#include <Caramel/Thread/Thread.h>
+#include <UnitTest++/UnitTest++.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+namespace Caramel
+{
+
+SUITE( WorkStealingDequeSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Work Stealing Deque Test
+//
+
+TEST( WorkStealingDequeTest )
+{
+    typedef Concurrent::WorkStealingDeque< Int > DequeType;
+    DequeType deque( 2 );
+
+    CHECK( true == deque.IsEmpty() );
+
+    Int value = 0;
+    CHECK( false == deque.PopBottom( value ));
+    CHECK( false == deque.Steal( value ));
+
+    // Grows from 2 to 8
+
+    for ( Int i = 1; i <= 6; ++ i )
+    {
+        deque.PushBottom( i );
+    }
+
+    CHECK( 6 == deque.Size() );
+
+    // Owner pops in LIFO
+
+    CHECK( true == deque.PopBottom( value ));
+    CHECK( 6 == value );
+
+    // Thieves steal in FIFO
+
+    CHECK( true == deque.Steal( value ));
+    CHECK( 1 == value );
+
+    CHECK( true == deque.Steal( value ));
+    CHECK( 2 == value );
+
+    CHECK( true == deque.PopBottom( value ));
+    CHECK( 5 == value );
+
+    CHECK( true == deque.PopBottom( value ));
+    CHECK( 4 == value );
+
+    CHECK( true == deque.Steal( value ));
+    CHECK( 3 == value );
+
+    CHECK( true == deque.IsEmpty() );
+    CHECK( false == deque.PopBottom( value ));
+    CHECK( false == deque.Steal( value ));
+}
+
+
+TEST( WorkStealingDequeRaceTest )
+{
+    typedef Concurrent::WorkStealingDeque< Int > DequeType;
+    DequeType deque( 4 );
+
+    const Int COUNT = 20000;
+
+    // Each value must be taken exactly once.
+    std::vector< std::atomic< Int > > takens( COUNT );
+    for ( Int i = 0; i < COUNT; ++ i ) { takens[i] = 0; }
+
+    std::atomic< Int > takenCount( 0 );
+
+    auto steal = [&]
+    {
+        Int value = 0;
+        while ( takenCount < COUNT )
+        {
+            if ( deque.Steal( value ))
+            {
+                ++ takens[ value ];
+                ++ takenCount;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    Thread thief1( "Thief1", steal );
+    Thread thief2( "Thief2", steal );
+
+    // Owner : push some, pop some.
+
+    Int value = 0;
+    for ( Int i = 0; i < COUNT; ++ i )
+    {
+        deque.PushBottom( i );
+
+        if ( 0 == i % 3 && deque.PopBottom( value ))
+        {
+            ++ takens[ value ];
+            ++ takenCount;
+        }
+    }
+
+    while ( deque.PopBottom( value ))
+    {
+        ++ takens[ value ];
+        ++ takenCount;
+    }
+
+    thief1.Join();
+    thief2.Join();
+
+    CHECK( COUNT == takenCount );
+
+    Int wrongs = 0;
+    for ( Int i = 0; i < COUNT; ++ i )
+    {
+        if ( 1 != takens[i] ) { ++ wrongs; }
+    }
+
+    CHECK( 0 == wrongs );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE WorkStealingDequeSuite
+
+} // namespace Caramel
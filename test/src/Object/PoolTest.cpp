@@ -0,0 +1,172 @@
+// Caramel C++ Library Test - Object - Pool Test
+
+#include "CaramelTestPch.h"
+
+#include <Caramel/Object/Pool.h>
+#include <Caramel/Thread/Thread.h>
+#include <UnitTest++/UnitTest++.h>
+#include <atomic>
+#include <vector>
+
+
+namespace Caramel
+{
+
+SUITE( PoolSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Pool Test
+//
+
+struct Pooled
+{
+    static std::atomic< Int > s_alive;
+
+    Pooled()  : value( 0 ) { ++ s_alive; }
+    ~Pooled() { -- s_alive; }
+
+    Int value;
+};
+
+std::atomic< Int > Pooled::s_alive( 0 );
+
+
+TEST( PoolTest )
+{
+    {
+        Pool< Pooled, 4 > pool;
+
+        CHECK( 0 == pool.CachedCount() );
+
+        Pooled* object = nullptr;
+        {
+            auto handle = pool.Acquire();
+            CHECK( false == handle.IsNull() );
+
+            handle->value = 42;
+            object = handle.Get();
+        }
+
+        // Released to the pool, not deleted.
+        CHECK( 1 == Pooled::s_alive );
+        CHECK( 1 == pool.CachedCount() );
+
+        // Reused as it is.
+        auto handle = pool.Acquire();
+        CHECK( object == handle.Get() );
+        CHECK( 42 == ( *handle ).value );
+        CHECK( 0 == pool.CachedCount() );
+
+
+        /// Move and Reset ///
+
+        auto moved = std::move( handle );
+        CHECK( true == handle.IsNull() );
+        CHECK( object == moved.Get() );
+
+        moved.Reset();
+        CHECK( true == moved.IsNull() );
+        CHECK( 1 == pool.CachedCount() );
+
+
+        /// Trim ///
+
+        CHECK( 1 == pool.Trim() );
+        CHECK( 0 == pool.CachedCount() );
+        CHECK( 0 == Pooled::s_alive );
+
+
+        /// Raw Interface ///
+
+        Pooled* raw = pool.AcquireObject();
+        pool.ReleaseObject( raw );
+        CHECK( 1 == pool.CachedCount() );
+    }
+
+    // The pool deletes the cached objects when destroyed.
+    CHECK( 0 == Pooled::s_alive );
+}
+
+
+TEST( PoolBoundTest )
+{
+    {
+        Pool< Pooled, 4 > pool;
+
+        std::vector< Pooled* > objects;
+        for ( Int i = 0; i < 100; ++ i )
+        {
+            objects.push_back( pool.AcquireObject() );
+        }
+
+        CHECK( 100 == Pooled::s_alive );
+
+        for ( Uint i = 0; i < objects.size(); ++ i )
+        {
+            pool.ReleaseObject( objects[i] );
+        }
+
+        // One thread uses one magazine, plus the depot.
+        const Uint cached = pool.CachedCount();
+        CHECK( 16 + 4 >= cached );
+        CHECK( Pooled::s_alive == static_cast< Int >( cached ));
+
+        CHECK( cached == pool.Trim() );
+    }
+
+    CHECK( 0 == Pooled::s_alive );
+}
+
+
+TEST( PoolThreadTest )
+{
+    {
+        Pool< Pooled > pool;
+
+        std::atomic< Int > errors( 0 );
+
+        auto worker = [&]
+        {
+            for ( Int i = 0; i < 10000; ++ i )
+            {
+                auto handle1 = pool.Acquire();
+                auto handle2 = pool.Acquire();
+
+                // No object is owned by two handles at once.
+                handle1->value = i;
+                handle2->value = -i - 1;
+
+                std::this_thread::yield();
+
+                if ( i != handle1->value || -i - 1 != handle2->value )
+                {
+                    ++ errors;
+                }
+            }
+        };
+
+        Thread t1( "Pool1", worker );
+        Thread t2( "Pool2", worker );
+        Thread t3( "Pool3", worker );
+        Thread t4( "Pool4", worker );
+
+        t1.Join();
+        t2.Join();
+        t3.Join();
+        t4.Join();
+
+        CHECK( 0 == errors );
+        CHECK( Pooled::s_alive == static_cast< Int >( pool.CachedCount() ));
+    }
+
+    CHECK( 0 == Pooled::s_alive );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE PoolSuite
+
+} // namespace Caramel
@@ -0,0 +1,178 @@
+// Caramel C++ Library Test - Task - Async Task Test
+
+#include "CaramelTestPch.h"
+
+#include <Caramel/Task/AsyncTask.h>
+
+#if defined( CARAMEL_HAS_COROUTINES )
+
+#include <Caramel/Task/TaskPoller.h>
+#include <Caramel/Task/TaskT.h>
+#include <Caramel/Task/TaskThreadPool.h>
+#include <Caramel/Thread/ThisThread.h>
+#include <UnitTest++/UnitTest++.h>
+#include <stdexcept>
+#include <thread>
+
+
+namespace Caramel
+{
+
+SUITE( AsyncTaskSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Async Task Test
+//
+
+static AsyncTask< Int > AddOnPoller( TaskPoller& poller, Int x, Int y )
+{
+    co_await ResumeOn( poller );
+    co_return x + y;
+}
+
+
+static AsyncTask< std::string > Hop( TaskPoller& poller, TaskThreadPool& pool )
+{
+    const std::thread::id caller = std::this_thread::get_id();
+
+    co_await ResumeOn( pool );
+    const Bool onPool = caller != std::this_thread::get_id();
+
+    co_await ResumeOn( poller );
+    const Bool backOnCaller = caller == std::this_thread::get_id();
+
+    const Int sum = co_await AddOnPoller( poller, 20, 22 );
+
+    co_return ( onPool && backOnCaller ) ? std::to_string( sum ) : "Wrong thread";
+}
+
+
+TEST( AsyncTaskTest )
+{
+    TaskPoller poller;
+
+    /// Suspended until the poller runs it ///
+
+    auto add = AddOnPoller( poller, 1, 2 );
+
+    CHECK( false == add.IsReady() );
+
+    poller.PollOne();
+
+    CHECK( true == add.IsReady() );
+    CHECK( 3 == add.GetFuture().Get() );
+
+
+    /// Hop between executors ///
+
+    TaskThreadPool pool( "Pool", 2 );
+
+    auto hop = Hop( poller, pool );
+
+    while ( ! hop.IsReady() )
+    {
+        poller.WaitAndPollFor( Ticks( 100 ), Ticks( 10 ));
+    }
+
+    CHECK( "42" == hop.GetFuture().Get() );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Async Task Await Test
+//
+
+static AsyncTask< Int > AwaitFuture( Future< Int > future )
+{
+    const Int x = co_await future;
+    co_return x * 2;
+}
+
+
+static AsyncTask< void > AwaitFlag( WaitableBool& flag, Int& count )
+{
+    co_await flag;
+    ++ count;
+}
+
+
+static AsyncTask< Int > Sleepy( TaskPoller& poller )
+{
+    co_await ResumeAfter( poller, Ticks( 30 ));
+    co_return 1;
+}
+
+
+static AsyncTask< Int > Throws( TaskPoller& poller )
+{
+    co_await ResumeOn( poller );
+    throw std::runtime_error( "Oops" );
+}
+
+
+TEST( AsyncTaskAwaitTest )
+{
+    TaskPoller poller;
+
+    /// Future ///
+
+    TaskT< Int > task( "Answer", [] { return 21; } );
+    auto doubled = AwaitFuture( task.GetFuture() );
+
+    CHECK( false == doubled.IsReady() );
+
+    poller.Submit( task );
+    poller.PollOne();
+
+    CHECK( 42 == doubled.GetFuture().Get() );
+
+
+    /// Waitable Bool ///
+
+    WaitableBool flag;
+    Int count = 0;
+
+    auto waiter = AwaitFlag( flag, count );
+    CHECK( 0 == count );
+
+    flag = true;
+    CHECK( 1 == count );
+    CHECK( true == waiter.IsReady() );
+
+    // Already true, not suspended.
+    AwaitFlag( flag, count );
+    CHECK( 2 == count );
+
+
+    /// Delay ///
+
+    const TickClock clock;
+    auto sleepy = Sleepy( poller );
+
+    while ( ! sleepy.IsReady() )
+    {
+        poller.WaitAndPollFor( Ticks( 100 ), Ticks( 10 ));
+    }
+
+    CHECK( Ticks( 30 ) <= clock.Elapsed() );
+
+
+    /// Exception ///
+
+    auto failed = Throws( poller );
+    poller.PollOne();
+
+    CHECK( true == failed.GetFuture().IsFailed() );
+    CHECK_THROW( failed.GetFuture().Get(), std::runtime_error );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE AsyncTaskSuite
+
+} // namespace Caramel
+
+#endif // CARAMEL_HAS_COROUTINES
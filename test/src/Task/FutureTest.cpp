@@ -0,0 +1,291 @@
+// Caramel C++ Library Test - Task - Future Test
+
+#include "CaramelTestPch.h"
+
+#include <Caramel/Task/Future.h>
+#include <Caramel/Task/TaskPoller.h>
+#include <Caramel/Task/TaskT.h>
+#include <Caramel/Task/TaskThreadPool.h>
+#include <UnitTest++/UnitTest++.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+
+namespace Caramel
+{
+
+SUITE( FutureSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Future Test
+//
+
+TEST( FutureTest )
+{
+    TaskPoller poller;
+
+    TaskT< Int > task( "Answer", [] { return 42; } );
+    auto future = task.GetFuture();
+
+    CHECK( true == future.IsValid() );
+    CHECK( false == future.IsReady() );
+
+    poller.Submit( task );
+    poller.PollOne();
+
+    CHECK( true == future.IsReady() );
+    CHECK( false == future.IsFailed() );
+    CHECK( 42 == future.Get() );
+
+
+    /// Continuations ///
+
+    TaskT< Int > task2( "Base", [] { return 20; } );
+
+    auto last = task2.GetFuture()
+        .Then( poller, [] ( Int x ) { return x + 1; } )
+        .Then( poller, [] ( Int x ) { return std::to_string( x * 2 ); } );
+
+    poller.Submit( task2 );
+    poller.PollFor( Ticks( 100 ));
+
+    CHECK( true == last.IsReady() );
+    CHECK( "42" == last.Get() );
+
+
+    /// Void ///
+
+    Int count = 0;
+
+    TaskT< void > task3( "Void", [&] { ++ count; } );
+
+    auto voidLast = task3.GetFuture()
+        .Then( poller, [&] { return ++ count; } );
+
+    poller.Submit( task3 );
+    poller.PollFor( Ticks( 100 ));
+
+    CHECK( 2 == voidLast.Get() );
+
+
+    /// Not a future ///
+
+    Future< Int > empty;
+    CHECK( false == empty.IsValid() );
+    CHECK( false == empty.IsReady() );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Future Continuations Test
+// - Many continuations of one future run in the order they were added.
+//
+
+TEST( FutureContinuationsTest )
+{
+    TaskPoller poller;
+
+    const Int NUM_CONTINUATIONS = 10000;
+
+    TaskT< Int > task( "Base", [] { return 1; } );
+    auto future = task.GetFuture();
+
+    std::vector< Int > order;
+
+    for ( Int i = 0; i < NUM_CONTINUATIONS; ++ i )
+    {
+        future.Then( poller, [&order, i] ( Int x ) { order.push_back( i * x ); } );
+    }
+
+    poller.Submit( task );
+
+    while ( NUM_CONTINUATIONS > static_cast< Int >( order.size() ))
+    {
+        poller.PollOne();
+    }
+
+    Bool inOrder = true;
+    for ( Int i = 0; i < NUM_CONTINUATIONS; ++ i )
+    {
+        if ( order[i] != i ) { inOrder = false; }
+    }
+
+    CHECK( true == inOrder );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Future Exception Test
+//
+
+TEST( FutureExceptionTest )
+{
+    TaskPoller poller;
+
+    Int count = 0;
+
+    TaskT< Int > task( "Throws", [] () -> Int { throw std::runtime_error( "Oops" ); } );
+
+    auto last = task.GetFuture()
+        .Then( poller, [&] ( Int x ) { ++ count; return x; } )
+        .Then( poller, [&] ( Int x ) { ++ count; return x; } );
+
+    poller.Submit( task );
+    poller.PollFor( Ticks( 100 ));
+
+    CHECK( true == last.IsFailed() );
+    CHECK( 0 == count );
+    CHECK_THROW( last.Get(), std::runtime_error );
+
+
+    /// Thrown by a continuation ///
+
+    TaskT< Int > task2( "Base", [] { return 1; } );
+
+    auto failed = task2.GetFuture()
+        .Then( poller, [] ( Int ) -> Int { CARAMEL_THROW( "Continuation fails" ); } );
+
+    poller.Submit( task2 );
+    poller.PollFor( Ticks( 100 ));
+
+    CHECK_THROW( failed.Get(), Caramel::Exception );
+
+
+    /// Cancelled ///
+
+    TaskT< Int > task3( "Cancelled", [] { return 1; } );
+    auto cancelled = task3.GetFuture();
+
+    poller.Submit( task3 );
+    task3.Cancel();
+    poller.PollOne();
+
+    CHECK( true == cancelled.IsFailed() );
+    CHECK_THROW( cancelled.Get(), Caramel::Exception );
+
+    // The name is formatted only when cancelled.
+    std::string what;
+    try
+    {
+        cancelled.Get();
+    }
+    catch ( const Caramel::Exception& x )
+    {
+        what = x.What();
+    }
+
+    CHECK( std::string::npos != what.find( "Cancelled" ));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// When All / When Any Test
+//
+
+TEST( WhenAllTest )
+{
+    TaskThreadPool pool( "Pool", 4 );
+
+    std::vector< Future< Int >> futures;
+
+    for ( Int i = 0; i < 100; ++ i )
+    {
+        TaskT< Int > task( "Square", [=] { return i * i; } );
+        futures.push_back( task.GetFuture() );
+        pool.Submit( task );
+    }
+
+    auto all = WhenAll( futures );
+    const std::vector< Int >& values = all.Get();
+
+    CHECK( 100 == values.size() );
+
+    for ( Int i = 0; i < 100; ++ i )
+    {
+        CHECK( i * i == values[i] );
+    }
+
+
+    /// Sum by a continuation, the pool is not blocked ///
+
+    auto sum = all.Then( pool, [] ( const std::vector< Int >& values ) -> Int
+    {
+        Int total = 0;
+        for ( Uint i = 0; i < values.size(); ++ i ) { total += values[i]; }
+        return total;
+    });
+
+    CHECK( 328350 == sum.Get() );
+
+
+    /// Void and empty ///
+
+    std::atomic< Int > count( 0 );
+    std::vector< Future< void >> voids;
+
+    for ( Int i = 0; i < 10; ++ i )
+    {
+        TaskT< void > task( "Void", [&] { ++ count; } );
+        voids.push_back( task.GetFuture() );
+        pool.Submit( task );
+    }
+
+    WhenAll( voids ).Get();
+    CHECK( 10 == count );
+
+    CHECK( true == WhenAll( std::vector< Future< Int >>() ).IsReady() );
+
+
+    /// The first exception in order ///
+
+    std::vector< Future< Int >> mixed;
+
+    TaskT< Int > good( "Good", [] { return 1; } );
+    TaskT< Int > bad( "Bad", [] () -> Int { throw std::logic_error( "Bad" ); } );
+    mixed.push_back( good.GetFuture() );
+    mixed.push_back( bad.GetFuture() );
+    pool.Submit( good );
+    pool.Submit( bad );
+
+    CHECK_THROW( WhenAll( mixed ).Get(), std::logic_error );
+}
+
+
+TEST( WhenAnyTest )
+{
+    TaskPoller poller;
+
+    TaskT< Int > first( "First", [] { return 1; } );
+    TaskT< Int > second( "Second", [] { return 2; } );
+
+    std::vector< Future< Int >> futures;
+    futures.push_back( first.GetFuture() );
+    futures.push_back( second.GetFuture() );
+
+    auto any = WhenAny( futures );
+
+    poller.Submit( second );
+    poller.PollOne();
+
+    CHECK( true == any.IsReady() );
+    CHECK( 1 == any.Get() );
+
+    poller.Submit( first );
+    poller.PollOne();
+
+    CHECK( 1 == any.Get() );
+
+    CHECK_THROW( WhenAny( std::vector< Future< Int >>() ), Caramel::Exception );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE FutureSuite
+
+} // namespace Caramel
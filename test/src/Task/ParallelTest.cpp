@@ -0,0 +1,293 @@
+// Caramel C++ Library Test - Task - Parallel Test
+
+#include "CaramelTestPch.h"
+
+#include <Caramel/Chrono/TickClock.h>
+#include <Caramel/String/Sprintf.h>
+#include <Caramel/Task/Parallel.h>
+#include <Caramel/Task/TaskPoller.h>
+#include <Caramel/Task/TaskStealingPool.h>
+#include <Caramel/Trace/Trace.h>
+#include <Caramel/Value/SharedArray.h>
+#include <UnitTest++/UnitTest++.h>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+
+namespace Caramel
+{
+
+SUITE( ParallelSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Parallel Test
+//
+
+//
+// The helper budget defaults to the hardware threads,
+// it is raised so the helpers also run on a single core machine.
+//
+class MaxHelpersScope
+{
+public:
+
+    explicit MaxHelpersScope( Uint maxHelpers )
+        : m_savedMaxHelpers( GetMaxParallelHelpers() )
+    {
+        SetMaxParallelHelpers( maxHelpers );
+    }
+
+    ~MaxHelpersScope()
+    {
+        SetMaxParallelHelpers( m_savedMaxHelpers );
+    }
+
+private:
+
+    Uint m_savedMaxHelpers;
+};
+
+
+TEST( ParallelForTest )
+{
+    MaxHelpersScope helpers( 3 );
+    TaskStealingPool pool( "Parallel", 4 );
+
+    const Uint SIZE = 100000;
+
+    std::vector< Int > hits( SIZE, 0 );
+
+    ParallelFor( pool, 0, SIZE, 100, [&] ( Uint i ) { ++ hits[i]; } );
+
+    Bool once = true;
+    for ( Uint i = 0; i < SIZE; ++ i )
+    {
+        once = once && ( 1 == hits[i] );
+    }
+
+    CHECK( true == once );
+
+
+    /// Empty and single ///
+
+    Int count = 0;
+
+    ParallelFor( pool, 5, 5, 1, [&] ( Uint ) { ++ count; } );
+    CHECK( 0 == count );
+
+    ParallelFor( pool, 5, 6, 1, [&] ( Uint i ) { count += i; } );
+    CHECK( 5 == count );
+
+
+    /// Nested, in the pool's tasks too ///
+
+    std::atomic< Int > nested( 0 );
+
+    ParallelFor( pool, 0, 64, 1, [&] ( Uint )
+    {
+        ParallelFor( pool, 0, 64, 1, [&] ( Uint ) { ++ nested; } );
+    });
+
+    CHECK( 64 * 64 == nested );
+
+
+    /// Exception ///
+
+    std::atomic< Int > ran( 0 );
+
+    CHECK_THROW(
+        ParallelFor( pool, 0, 1000, 1, [&] ( Uint i )
+        {
+            ++ ran;
+            if ( 10 == i ) { throw std::runtime_error( "Oops" ); }
+        }),
+        std::runtime_error
+    );
+
+    CHECK( 1000 > ran );
+}
+
+
+TEST( ParallelReduceTest )
+{
+    MaxHelpersScope helpers( 3 );
+    TaskStealingPool pool( "Parallel", 4 );
+
+    const Uint SIZE = 100000;
+
+    const Int64 sum = ParallelReduce( pool, 0, SIZE, 64, Int64( 0 ),
+        [] ( Uint i ) { return static_cast< Int64 >( i ); },
+        [] ( Int64 x, Int64 y ) { return x + y; }
+    );
+
+    CHECK( Int64( SIZE ) * ( SIZE - 1 ) / 2 == sum );
+
+    const Uint maxValue = ParallelReduce( pool, 0, SIZE, 64, 0u,
+        [] ( Uint i ) { return ( i * 7919 ) % SIZE; },
+        [] ( Uint x, Uint y ) { return std::max( x, y ); }
+    );
+
+    CHECK( SIZE - 1 == maxValue );
+
+    // Empty range gives the identity.
+    CHECK( 42 == ParallelReduce( pool, 0, 0, 1, 42, [] ( Uint ) { return 1; }, std::plus< Int >() ));
+}
+
+
+TEST( ParallelTransformTest )
+{
+    MaxHelpersScope helpers( 3 );
+    TaskStealingPool pool( "Parallel", 4 );
+
+    const Uint SIZE = 10000;
+
+    SharedArray< Float > input( SIZE );
+    SharedArray< Float > output( SIZE );
+
+    for ( Uint i = 0; i < SIZE; ++ i ) { input[i] = static_cast< Float >( i ); }
+
+    ParallelTransform( pool, input.Begin(), input.End(), output.Begin(), 128,
+        [] ( Float x ) { return x * 2; } );
+
+    Bool doubled = true;
+    for ( Uint i = 0; i < SIZE; ++ i )
+    {
+        doubled = doubled && ( input[i] * 2 == output[i] );
+    }
+
+    CHECK( true == doubled );
+}
+
+
+TEST( ParallelSortTest )
+{
+    MaxHelpersScope helpers( 3 );
+    TaskStealingPool pool( "Parallel", 4 );
+
+    const Uint SIZE = 100003;  // Not a multiple of the grain.
+
+    std::vector< Int > values( SIZE );
+
+    Uint seed = 12345;
+    for ( Uint i = 0; i < SIZE; ++ i )
+    {
+        seed = seed * 1103515245 + 12345;
+        values[i] = static_cast< Int >( seed >> 8 ) % 1000;
+    }
+
+    std::vector< Int > expected = values;
+    std::sort( expected.begin(), expected.end() );
+
+    ParallelSort( pool, values.begin(), values.end(), 1000 );
+
+    CHECK( expected == values );
+
+    ParallelSort( pool, values.begin(), values.end(), 777, std::greater< Int >() );
+
+    CHECK( std::is_sorted( values.begin(), values.end(), std::greater< Int >() ));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Parallel Helper Budget Test
+// - Helpers which never run return their slots when their tasks are dropped.
+//
+
+TEST( ParallelHelperBudgetTest )
+{
+    MaxHelpersScope helpers( 3 );
+
+    Int count = 0;
+    {
+        TaskPoller poller;
+
+        // Never polled, the caller does all the work.
+        ParallelFor( poller, 0, 100, 1, [&] ( Uint ) { ++ count; } );
+
+        CHECK( 100 == count );
+        CHECK( 0 == Detail::AcquireParallelHelpers( 3 ));
+    }
+
+    const Uint acquired = Detail::AcquireParallelHelpers( 3 );
+    Detail::ReleaseParallelHelpers( acquired );
+
+    CHECK( 3 == acquired );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Benchmark
+// - Workloads over a SharedArray< Float >, with 1 / 2 / 4 / 8 threads.
+//   The helpers are threads - 1, the caller takes the rest.
+//   The results are reported to the trace, no assertion on timings.
+//
+
+const Uint BENCH_SIZE  = 1 << 20;
+const Uint BENCH_GRAIN = 4096;
+
+
+static void BenchmarkParallel( Uint numThreads, const SharedArray< Float >& input )
+{
+    TaskStealingPool pool( "Bench", numThreads );
+    SetMaxParallelHelpers( numThreads - 1 );
+
+    SharedArray< Float > output( BENCH_SIZE );
+
+    TickClock clock;
+
+    ParallelTransform( pool, input.Begin(), input.End(), output.Begin(), BENCH_GRAIN,
+        [] ( Float x ) { return std::sqrt( x ) * std::sin( x ); } );
+
+    const Ticks transformTicks = clock.Elapsed();
+    clock.Reset();
+
+    const Float sum = ParallelReduce( pool, 0, BENCH_SIZE, BENCH_GRAIN, 0.0f,
+        [&] ( Uint i ) { return output[i]; },
+        [] ( Float x, Float y ) { return x + y; }
+    );
+
+    const Ticks reduceTicks = clock.Elapsed();
+    clock.Reset();
+
+    ParallelSort( pool, output.Begin(), output.End(), BENCH_SIZE / 16 );
+
+    const Ticks sortTicks = clock.Elapsed();
+
+    CHECK( std::is_sorted( output.Begin(), output.End() ));
+
+    const std::string times = Sprintf(
+        "transform %d ms, reduce %d ms, sort %d ms, sum %f",
+        transformTicks.ToInt32(), reduceTicks.ToInt32(), sortTicks.ToInt32(), sum );
+
+    CARAMEL_TRACE_INFO( "Parallel x %u : %s", numThreads, times );
+}
+
+
+TEST( ParallelBenchmarkTest )
+{
+    MaxHelpersScope helpers( 0 );
+
+    SharedArray< Float > input( BENCH_SIZE );
+
+    for ( Uint i = 0; i < BENCH_SIZE; ++ i ) { input[i] = static_cast< Float >( i % 1000 ); }
+
+    const Uint threadCounts[] = { 1, 2, 4, 8 };
+
+    for ( Uint i = 0; i < 4; ++ i )
+    {
+        BenchmarkParallel( threadCounts[i], input );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE ParallelSuite
+
+} // namespace Caramel
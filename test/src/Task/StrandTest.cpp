@@ -0,0 +1,308 @@
+// Caramel C++ Library Test - Task - Strand Test
+
+#include "CaramelTestPch.h"
+
+#include <Caramel/Chrono/TickClock.h>
+#include <Caramel/Error/Exception.h>
+#include <Caramel/Statechart/StateMachine.h>
+#include <Caramel/Task/Strand.h>
+#include <Caramel/Task/TaskPoller.h>
+#include <Caramel/Task/TaskThreadPool.h>
+#include <Caramel/Thread/Thread.h>
+#include <Caramel/Thread/ThisThread.h>
+#include <UnitTest++/UnitTest++.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+
+namespace Caramel
+{
+
+SUITE( StrandSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Strand Test
+// - Tasks run in order and never overlap, while the pool runs other tasks.
+//
+
+TEST( StrandTest )
+{
+    TaskThreadPool pool( "Pool", 4 );
+
+    const Int NUM_PRODUCERS = 4;
+    const Int NUM_TASKS = 2000;
+
+    Strand strand( pool );
+
+    std::atomic< Int > running( 0 );
+    Bool overlapped = false;
+    Bool ordered = true;
+    Bool inStrand = true;
+
+    // Only touched by the strand's tasks, no lock.
+    std::vector< Int > expected( NUM_PRODUCERS, 0 );
+
+    std::vector< std::unique_ptr< Thread >> producers;
+
+    for ( Int p = 0; p < NUM_PRODUCERS; ++ p )
+    {
+        producers.emplace_back( new Thread( "Producer", [&, p]
+        {
+            for ( Int i = 0; i < NUM_TASKS; ++ i )
+            {
+                strand.Submit( Task( "Ordered", [&, p, i]
+                {
+                    if ( 1 != ++ running ) { overlapped = true; }
+
+                    ordered = ordered && ( expected[p] == i );
+                    expected[p] = i + 1;
+                    inStrand = inStrand && strand.IsRunningInThisThread();
+
+                    -- running;
+                }));
+            }
+        }));
+    }
+
+    for ( Uint i = 0; i < producers.size(); ++ i )
+    {
+        producers[i]->Join();
+    }
+
+    pool.Drain();
+
+    CHECK( false == overlapped );
+    CHECK( true == ordered );
+    CHECK( true == inStrand );
+    CHECK( false == strand.IsRunningInThisThread() );
+    CHECK( NUM_PRODUCERS * NUM_TASKS == strand.GetCounters().runCount );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Strand Delay Test
+//
+
+TEST( StrandDelayTest )
+{
+    TaskPoller poller;
+    Strand strand( poller );
+
+    std::string order;
+
+    strand.Submit( Task( "Late", [&] { order += 'L'; } ).DelayFor( Ticks( 30 )));
+    strand.Submit( Task( "Now", [&] { order += 'N'; } ));
+
+    Task cancelled( "Cancelled", [&] { order += 'C'; } );
+    cancelled.DelayFor( Ticks( 10 ));
+    strand.Submit( cancelled );
+    cancelled.Cancel();
+
+    Int count = 0;
+    Task repeat( "Repeat", [&] { order += 'R'; ++ count; } );
+    repeat.Every( Ticks( 10 ));
+    strand.Submit( repeat );
+
+    const TickClock clock;
+    while ( Ticks( 55 ) > clock.Elapsed() )
+    {
+        poller.WaitAndPollFor( Ticks( 5 ), Ticks( 5 ));
+    }
+
+    repeat.Cancel();
+    poller.PollFor( Ticks( 5 ));
+
+    CHECK( 'N' == order[0] );
+    CHECK( std::string::npos != order.find( 'L' ));
+    CHECK( std::string::npos == order.find( 'C' ));
+    CHECK( 3 <= count );
+    CHECK( 2 == strand.GetCounters().cancelledCount );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Strand Delay Cancel Test
+// - A cancelled delayed task is dropped from the underlying executor at once,
+//   releasing what it captures.
+//
+
+TEST( StrandDelayCancelTest )
+{
+    TaskPoller poller;
+    Strand strand( poller );
+
+    auto captured = std::make_shared< Int >( 0 );
+    std::weak_ptr< Int > watch = captured;
+
+    Task delayed( "Delayed", [captured] { ++ *captured; } );
+    delayed.DelayFor( Ticks( 60000 ));
+    strand.Submit( delayed );
+
+    captured.reset();
+
+    CHECK( true == delayed.Cancel() );
+    CHECK( 1 == poller.GetCounters().cancelledCount );
+
+    delayed = Task();
+
+    CHECK( true == watch.expired() );
+
+
+    /// Repeating, cancelled between the cycles ///
+
+    Int count = 0;
+    Task repeat( "Repeat", [&] { ++ count; } );
+    repeat.Every( Ticks( 5 ));
+    strand.Submit( repeat );
+
+    const TickClock clock;
+    while ( 3 > count && Ticks( 1000 ) > clock.Elapsed() )
+    {
+        poller.WaitAndPollFor( Ticks( 5 ), Ticks( 5 ));
+    }
+
+    CHECK( true == repeat.Cancel() );
+    CHECK( 2 == poller.GetCounters().cancelledCount );
+
+    const Int stoppedCount = count;
+    poller.PollFor( Ticks( 20 ));
+
+    CHECK( stoppedCount == count );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Strand Shutdown Test
+// - If the underlying executor refuses the drain, the strand never gets stuck.
+//
+
+// Refuses the tasks while it is closed.
+class GateExecutor : public TaskExecutor
+{
+public:
+
+    explicit GateExecutor( TaskExecutor& executor )
+        : m_executor( executor )
+        , m_closed( false )
+    {}
+
+    void Submit( const Task& task ) override
+    {
+        if ( m_closed ) { CARAMEL_THROW( "Gate is closed" ); }
+        m_executor.Submit( task );
+    }
+
+    TaskCounters GetCounters() const override { return m_executor.GetCounters(); }
+
+    void SetClosed( Bool closed ) { m_closed = closed; }
+
+private:
+
+    TaskExecutor& m_executor;
+    Bool m_closed;
+};
+
+
+TEST( StrandShutdownTest )
+{
+    Int count = 0;
+
+    /// Shut down pool ///
+    {
+        TaskThreadPool pool( "Pool", 2 );
+        Strand strand( pool );
+
+        pool.Shutdown();
+
+        CHECK_THROW( strand.Submit( Task( "First", [&] { ++ count; } )), Caramel::Exception );
+        CHECK_THROW( strand.Submit( Task( "Second", [&] { ++ count; } )), Caramel::Exception );
+
+        CHECK( 0 == count );
+        CHECK( 2 == strand.GetCounters().cancelledCount );
+    }
+
+    /// Submits work again after the executor accepts tasks ///
+    {
+        TaskPoller poller;
+        GateExecutor gate( poller );
+        Strand strand( gate );
+
+        gate.SetClosed( true );
+
+        CHECK_THROW( strand.Submit( Task( "Refused", [&] { ++ count; } )), Caramel::Exception );
+
+        gate.SetClosed( false );
+
+        strand.Submit( Task( "Accepted", [&] { ++ count; } ));
+        poller.PollOne();
+
+        CHECK( 1 == count );
+        CHECK( 1 == strand.GetCounters().runCount );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// State Machine on Strand Test
+// - Many machines share a small pool, each processes its events in order.
+//
+
+TEST( StateMachineOnStrandTest )
+{
+    enum { S_EVEN, S_ODD };
+    enum { E_FLIP };
+
+    TaskThreadPool pool( "MachinePool", 2 );
+
+    const Int NUM_MACHINES = 16;
+    const Int NUM_EVENTS = 101;
+
+    std::atomic< Int > flips( 0 );
+    std::vector< std::unique_ptr< Statechart::StateMachine >> machines;
+
+    for ( Int m = 0; m < NUM_MACHINES; ++ m )
+    {
+        std::unique_ptr< Statechart::StateMachine > machine(
+            new Statechart::StateMachine( "Flip", pool ));
+
+        machine->AddState( S_EVEN )
+                .Transition( E_FLIP, S_ODD );
+
+        machine->AddState( S_ODD )
+                .EnterAction( [&] { ++ flips; } )
+                .Transition( E_FLIP, S_EVEN );
+
+        machine->Initiate( S_EVEN );
+        machines.push_back( std::move( machine ));
+    }
+
+    for ( Int e = 0; e < NUM_EVENTS; ++ e )
+    {
+        for ( Int m = 0; m < NUM_MACHINES; ++ m )
+        {
+            machines[m]->PostEvent( E_FLIP );
+        }
+    }
+
+    pool.Drain();
+
+    for ( Int m = 0; m < NUM_MACHINES; ++ m )
+    {
+        CHECK( S_ODD == machines[m]->GetCurrentStateId() );
+    }
+
+    CHECK( NUM_MACHINES * ( NUM_EVENTS + 1 ) / 2 == flips );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE StrandSuite
+
+} // namespace Caramel
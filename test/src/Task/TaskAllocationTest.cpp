@@ -0,0 +1,235 @@
+// Caramel C++ Library Test - Task - Task Allocation Test
+
+#include "CaramelTestPch.h"
+
+#include <Caramel/Task/AsyncTask.h>
+#include <Caramel/Task/Strand.h>
+#include <Caramel/Task/TaskPoller.h>
+#include <UnitTest++/UnitTest++.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Counting Allocation
+// - Replaces the global operator new, counts only when enabled.
+//
+
+static std::atomic< Bool > s_countingAllocations( false );
+static std::atomic< Caramel::Uint > s_allocationCount( 0 );
+
+static void* CountedAlloc( std::size_t size )
+{
+    if ( s_countingAllocations ) { ++ s_allocationCount; }
+
+    void* p = std::malloc( size ? size : 1 );
+    if ( ! p ) { throw std::bad_alloc(); }
+    return p;
+}
+
+void* operator new( std::size_t size )                { return CountedAlloc( size ); }
+void* operator new[]( std::size_t size )              { return CountedAlloc( size ); }
+void  operator delete( void* p ) throw()             { std::free( p ); }
+void  operator delete[]( void* p ) throw()           { std::free( p ); }
+
+
+namespace Caramel
+{
+
+SUITE( TaskAllocationSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Allocation Test
+// - In steady state, creating, submitting and running a task doesn't allocate.
+//
+
+TEST( TaskAllocationTest )
+{
+    TaskPoller poller;
+
+    Int count = 0;
+
+    auto cycle = [&]
+    {
+        poller.Submit( Task( TaskName::Literal( "Count" ), [&count] { ++ count; } ));
+        poller.PollOne();
+    };
+
+    // Warm up the pools and the ready lanes.
+    for ( Int i = 0; i < 1000; ++ i ) { cycle(); }
+
+    s_allocationCount = 0;
+    s_countingAllocations = true;
+
+    for ( Int i = 0; i < 1000; ++ i ) { cycle(); }
+
+    s_countingAllocations = false;
+
+    CHECK( 2000 == count );
+    CHECK( 0 == s_allocationCount );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Strand Repeat Allocation Test
+// - A repeating task on a strand reuses its wrapper each cycle, so it costs
+//   no more allocations than repeating on the underlying executor directly.
+//
+
+static Uint CountRepeatAllocations( TaskPoller& poller, TaskExecutor& executor )
+{
+    Int count = 0;
+
+    Task repeat( TaskName::Literal( "Repeat" ), [&count] { ++ count; } );
+    repeat.Every( Ticks( 1 ));
+    executor.Submit( repeat );
+
+    // Warm up the pools and the ready lanes.
+    while ( 20 > count ) { poller.PollFor( Ticks( 1 )); }
+
+    s_allocationCount = 0;
+    s_countingAllocations = true;
+
+    while ( 40 > count ) { poller.PollFor( Ticks( 1 )); }
+
+    s_countingAllocations = false;
+
+    repeat.Cancel();
+
+    return s_allocationCount;
+}
+
+
+TEST( StrandRepeatAllocationTest )
+{
+    TaskPoller poller;
+    Strand strand( poller );
+
+    const Uint direct = CountRepeatAllocations( poller, poller );
+    const Uint stranded = CountRepeatAllocations( poller, strand );
+
+    CHECK( stranded <= direct );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Callable Test
+// - Small function objects are stored inside, large ones are allocated.
+//
+
+TEST( TaskCallableTest )
+{
+    static_assert( std::is_nothrow_move_constructible< Detail::TaskCallable >::value,
+                   "TaskCallable moves must not throw" );
+
+    Int small = 0;
+    Int64 large[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    Int64 sum = 0;
+
+    Detail::TaskCallable smallCall( [&small] { ++ small; } );
+    Detail::TaskCallable largeCall( [large, &sum] { for ( Int i = 0; i < 8; ++ i ) { sum += large[i]; } } );
+
+    s_allocationCount = 0;
+    s_countingAllocations = true;
+
+    Detail::TaskCallable movedSmall( std::move( smallCall ));
+    Detail::TaskCallable movedLarge( std::move( largeCall ));
+
+    s_countingAllocations = false;
+
+    CHECK( 0 == s_allocationCount );
+    CHECK( true == smallCall.IsEmpty() );
+    CHECK( true == largeCall.IsEmpty() );
+
+    movedSmall();
+    movedLarge();
+
+    CHECK( 1 == small );
+    CHECK( 36 == sum );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Name Test
+//
+
+TEST( TaskNameTest )
+{
+    /// A buffer is copied ///
+
+    Char buffer[] = "Buffer";
+    const TaskName copied( buffer );
+
+    buffer[0] = 'X';
+
+    CHECK( "Buffer" == copied.ToString() );
+
+
+    /// Literal and lazy names keep pointers ///
+
+    const std::string owner = "Owner";
+
+    CHECK( "Literal" == TaskName::Literal( "Literal" ).ToString() );
+    CHECK( "Owner[42]" == TaskName::Lazy( "%s[%d]", owner, 42 ).ToString() );
+
+    CHECK( true == TaskName().IsEmpty() );
+    CHECK( false == TaskName::Literal( "Literal" ).IsEmpty() );
+}
+
+
+#if defined( CARAMEL_HAS_COROUTINES )
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Async Task Allocation Test
+// - Resuming a coroutine on an executor doesn't allocate.
+//
+
+static AsyncTask< void > CountSteps( TaskPoller& poller, Int steps, Int& count )
+{
+    for ( Int i = 0; i < steps; ++ i )
+    {
+        co_await ResumeOn( poller );
+        ++ count;
+    }
+}
+
+
+TEST( AsyncTaskAllocationTest )
+{
+    TaskPoller poller;
+
+    Int count = 0;
+
+    // Warm up the pools and the ready lanes.
+    auto warmUp = CountSteps( poller, 1000, count );
+    while ( ! warmUp.IsReady() ) { poller.PollOne(); }
+
+    auto steps = CountSteps( poller, 1000, count );
+
+    s_allocationCount = 0;
+    s_countingAllocations = true;
+
+    while ( ! steps.IsReady() ) { poller.PollOne(); }
+
+    s_countingAllocations = false;
+
+    CHECK( 2000 == count );
+    CHECK( 0 == s_allocationCount );
+}
+
+#endif // CARAMEL_HAS_COROUTINES
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE TaskAllocationSuite
+
+} // namespace Caramel
@@ -0,0 +1,400 @@
+// Caramel C++ Library Test - Task - Task Cancellation Test
+
+#include "CaramelTestPch.h"
+
+#include <Caramel/Chrono/TickClock.h>
+#include <Caramel/Task/CancellationToken.h>
+#include <Caramel/Task/TaskPoller.h>
+#include <Caramel/Task/TaskStealingPool.h>
+#include <Caramel/Task/TaskThreadPool.h>
+#include <Caramel/Thread/ThisThread.h>
+#include <UnitTest++/UnitTest++.h>
+#include <atomic>
+#include <vector>
+
+
+namespace Caramel
+{
+
+SUITE( TaskCancellationSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Cancel Test
+//
+
+TEST( TaskCancelTest )
+{
+    TaskPoller poller;
+
+    Int count = 0;
+
+    /// Cancel before running ///
+
+    auto task1 = Task( "Cancelled", [&] { ++ count; } );
+    poller.Submit( task1 );
+
+    CHECK( true == task1.Cancel() );
+    CHECK( false == task1.Cancel() );  // Only once
+    CHECK( true == task1.IsCancelled() );
+    CHECK( true == task1.IsCompleted() );
+
+    poller.PollOne();
+
+    CHECK( 0 == count );
+    CHECK( 0 == poller.GetCounters().runCount );
+    CHECK( 1 == poller.GetCounters().cancelledCount );
+
+
+    /// Cancel after running ///
+
+    auto task2 = Task( "Runs", [&] { ++ count; } );
+    poller.Submit( task2 );
+    poller.PollOne();
+
+    CHECK( 1 == count );
+    CHECK( true == task2.IsCompleted() );
+    CHECK( false == task2.Cancel() );
+    CHECK( 1 == poller.GetCounters().runCount );
+
+
+    /// Cancel a delayed task, it is removed at once ///
+
+    auto task3 = Task( "Delayed", [&] { ++ count; } );
+    task3.DelayFor( Ticks( 10 ));
+    poller.Submit( task3 );
+
+    CHECK( true == task3.Cancel() );
+    CHECK( 2 == poller.GetCounters().cancelledCount );
+
+    const TickClock clock;
+    while ( Ticks( 20 ) > clock.Elapsed() )
+    {
+        poller.PollFor( Ticks( 5 ));
+    }
+
+    CHECK( 1 == count );
+    CHECK( 2 == poller.GetCounters().cancelledCount );
+
+
+    /// Cancel an empty task ///
+
+    Task empty;
+    CHECK( false == empty.Cancel() );
+    CHECK( false == empty.IsCancelled() );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Cancel State Test
+// - Cancel doesn't turn a completed task into a cancelled one.
+//
+
+TEST( TaskCancelStateTest )
+{
+    TaskPoller poller;
+
+    Int count = 0;
+
+    /// Cancel after completion, then submit again ///
+
+    auto task1 = Task( "Again", [&] { ++ count; } );
+    poller.Submit( task1 );
+    poller.PollOne();
+
+    CHECK( false == task1.Cancel() );
+    CHECK( false == task1.IsCancelled() );
+    CHECK( true == task1.IsCompleted() );
+
+    poller.Submit( task1 );
+    poller.PollOne();
+
+    CHECK( 2 == count );
+    CHECK( false == task1.IsCancelled() );
+
+    // Pending again once submitted, so it can be cancelled.
+    poller.Submit( task1 );
+
+    CHECK( true == task1.Cancel() );
+
+    poller.PollOne();
+
+    CHECK( 2 == count );
+    CHECK( true == task1.IsCancelled() );
+
+
+    /// Cancel during running ///
+
+    Bool cancelResult = true;
+
+    Task task2;
+    task2 = Task( "Self", [&] { cancelResult = task2.Cancel(); ++ count; } );
+    poller.Submit( task2 );
+    poller.PollOne();
+
+    CHECK( false == cancelResult );  // It can't stop a running task.
+    CHECK( 3 == count );
+    CHECK( false == task2.IsCancelled() );
+    CHECK( true == task2.IsCompleted() );
+
+    poller.Submit( task2 );
+    poller.PollOne();
+
+    CHECK( 4 == count );
+
+
+    /// Cancel a repeating task during running ///
+
+    Task task3;
+    task3 = Task( "Repeat", [&] { cancelResult = task3.Cancel(); ++ count; } );
+    task3.Every( Ticks( 5 ));
+    poller.Submit( task3 );
+
+    const TickClock clock;
+    while ( Ticks( 30 ) > clock.Elapsed() )
+    {
+        poller.PollFor( Ticks( 5 ));
+    }
+
+    CHECK( true == cancelResult );  // Stopped after the first run.
+    CHECK( 5 == count );
+    CHECK( true == task3.IsCancelled() );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Cancellation Token Test
+//
+
+TEST( CancellationTokenTest )
+{
+    TaskPoller poller;
+    CancellationToken token;
+
+    Int count = 0;
+
+    for ( Int i = 0; i < 10; ++ i )
+    {
+        poller.Submit( Task( "Group", [&] { ++ count; } ).WithCancellation( token ));
+    }
+
+    auto delayed = Task( "Delayed", [&] { ++ count; } );
+    delayed.DelayFor( Ticks( 1000 ));
+    delayed.WithCancellation( token );
+    poller.Submit( delayed );
+
+    poller.Submit( Task( "Other", [&] { ++ count; } ));
+
+    CHECK( false == token.IsCancelled() );
+
+    token.Cancel();
+
+    CHECK( true == token.IsCancelled() );
+    CHECK( true == delayed.IsCancelled() );
+
+    poller.PollFor( Ticks( 100 ));
+
+    CHECK( 1 == count );
+    CHECK( 1 == poller.GetCounters().runCount );
+    CHECK( 11 == poller.GetCounters().cancelledCount );
+
+
+    /// Tasks added after the token is cancelled ///
+
+    auto late = Task( "Late", [&] { ++ count; } ).WithCancellation( token );
+
+    CHECK( true == late.IsCancelled() );
+
+    poller.Submit( late );
+    poller.PollOne();
+
+    CHECK( 1 == count );
+    CHECK( 12 == poller.GetCounters().cancelledCount );
+
+
+    /// Copies share the token ///
+
+    CancellationToken token2;
+    CancellationToken copy = token2;
+
+    auto task = Task( "Copy", [&] { ++ count; } ).WithCancellation( token2 );
+
+    copy.Cancel();
+
+    CHECK( true == token2.IsCancelled() );
+    CHECK( true == task.IsCancelled() );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Pool Cancel Test
+// - Drain doesn't wait for the cancelled delayed tasks.
+//
+
+template< typename Pool >
+void TestPoolCancel( Pool& pool )
+{
+    CancellationToken token;
+
+    std::atomic< Int > count( 0 );
+
+    for ( Int i = 0; i < 100; ++ i )
+    {
+        auto task = Task( "Delayed", [&] { ++ count; } );
+        task.DelayFor( Ticks( 60000 ));
+        task.WithCancellation( token );
+        pool.Submit( task );
+    }
+
+    for ( Int i = 0; i < 100; ++ i )
+    {
+        pool.Submit( Task( "Ready", [&] { ++ count; } ));
+    }
+
+    token.Cancel();
+
+    const TickClock clock;
+    pool.Drain();
+
+    CHECK( Ticks( 10000 ) > clock.Elapsed() );
+    CHECK( 100 == count );
+
+    const TaskCounters counters = pool.GetCounters();
+
+    CHECK( 100 == counters.runCount );
+    CHECK( 100 == counters.cancelledCount );
+
+
+    /// Cancelled inside another task ///
+
+    auto victim = Task( "Victim", [&] { ++ count; } );
+    victim.DelayFor( Ticks( 60000 ));
+    pool.Submit( victim );
+
+    pool.Submit( Task( "Killer", [=] () mutable { victim.Cancel(); } ));
+    pool.Drain();
+
+    CHECK( 100 == count );
+    CHECK( 101 == pool.GetCounters().cancelledCount );
+}
+
+
+TEST( TaskThreadPoolCancelTest )
+{
+    TaskThreadPool pool( "Pool", 4 );
+    TestPoolCancel( pool );
+}
+
+
+TEST( TaskStealingPoolCancelTest )
+{
+    TaskStealingPool pool( "Pool", 4 );
+    TestPoolCancel( pool );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Pool Shutdown Test
+// - Shutdown cancels the delayed tasks instead of waiting for them.
+//
+
+template< typename Pool >
+void TestPoolShutdown( Pool& pool )
+{
+    std::atomic< Int > count( 0 );
+
+    auto hourly = Task( "Hourly", [&] { ++ count; } );
+    hourly.DelayFor( Ticks( 3600000 ));
+    pool.Submit( hourly );
+
+    auto repeating = Task( "Repeating", [&] { ++ count; } );
+    repeating.Every( Ticks( 3600000 ));
+    pool.Submit( repeating );
+
+    // A running task submits a delayed one, while the pool is shutting down.
+    pool.Submit( Task( "Nested", [&]
+    {
+        ThisThread::SleepFor( Ticks( 50 ));
+
+        auto nested = Task( "NestedDelayed", [&] { ++ count; } );
+        nested.DelayFor( Ticks( 3600000 ));
+        pool.Submit( nested );
+
+        ++ count;
+    }));
+
+    // Shut down by its own task.
+    Bool selfShutdownThrows = false;
+    pool.Submit( Task( "Suicide", [&]
+    {
+        try { pool.Shutdown(); } catch ( const Caramel::Exception& ) { selfShutdownThrows = true; }
+    }));
+
+    const TickClock clock;
+    pool.Shutdown();
+
+    CHECK( Ticks( 10000 ) > clock.Elapsed() );
+    CHECK( true == selfShutdownThrows );
+
+    CHECK( 1 == count );
+    CHECK( true == hourly.IsCancelled() );
+    CHECK( true == repeating.IsCancelled() );
+
+    const TaskCounters counters = pool.GetCounters();
+
+    CHECK( 2 == counters.runCount );
+    CHECK( 3 == counters.cancelledCount );
+}
+
+
+TEST( TaskThreadPoolShutdownCancelTest )
+{
+    TaskThreadPool pool( "Pool", 2 );
+    TestPoolShutdown( pool );
+}
+
+
+TEST( TaskStealingPoolShutdownCancelTest )
+{
+    TaskStealingPool pool( "Pool", 2 );
+    TestPoolShutdown( pool );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Counters Default Test
+// - An executor doesn't have to count.
+//
+
+class CountlessExecutor : public TaskExecutor
+{
+public:
+    void Submit( const Task& task ) override { m_tasks.push_back( task ); }
+
+private:
+    std::vector< Task > m_tasks;
+};
+
+
+TEST( TaskCountersDefaultTest )
+{
+    CountlessExecutor executor;
+    executor.Submit( Task( "Nothing", [] {} ));
+
+    const TaskCounters counters = executor.GetCounters();
+
+    CHECK( 0 == counters.runCount );
+    CHECK( 0 == counters.cancelledCount );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE TaskCancellationSuite
+
+} // namespace Caramel
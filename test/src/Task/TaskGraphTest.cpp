@@ -0,0 +1,239 @@
+// Caramel C++ Library Test - Task - Task Graph Test
+
+#include "CaramelTestPch.h"
+
+#include <Caramel/Error/Exception.h>
+#include <Caramel/Task/TaskGraph.h>
+#include <Caramel/Task/TaskPoller.h>
+#include <Caramel/Task/TaskThreadPool.h>
+#include <Caramel/Thread/MutexLocks.h>
+#include <Caramel/Thread/ThisThread.h>
+#include <UnitTest++/UnitTest++.h>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+
+
+namespace Caramel
+{
+
+SUITE( TaskGraphSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Graph Test
+// - A diamond : A -> B, A -> C, then B, C -> D.
+//
+
+TEST( TaskGraphTest )
+{
+    TaskThreadPool pool( "GraphPool", 4 );
+
+    std::mutex mutex;
+    std::string order;
+
+    auto append = [&] ( char c )
+    {
+        auto ulock = UniqueLock( mutex );
+        order += c;
+    };
+
+    TaskGraph graph( "Diamond" );
+
+    const Uint a = graph.AddNode( "A", [&] { append( 'A' ); } );
+    const Uint b = graph.AddNode( "B", [&] { append( 'B' ); } );
+    const Uint c = graph.AddNode( "C", [&] { append( 'C' ); } );
+    const Uint d = graph.AddNode( "D", [&] { append( 'D' ); } );
+
+    graph.AddDependency( a, b );
+    graph.AddDependency( a, c );
+    graph.AddDependency( b, d );
+    graph.AddDependency( c, d );
+
+    CHECK( 4 == graph.GetNodeCount() );
+
+
+    /// Built once, run many times ///
+
+    for ( Int i = 0; i < 100; ++ i )
+    {
+        order.clear();
+
+        graph.Run( pool ).Get();
+
+        CHECK( false == graph.IsRunning() );
+        CHECK( 4 == order.size() );
+        CHECK( 'A' == order[0] );
+        CHECK( 'D' == order[3] );
+    }
+
+
+    /// On a single-thread executor ///
+
+    TaskPoller poller;
+
+    order.clear();
+    auto future = graph.Run( poller );
+
+    CHECK( true == graph.IsRunning() );
+    CHECK_THROW( graph.Run( poller ), Caramel::Exception );
+
+    while ( ! future.IsReady() )
+    {
+        poller.PollOne();
+    }
+
+    CHECK( "ABCD" == order || "ACBD" == order );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Graph Parallel Test
+// - Independent branches overlap on a multi-threaded executor.
+//
+
+TEST( TaskGraphParallelTest )
+{
+    TaskThreadPool pool( "GraphPool", 4 );
+
+    const Int NUM_BRANCHES = 4;
+
+    std::atomic< Int > running( 0 );
+    std::atomic< Int > maxRunning( 0 );
+
+    TaskGraph graph( "Branches" );
+
+    const Uint start = graph.AddNode( "Start", [] {} );
+    const Uint end = graph.AddNode( "End", [] {} );
+
+    for ( Int i = 0; i < NUM_BRANCHES; ++ i )
+    {
+        const Uint branch = graph.AddNode( "Branch", [&]
+        {
+            const Int count = ++ running;
+
+            Int maxCount = maxRunning;
+            while ( maxCount < count && ! maxRunning.compare_exchange_weak( maxCount, count )) {}
+
+            ThisThread::SleepFor( Ticks( 50 ));
+            -- running;
+        });
+
+        graph.AddDependency( start, branch );
+        graph.AddDependency( branch, end );
+    }
+
+    graph.Run( pool ).Get();
+
+    CHECK( 1 < maxRunning );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Graph Error Test
+//
+
+TEST( TaskGraphErrorTest )
+{
+    TaskThreadPool pool( "GraphPool", 2 );
+
+    /// Cycle ///
+    {
+        TaskGraph graph( "Cycle" );
+
+        const Uint a = graph.AddNode( "A", [] {} );
+        const Uint b = graph.AddNode( "B", [] {} );
+        const Uint c = graph.AddNode( "C", [] {} );
+
+        graph.AddDependency( a, b );
+        graph.AddDependency( b, c );
+        graph.AddDependency( c, b );
+
+        CHECK_THROW( graph.Run( pool ), Caramel::Exception );
+        CHECK( false == graph.IsRunning() );
+
+        CHECK_THROW( graph.AddDependency( a, 3 ), Caramel::Exception );
+        CHECK_THROW( graph.AddDependency( a, a ), Caramel::Exception );
+    }
+
+    /// Exception ///
+    {
+        Bool afterRan = false;
+
+        TaskGraph graph( "Throws" );
+
+        const Uint fail  = graph.AddNode( "Fail",  [] { throw std::runtime_error( "Oops" ); } );
+        const Uint after = graph.AddNode( "After", [&] { afterRan = true; } );
+
+        graph.AddDependency( fail, after );
+
+        CHECK_THROW( graph.Run( pool ).Get(), std::runtime_error );
+        CHECK( false == afterRan );
+        CHECK( false == graph.IsRunning() );
+    }
+
+    /// Empty ///
+    {
+        TaskGraph graph( "Empty" );
+
+        graph.Run( pool ).Get();
+        CHECK( 0 == graph.GetNodeCount() );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Graph Timing Test
+// - Load -> Parse -> Simulate is longer than Load -> Audio.
+//
+
+TEST( TaskGraphTimingTest )
+{
+    TaskThreadPool pool( "GraphPool", 4 );
+
+    TaskGraph graph( "Frame" );
+
+    const Uint load     = graph.AddNode( "Load",     [] { ThisThread::SleepFor( Ticks( 10 )); } );
+    const Uint parse    = graph.AddNode( "Parse",    [] { ThisThread::SleepFor( Ticks( 20 )); } );
+    const Uint simulate = graph.AddNode( "Simulate", [] { ThisThread::SleepFor( Ticks( 30 )); } );
+    const Uint audio    = graph.AddNode( "Audio",    [] {} );
+
+    graph.AddDependency( load, parse );
+    graph.AddDependency( parse, simulate );
+    graph.AddDependency( load, audio );
+
+    graph.Run( pool ).Get();
+
+    const TaskGraphTiming timing = graph.GetLastTiming();
+
+    CHECK( 4 == timing.nodes.size() );
+    CHECK( 3 == timing.criticalPath.size() );
+
+    if ( 3 == timing.criticalPath.size() )
+    {
+        CHECK( load     == timing.criticalPath[0] );
+        CHECK( parse    == timing.criticalPath[1] );
+        CHECK( simulate == timing.criticalPath[2] );
+    }
+
+    CHECK( Seconds( 0.059 ) <= timing.criticalPathTime );
+    CHECK( timing.criticalPathTime <= timing.wallTime );
+    CHECK( timing.nodes[ parse ].startTime >= timing.nodes[ load ].duration );
+
+    const std::string text = timing.ToString( "Frame" );
+
+    CHECK( std::string::npos != text.find( "Load" ));
+    CHECK( std::string::npos != text.find( "Simulate" ));
+
+    CARAMEL_TRACE_INFO( "%s", text );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE TaskGraphSuite
+
+} // namespace Caramel
@@ -4,6 +4,7 @@
 
 #include <Caramel/Task/TaskPoller.h>
 #include <Caramel/Thread/ThisThread.h>
+#include <Caramel/Thread/Thread.h>
 #include <UnitTest++/UnitTest++.h>
 
 
@@ -84,6 +85,168 @@ void TaskPollerTest::DoRun()
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Priority Test
+//
+
+TEST( TaskPriorityTest )
+{
+    TaskPoller poller;
+
+    std::string order;
+
+    for ( Int i = 0; i < 20; ++ i )
+    {
+        poller.Submit( Task( "Low", [&] { order += 'L'; } ).WithPriority( TASK_PRIORITY_LOW ));
+    }
+
+    for ( Int i = 0; i < 20; ++ i )
+    {
+        poller.Submit( Task( "Normal", [&] { order += 'N'; } ));
+    }
+
+    for ( Int i = 0; i < 20; ++ i )
+    {
+        poller.Submit( Task( "High", [&] { order += 'H'; } ).WithPriority( TASK_PRIORITY_HIGH ));
+    }
+
+    CHECK( 20 == poller.GetLaneStats( TASK_PRIORITY_HIGH ).queueDepth );
+    CHECK( 20 == poller.GetLaneStats( TASK_PRIORITY_LOW ).queueDepth );
+
+    poller.PollFor( Ticks( 1000 ));
+
+    // Weighted rounds of 8 : 4 : 1, higher lanes first.
+    CHECK_EQUAL(
+        "HHHHHHHHNNNNL"
+        "HHHHHHHHNNNNL"
+        "HHHHNNNNL"
+        "NNNNL"
+        "NNNNL"
+        "LLLLLLLLLLLLLLL",
+        order );
+
+    const TaskLaneStats high = poller.GetLaneStats( TASK_PRIORITY_HIGH );
+
+    CHECK( 0 == high.queueDepth );
+    CHECK( 20 == high.dequeuedCount );
+    CHECK( high.maxWait >= high.AverageWait() );
+    CHECK( 20 == poller.GetLaneStats( TASK_PRIORITY_NORMAL ).dequeuedCount );
+    CHECK( 20 == poller.GetLaneStats( TASK_PRIORITY_LOW ).dequeuedCount );
+
+
+    /// High priority tasks go first in a slice ///
+
+    order.clear();
+
+    poller.Submit( Task( "Normal", [&] { order += 'N'; } ));
+    poller.Submit( Task( "High", [&] { order += 'H'; } ).WithPriority( TASK_PRIORITY_HIGH ));
+
+    poller.PollOne();
+
+    CHECK( "H" == order );
+
+    poller.PollOne();
+
+    CHECK( "HN" == order );
+
+
+    /// A high burst mixed with low tasks ///
+    //
+    // Weighted-fair, not strict : the rounds carry over across the slices,
+    // so after 8 high turns a low task runs before the next high ones.
+    //
+
+    order.clear();
+
+    poller.PollOne();  // Nothing ready, the next one starts a new round.
+
+    for ( Int i = 0; i < 12; ++ i )
+    {
+        poller.Submit( Task( "High", [&] { order += 'H'; } ).WithPriority( TASK_PRIORITY_HIGH ));
+    }
+
+    for ( Int i = 0; i < 2; ++ i )
+    {
+        poller.Submit( Task( "Low", [&] { order += 'L'; } ).WithPriority( TASK_PRIORITY_LOW ));
+    }
+
+    for ( Int i = 0; i < 14; ++ i )
+    {
+        poller.PollOne();
+    }
+
+    CHECK_EQUAL( "HHHHHHHHLHHHHL", order );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Wait And Poll Test
+//
+
+TEST( TaskWaitAndPollTest )
+{
+    TaskPoller poller;
+
+    /// Idle, times out ///
+
+    const TickClock idleClock;
+
+    CHECK( false == poller.WaitAndPollFor( Ticks( 50 ), Ticks( 10 )));
+    CHECK( Ticks( 50 ) <= idleClock.Elapsed() );
+
+
+    /// Woken by a submit from another thread ///
+
+    TickPoint submitTime;
+    TickPoint runTime;
+
+    Thread submitter( "Submitter", [&]
+    {
+        ThisThread::SleepFor( Ticks( 50 ));
+        submitTime = TickClock::Now();
+        poller.Submit( Task( "Wake", [&] { runTime = TickClock::Now(); } ));
+    });
+
+    CHECK( true == poller.WaitAndPollFor( Ticks( 1000 ), Ticks( 10 )));
+    submitter.Join();
+
+    const Ticks submitLatency = runTime - submitTime;
+    CHECK( Ticks( 10 ) >= submitLatency );
+
+
+    /// Woken when a delayed task is due ///
+
+    const TickPoint dueTime = TickClock::Now() + Ticks( 50 );
+
+    poller.Submit( Task( "Delayed", [&] { runTime = TickClock::Now(); } ).DelayFor( Ticks( 50 )));
+
+    CHECK( true == poller.WaitAndPollFor( Ticks( 1000 ), Ticks( 10 )));
+
+    CHECK( dueTime <= runTime );
+    CHECK( Ticks( 10 ) >= runTime - dueTime );
+
+
+    /// An earlier delayed task submitted while waiting ///
+
+    poller.Submit( Task( "Late", [] {} ).DelayFor( Ticks( 500 )));
+
+    Thread delayer( "Delayer", [&]
+    {
+        ThisThread::SleepFor( Ticks( 20 ));
+        poller.Submit( Task( "Early", [&] { runTime = TickClock::Now(); } ).DelayFor( Ticks( 20 )));
+    });
+
+    const TickClock earlyClock;
+
+    CHECK( true == poller.WaitAndPollFor( Ticks( 1000 ), Ticks( 10 )));
+    delayer.Join();
+
+    CHECK( Ticks( 200 ) > earlyClock.Elapsed() );
+}
+
+
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,184 @@
+// Caramel C++ Library Test - Task - Task Repeat Test
+
+#include "CaramelTestPch.h"
+
+#include <Caramel/Task/TaskPoller.h>
+#include <Caramel/Task/TaskStealingPool.h>
+#include <Caramel/Task/TaskThreadPool.h>
+#include <Caramel/Thread/ThisThread.h>
+#include <UnitTest++/UnitTest++.h>
+#include <atomic>
+
+
+namespace Caramel
+{
+
+SUITE( TaskRepeatSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Repeat Test
+//
+
+TEST( TaskRepeatTest )
+{
+    TaskPoller poller;
+
+    Int count = 0;
+
+    auto task = Task( "Repeat", [&] { ++ count; } ).Every( Ticks( 10 ));
+
+    CHECK( true == task.IsRepeating() );
+
+    poller.Submit( task );
+
+    const TickClock clock;
+    while ( Ticks( 105 ) > clock.Elapsed() )
+    {
+        poller.PollFor( Ticks( 1 ));
+        ThisThread::SleepFor( Ticks( 1 ));
+    }
+
+    CHECK( 8 <= count );
+    CHECK( 10 >= count );
+    CHECK( false == task.IsCompleted() );
+
+
+    /// Cancel stops it ///
+
+    CHECK( true == task.Cancel() );
+    CHECK( true == task.IsCompleted() );
+
+    const Int cancelledAt = count;
+
+    ThisThread::SleepFor( Ticks( 30 ));
+    poller.PollFor( Ticks( 10 ));
+
+    CHECK( cancelledAt == count );
+    CHECK( 1 == poller.GetCounters().cancelledCount );
+
+
+    /// Cancel in its own run ///
+
+    count = 0;
+
+    Task self;
+    self = Task( "Self", [&] { if ( 3 == ++ count ) { CHECK( true == self.Cancel() ); }} ).Every( Ticks( 5 ));
+
+    poller.Submit( self );
+
+    const TickClock clock2;
+    while ( Ticks( 60 ) > clock2.Elapsed() )
+    {
+        poller.PollFor( Ticks( 1 ));
+        ThisThread::SleepFor( Ticks( 1 ));
+    }
+
+    CHECK( 3 == count );
+
+
+    /// Interval must be positive ///
+
+    CHECK_THROW( Task( "Zero", [] {} ).Every( Ticks::Zero() ), Caramel::Exception );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Repeat Mode Test
+// - The poller is not polled for a while, then it misses some ticks.
+//
+
+static Int CountMissedRuns( TaskRepeatMode mode )
+{
+    TaskPoller poller;
+
+    Int count = 0;
+
+    auto task = Task( "Repeat", [&] { ++ count; } ).Every( Ticks( 20 ), mode );
+    poller.Submit( task );
+
+    ThisThread::SleepFor( Ticks( 110 ));
+
+    // Each poll promotes the due tasks once.
+    for ( Int i = 0; i < 8; ++ i )
+    {
+        poller.PollOne();
+    }
+
+    task.Cancel();
+    return count;
+}
+
+
+TEST( TaskRepeatModeTest )
+{
+    // Ticks at 20, 40, 60, 80, 100 are due, the next one is at 120.
+    CHECK( 5 == CountMissedRuns( TASK_REPEAT_FIXED_RATE_CATCH_UP ));
+
+    // Skip to the tick at 120.
+    CHECK( 1 == CountMissedRuns( TASK_REPEAT_FIXED_RATE ));
+
+    // 20 after the run at 110.
+    CHECK( 1 == CountMissedRuns( TASK_REPEAT_FIXED_DELAY ));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Pool Repeat Test
+// - Drain() and Shutdown() don't wait for a repeating task.
+//
+
+template< typename Pool >
+void TestPoolRepeat( Pool& pool )
+{
+    std::atomic< Int > count( 0 );
+
+    auto task = Task( "Repeat", [&] { ++ count; } ).Every( Ticks( 5 ));
+    pool.Submit( task );
+
+    ThisThread::SleepFor( Ticks( 60 ));
+    pool.Drain();
+
+    CHECK( 5 <= count );
+
+    CHECK( true == task.Cancel() );
+
+    // It may be running now, wait for it.
+    ThisThread::SleepFor( Ticks( 10 ));
+    const Int cancelledAt = count;
+
+    ThisThread::SleepFor( Ticks( 30 ));
+
+    CHECK( cancelledAt == count );
+
+
+    /// Not cancelled before shutdown ///
+
+    pool.Submit( Task( "Forever", [] {} ).Every( Ticks( 5 )));
+
+    ThisThread::SleepFor( Ticks( 20 ));
+    pool.Shutdown();
+}
+
+
+TEST( TaskThreadPoolRepeatTest )
+{
+    TaskThreadPool pool( "Pool", 2 );
+    TestPoolRepeat( pool );
+}
+
+
+TEST( TaskStealingPoolRepeatTest )
+{
+    TaskStealingPool pool( "Pool", 2 );
+    TestPoolRepeat( pool );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE TaskRepeatSuite
+
+} // namespace Caramel
@@ -0,0 +1,194 @@
+// Caramel C++ Library Test - Task - Task Stealing Pool Test
+
+#include "CaramelTestPch.h"
+
+#include <Caramel/Task/TaskStealingPool.h>
+#include <Caramel/Task/TaskThreadPool.h>
+#include <Caramel/Thread/ThisThread.h>
+#include <UnitTest++/UnitTest++.h>
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+
+
+namespace Caramel
+{
+
+SUITE( TaskStealingPoolSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Stealing Pool Test
+//
+
+// Each task of depth > 0 spawns 2 children, a binary tree of ( 2 ^ ( depth + 1 ) - 1 ) tasks.
+static void SpawnTree( TaskExecutor& executor, Int depth, std::atomic< Int >& count )
+{
+    ++ count;
+
+    if ( 0 == depth ) { return; }
+
+    for ( Int i = 0; i < 2; ++ i )
+    {
+        executor.Submit( Task( "Tree", [&executor, depth, &count]
+        {
+            SpawnTree( executor, depth - 1, count );
+        }));
+    }
+}
+
+
+TEST( TaskStealingPoolTest )
+{
+    TaskStealingPool pool( "Stealing", 4 );
+
+    CHECK( 4 == pool.GetThreadCount() );
+
+    std::atomic< Int > count( 0 );
+
+
+    /// External Submits ///
+
+    for ( Int i = 0; i < 1000; ++ i )
+    {
+        pool.Submit( Task( "Count", [&] { ++ count; } ));
+    }
+
+    pool.Drain();
+
+    CHECK( 1000 == count );
+
+
+    /// Tasks submit tasks to the local deques ///
+
+    count = 0;
+
+    pool.Submit( Task( "Root", [&] { SpawnTree( pool, 10, count ); } ));
+    pool.Drain();
+
+    CHECK( 2047 == count );
+
+
+    /// Exception doesn't stop the workers ///
+
+    count = 0;
+
+    pool.Submit( Task( "Throws", [] { throw std::runtime_error( "Oops" ); } ));
+    pool.Submit( Task( "After", [&] { ++ count; } ));
+
+    pool.Drain();
+
+    CHECK( 1 == count );
+}
+
+
+TEST( TaskStealingPoolDelayTest )
+{
+    TaskStealingPool pool( "StealingDelay", 2 );
+
+    std::atomic< Int > order( 0 );
+    std::atomic< Int > early( 0 );
+    std::atomic< Int > late( 0 );
+
+    Task lateTask( "Late", [&] { late = ++ order; } );
+    lateTask.DelayFor( Ticks( 100 ));
+
+    Task earlyTask( "Early", [&] { early = ++ order; } );
+    earlyTask.DelayFor( Ticks( 30 ));
+
+    pool.Submit( lateTask );
+    pool.Submit( earlyTask );
+
+    // A running task submits a delayed one.
+    Task nested( "Nested", [&]
+    {
+        Task delayed( "NestedDelayed", [&] { ++ order; } );
+        delayed.DelayFor( Ticks( 10 ));
+        pool.Submit( delayed );
+    });
+    pool.Submit( nested );
+
+    ThisThread::SleepFor( Ticks( 5 ));
+    CHECK( 0 == order );
+
+    pool.Drain();
+
+    CHECK( 2 == early );
+    CHECK( 3 == late );
+
+
+    /// Shutdown ///
+
+    pool.Shutdown();
+
+    CHECK_THROW( pool.Submit( Task( "Refused", [] {} )), Caramel::Exception );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Benchmark
+// - Throughput of TaskThreadPool ( one shared queue ) and
+//   TaskStealingPool, at 1 / 2 / 4 / 8 / 16 threads.
+//   The results are reported to the trace, no assertion on timings.
+//
+
+const Int BENCH_EXTERNAL_TASKS = 20000;
+const Int BENCH_TREE_DEPTH     = 14;  // 32767 tasks
+
+
+template< typename PoolType >
+static Int BenchmarkPool( const std::string& poolName, Uint numThreads )
+{
+    PoolType pool( poolName, numThreads );
+
+    std::atomic< Int > count( 0 );
+
+    TickClock clock;
+
+    // External submits, through the shared / injection queue.
+
+    for ( Int i = 0; i < BENCH_EXTERNAL_TASKS; ++ i )
+    {
+        pool.Submit( Task( "External", [&] { ++ count; } ));
+    }
+
+    pool.Drain();
+
+    const Ticks externalTicks = clock.Elapsed();
+    clock.Reset();
+
+    // Fork style, tasks submitted by running tasks.
+
+    pool.Submit( Task( "Root", [&] { SpawnTree( pool, BENCH_TREE_DEPTH, count ); } ));
+    pool.Drain();
+
+    const Ticks treeTicks = clock.Elapsed();
+
+    const std::string times = Sprintf( "external %d ms, tree %d ms", externalTicks.ToInt32(), treeTicks.ToInt32() );
+    CARAMEL_TRACE_INFO( "%s x %u : %s", poolName, numThreads, times );
+
+    return count;
+}
+
+
+TEST( TaskStealingPoolBenchmarkTest )
+{
+    const Int expected = BENCH_EXTERNAL_TASKS + ( 1 << ( BENCH_TREE_DEPTH + 1 )) - 1;
+
+    const Uint threadCounts[] = { 1, 2, 4, 8, 16 };
+
+    for ( Uint i = 0; i < 5; ++ i )
+    {
+        CHECK( expected == BenchmarkPool< TaskThreadPool >( "ThreadPool", threadCounts[i] ));
+        CHECK( expected == BenchmarkPool< TaskStealingPool >( "StealingPool", threadCounts[i] ));
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE TaskStealingPoolSuite
+
+} // namespace Caramel
@@ -0,0 +1,204 @@
+// Caramel C++ Library Test - Task - Task Thread Pool Test
+
+#include "CaramelTestPch.h"
+
+#include <Caramel/Statechart/StateMachine.h>
+#include <Caramel/Task/TaskThreadPool.h>
+#include <Caramel/Thread/MutexLocks.h>
+#include <Caramel/Thread/ThisThread.h>
+#include <UnitTest++/UnitTest++.h>
+#include <atomic>
+#include <set>
+#include <stdexcept>
+
+
+namespace Caramel
+{
+
+SUITE( TaskThreadPoolSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Task Thread Pool Test
+//
+
+TEST( TaskThreadPoolTest )
+{
+    TaskThreadPool pool( "Pool", 4 );
+
+    CHECK( 4 == pool.GetThreadCount() );
+
+    std::atomic< Int > count( 0 );
+
+    std::mutex mutex;
+    std::set< ThreadId > threadIds;
+
+    for ( Int i = 0; i < 1000; ++ i )
+    {
+        pool.Submit( Task( "Count", [&]
+        {
+            ++ count;
+
+            auto ulock = UniqueLock( mutex );
+            threadIds.insert( ThisThread::GetId() );
+        }));
+    }
+
+    pool.Drain();
+
+    CHECK( 1000 == count );
+    CHECK( 1 <= threadIds.size() );
+    CHECK( 4 >= threadIds.size() );
+
+
+    /// Tasks submit tasks ///
+
+    count = 0;
+
+    pool.Submit( Task( "Parent", [&]
+    {
+        for ( Int i = 0; i < 10; ++ i )
+        {
+            pool.Submit( Task( "Child", [&] { ++ count; } ));
+        }
+    }));
+
+    pool.Drain();
+
+    CHECK( 10 == count );
+
+
+    /// Exception doesn't stop the workers ///
+
+    pool.Submit( Task( "Throws", [] { throw std::runtime_error( "Oops" ); } ));
+    pool.Submit( Task( "After", [&] { ++ count; } ));
+
+    pool.Drain();
+
+    CHECK( 11 == count );
+}
+
+
+TEST( TaskThreadPoolDelayTest )
+{
+    TaskThreadPool pool( "DelayPool", 2 );
+
+    std::atomic< Int > order( 0 );
+    std::atomic< Int > early( 0 );
+    std::atomic< Int > late( 0 );
+
+    const TickPoint startTime = TickClock::Now();
+    std::atomic< Int64 > lateElapsed( 0 );
+
+    Task lateTask( "Late", [&]
+    {
+        late = ++ order;
+        lateElapsed = Ticks( TickClock::Now() - startTime ).ToInt64();
+    });
+    lateTask.DelayFor( Ticks( 200 ));
+
+    Task earlyTask( "Early", [&] { early = ++ order; } );
+    earlyTask.DelayFor( Ticks( 50 ));
+
+    pool.Submit( lateTask );
+    pool.Submit( earlyTask );
+
+    ThisThread::SleepFor( Ticks( 20 ));
+    CHECK( 0 == order );
+
+    // Drain waits for the delayed tasks.
+    pool.Drain();
+
+    CHECK( 1 == early );
+    CHECK( 2 == late );
+    CHECK( 200 <= lateElapsed );
+}
+
+
+TEST( TaskThreadPoolShutdownTest )
+{
+    std::atomic< Int > count( 0 );
+
+    TaskThreadPool pool( "ShutdownPool", 2 );
+
+    Task delayed( "Delayed", [&] { ++ count; } );
+    delayed.DelayFor( Ticks( 50 ));
+    pool.Submit( delayed );
+
+    for ( Int i = 0; i < 100; ++ i )
+    {
+        pool.Submit( Task( "Count", [&] { ++ count; } ));
+    }
+
+    // The ready tasks run before the workers stop, the delayed one is cancelled.
+    pool.Shutdown();
+
+    CHECK( 100 == count );
+    CHECK( true == delayed.IsCancelled() );
+    CHECK( 1 == pool.GetCounters().cancelledCount );
+
+    CHECK_THROW( pool.Submit( Task( "Refused", [] {} )), Caramel::Exception );
+
+    // Shutdown again is harmless.
+    pool.Shutdown();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// State Machine on Thread Pool Test
+//
+
+enum StateId
+{
+    S_IDLE,
+    S_RUNNING,
+};
+
+
+enum EventId
+{
+    E_START,
+    E_STOP,
+};
+
+
+TEST( StateMachineOnThreadPoolTest )
+{
+    TaskThreadPool pool( "MachinePool", 2 );
+
+    std::atomic< Int > runningEntered( 0 );
+
+    Statechart::StateMachine machine( "Pooled", pool );
+
+    machine.AddState( S_IDLE )
+           .Transition( E_START, S_RUNNING );
+
+    machine.AddState( S_RUNNING )
+           .EnterAction( [&] { ++ runningEntered; } )
+           .Transition( E_STOP, S_IDLE );
+
+    machine.Initiate( S_IDLE );
+    pool.Drain();
+
+    CHECK( S_IDLE == machine.GetCurrentStateId() );
+
+    machine.PostEvent( E_START );
+    pool.Drain();
+
+    CHECK( S_RUNNING == machine.GetCurrentStateId() );
+    CHECK( 1 == runningEntered );
+
+    machine.PostEvent( E_STOP );
+    pool.Drain();
+
+    CHECK( S_IDLE == machine.GetCurrentStateId() );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE TaskThreadPoolSuite
+
+} // namespace Caramel
@@ -0,0 +1,95 @@
+// Caramel C++ Library Test - Thread - Lock Contention Test
+
+#include "CaramelTestPch.h"
+
+#include "Trace/CaptureListener.h"
+#include <Caramel/Concurrent/Map.h>
+#include <Caramel/Concurrent/Queue.h>
+#include <Caramel/Functional/ScopeExit.h>
+#include <Caramel/Thread/LockContention.h>
+#include <Caramel/Thread/ThisThread.h>
+#include <Caramel/Thread/Thread.h>
+#include <Caramel/Trace/Trace.h>
+#include <UnitTest++/UnitTest++.h>
+#include <cstdio>
+
+
+namespace Caramel
+{
+
+SUITE( LockContentionSuite )
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Lock Contention Test
+//
+
+TEST( LockContentionTest )
+{
+    Concurrent::Map< Int, Int > map;
+    map.SetContentionName( "LockContentionTest.Map" );
+
+    Concurrent::Queue< Int > queue;
+    map.Insert( 0, 0 );
+
+    LockContention::Enable();
+    LockContention::Reset();
+    auto disable = ScopeExit( [] { LockContention::Disable(); } );
+
+    // Hold the lock of the map, while another thread is inserting.
+
+    Thread inserter;
+
+    map.ForEach( [&] ( Int, Int )
+    {
+        inserter.Start( "Inserter", [&] { map.Insert( 1, 1 ); } );
+        ThisThread::SleepFor( Ticks( 50 ));
+    });
+
+    inserter.Join();
+
+    // The unnamed queue is not tracked.
+    queue.Push( 1 );
+
+    CaptureListener listener;
+    listener.BindBuiltinChannels( Trace::LEVEL_DEBUG );
+    auto unbind = ScopeExit( [&] { listener.UnbindAllChannels(); } );
+
+    LockContention::ReportToTrace();
+
+    CHECK( "<Lock Contention Report>" == listener.Find( "<Lock Contention Report>" ));
+
+    const std::string line = listener.Find( "[LockContentionTest.Map]" );
+    CHECK( 0 == line.find( "[LockContentionTest.Map] : 2 / 1 contended" ));
+
+    long long waitMicros = 0;
+    long long maxHoldMicros = 0;
+    CHECK( 2 == std::sscanf( line.c_str(), "%*[^,], wait %lld us, max hold %lld us", &waitMicros, &maxHoldMicros ));
+
+    CHECK( 40000 <= waitMicros );
+    CHECK( 40000 <= maxHoldMicros );
+
+
+    /// Disabled ///
+
+    LockContention::Disable();
+    LockContention::Reset();
+
+    map.Insert( 2, 2 );
+
+    CaptureListener quiet;
+    quiet.BindBuiltinChannels( Trace::LEVEL_DEBUG );
+
+    LockContention::ReportToTrace();
+    quiet.UnbindAllChannels();
+
+    CHECK( true == quiet.Find( "[LockContentionTest.Map]" ).empty() );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // SUITE LockContentionSuite
+
+} // namespace Caramel
@@ -0,0 +1,56 @@
+// Caramel C++ Library Test - Trace - Capture Listener Header
+
+#ifndef __CARAMEL_TEST_TRACE_CAPTURE_LISTENER_H
+#define __CARAMEL_TEST_TRACE_CAPTURE_LISTENER_H
+#pragma once
+
+#include <Caramel/Caramel.h>
+#include <Caramel/Trace/Listeners.h>
+#include <string>
+#include <vector>
+
+
+namespace Caramel
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Capture Listener
+// - Keeps the traced messages, for tests checking the reports of a facility.
+//
+
+class CaptureListener : public Trace::Listener
+{
+public:
+
+    void Write( Trace::Level, const std::string& message )
+    {
+        m_messages.push_back( message );
+    }
+
+    // Returns the last message, or an empty string.
+    std::string Last() const
+    {
+        return m_messages.empty() ? std::string() : m_messages.back();
+    }
+
+    // Returns the first message which contains the text, or an empty string.
+    std::string Find( const std::string& text ) const
+    {
+        for ( Uint i = 0; i < m_messages.size(); ++ i )
+        {
+            if ( std::string::npos != m_messages[i].find( text )) { return m_messages[i]; }
+        }
+        return std::string();
+    }
+
+private:
+
+    std::vector< std::string > m_messages;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Caramel
+
+#endif // __CARAMEL_TEST_TRACE_CAPTURE_LISTENER_H